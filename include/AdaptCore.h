@@ -0,0 +1,131 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  AdaptCore - ACK-driven level selection for LinkAdapter (AARF style)
+  -------------------------------------------------------------------
+  - Levels 0..LEVELS-1 go from cheapest (fast rate, low TX power) to most
+    robust (slow / long-range rate, full power); the caller owns the table
+  - Every send result (MAC-level ACK or not) is fed in. After `window`
+    results the success rate is checked: below targetPct -> one level more
+    robust. failFast consecutive failures step up at once.
+  - After `probeAfter` good windows in a row one level cheaper is tried (probe).
+    A probe that fails its first window goes straight back and doubles the
+    hold before that level is tried again (up to MAX_PROBE_AFTER windows), so a
+    link at its limit settles instead of oscillating; a probe that holds resets
+    it. Holds are per level: a noisy window higher up does not inherit them.
+
+  Quick start:
+    AdaptCore<7> core;
+    core.begin(4);                           // start level (e.g. the stack default)
+    if (core.onResult(ok)) apply(core.level());
+*/
+
+template <uint8_t LEVELS>
+class AdaptCore
+{
+public:
+    static const uint8_t MAX_PROBE_AFTER = 64;
+
+    struct Config
+    {
+        uint8_t targetPct = 90; // keep the ACK success rate at or above this
+        uint8_t window = 20;    // results per decision
+        uint8_t failFast = 3;   // consecutive failures that step up immediately
+        uint8_t probeAfter = 3; // good windows before trying a cheaper level
+    };
+
+    struct Stats
+    {
+        uint32_t ups = 0;
+        uint32_t downs = 0;
+        uint32_t failedProbes = 0;
+    };
+
+    void begin(uint8_t level, const Config &cfg = Config())
+    {
+        _cfg = cfg;
+        if (!_cfg.window)
+            _cfg.window = 1;
+        _level = level < LEVELS ? level : LEVELS - 1;
+        for (uint8_t i = 0; i < LEVELS; i++)
+            _hold[i] = _cfg.probeAfter;
+        _probing = false;
+        _resetWindow();
+        _goodWindows = 0;
+    }
+
+    // Returns true when the level changed
+    bool onResult(bool ok)
+    {
+        _n++;
+        if (ok)
+        {
+            _ok++;
+            _failRun = 0;
+        }
+        else if (++_failRun >= _cfg.failFast && _cfg.failFast)
+        {
+            return _up();
+        }
+        if (_n < _cfg.window)
+            return false;
+
+        bool good = (uint32_t)_ok * 100u >= (uint32_t)_cfg.targetPct * _n;
+        if (!good)
+            return _up();
+        if (_probing) // the cheaper level held for a window: keep it
+        {
+            _probing = false;
+            _hold[_level] = _cfg.probeAfter;
+        }
+        _resetWindow();
+        if (_level > 0 && ++_goodWindows >= _hold[_level - 1])
+        {
+            _level--;
+            _stats.downs++;
+            _probing = true;
+            _goodWindows = 0;
+            return true;
+        }
+        return false;
+    }
+
+    uint8_t level() const { return _level; }
+    bool isProbing() const { return _probing; }
+    const Stats &stats() const { return _stats; }
+
+private:
+    bool _up()
+    {
+        if (_probing)
+        {
+            _stats.failedProbes++;
+            _probing = false;
+            uint8_t &h = _hold[_level];
+            h = (h * 2u > MAX_PROBE_AFTER) ? MAX_PROBE_AFTER : (uint8_t)(h * 2u);
+        }
+        _resetWindow();
+        _goodWindows = 0;
+        if (_level + 1 >= LEVELS)
+            return false;
+        _level++;
+        _stats.ups++;
+        return true;
+    }
+
+    void _resetWindow()
+    {
+        _n = _ok = 0;
+        _failRun = 0;
+    }
+
+    Config _cfg;
+    Stats _stats;
+    uint8_t _level = 0;
+    uint8_t _n = 0, _ok = 0, _failRun = 0;
+    uint8_t _goodWindows = 0;
+    uint8_t _hold[LEVELS];  // good windows before probing down into each level
+    bool _probing = false;
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  AdcFilter - integer smoothing for AnalogInputs
+  ----------------------------------------------
+  - AdcFilter: median of the last 3 inputs (kills single-block spikes, e.g.
+    a radio burst coupling into the pot wiper), then a first-order IIR with
+    a power-of-two weight: y += (x - y) / 2^SHIFT. The state keeps SHIFT
+    extra fraction bits, so slow drifts are not lost to truncation. The first
+    sample seeds it (no ramp from 0 after boot).
+  - Hysteresis: reports a new value only when it moved more than `band` from
+    the last reported one, so a knob sitting between two steps or a battery
+    wobbling under load does not produce a stream of change events
+  - liIonPercent(): state of charge of one Li-Ion cell from its resting
+    voltage (piecewise linear; coarse, but monotonic and cheap)
+
+  Quick start:
+    AdcFilter<2> f;          // IIR weight 1/4
+    Hysteresis h(40);        // 40 mV band
+    f.add(mv);
+    if (h.update(f.value())) onChange(h.value());
+*/
+
+template <uint8_t SHIFT>
+class AdcFilter
+{
+public:
+    void add(uint16_t x)
+    {
+        if (!_n)
+            _h[0] = _h[1] = _h[2] = x;
+        _h[_n++ % 3] = x;
+        uint16_t m = _median(_h[0], _h[1], _h[2]);
+        if (_n == 1)
+            _acc = (uint32_t)m << SHIFT;
+        else
+            _acc += (int32_t)m - (int32_t)(_acc >> SHIFT);
+        if (_n >= 3 * 256) // keep the index small, phase does not matter
+            _n = 3;
+    }
+
+    void reset() { _n = 0; }
+    bool ready() const { return _n != 0; }
+    uint16_t value() const { return (uint16_t)(_acc >> SHIFT); }
+
+private:
+    static uint16_t _median(uint16_t a, uint16_t b, uint16_t c)
+    {
+        if (a > b)
+        {
+            uint16_t t = a;
+            a = b;
+            b = t;
+        }
+        if (b > c)
+            b = c;
+        return a > b ? a : b;
+    }
+
+    uint16_t _h[3] = {0, 0, 0};
+    uint16_t _n = 0;
+    uint32_t _acc = 0;
+};
+
+class Hysteresis
+{
+public:
+    explicit Hysteresis(uint16_t band = 0) : _band(band) {}
+
+    void setBand(uint16_t band) { _band = band; }
+
+    // true when v is a new reported value
+    bool update(uint16_t v)
+    {
+        if (_have && (v > _out ? v - _out : _out - v) <= _band)
+            return false;
+        _have = true;
+        _out = v;
+        return true;
+    }
+
+    uint16_t value() const { return _out; }
+
+private:
+    uint16_t _band;
+    uint16_t _out = 0;
+    bool _have = false;
+};
+
+// Resting voltage (mV) of one Li-Ion cell -> 0..100 %
+inline uint8_t liIonPercent(uint16_t mv)
+{
+    static const uint16_t MV[] = {3300, 3600, 3700, 3750, 3800, 3900, 4000, 4100, 4200};
+    static const uint8_t PCT[] = {0, 5, 12, 25, 40, 60, 75, 90, 100};
+    const size_t N = sizeof(MV) / sizeof(MV[0]);
+    if (mv <= MV[0])
+        return 0;
+    for (size_t i = 1; i < N; i++)
+    {
+        if (mv < MV[i])
+            return (uint8_t)(PCT[i - 1] + (uint32_t)(mv - MV[i - 1]) * (PCT[i] - PCT[i - 1]) / (MV[i] - MV[i - 1]));
+    }
+    return 100;
+}
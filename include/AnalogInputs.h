@@ -0,0 +1,90 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include "AdcFilter.h"
+
+/*
+  AnalogInputs - potentiometer + battery voltage from the DMA ADC, cached
+  -----------------------------------------------------------------------
+  - ADC1 in continuous (DMA) mode scans both channels; loop() never waits for
+    a conversion, it reads cached values
+  - A low-priority task runs short bursts: start the scan, take one DMA frame,
+    stop, sleep for periodMs. The ADC driver holds an APB lock while scanning,
+    so bursts (not free-running DMA) keep light sleep possible between them.
+  - Per burst each channel's samples are averaged, calibrated to mV with
+    esp_adc_cal (eFuse Vref / two-point where burned), then AdcFilter
+    (median of 3 + IIR) and Hysteresis, so change events only fire on real
+    movement
+  - Pot: 0..100 % (with dead bands at both ends); battery: cell mV through
+    the divider ratio, plus a rough state of charge (liIonPercent)
+  - Both pins must be ADC1 (GPIO 32..39); ADC2 is unavailable with Wi-Fi on
+
+  Quick start:
+    AnalogInputs analog;
+    analog.begin(PIN_POT, PIN_BATT, 200);   // battery via a 1:1 divider (x2.00)
+    // loop():
+    uint8_t pct;
+    if (analog.potChanged(pct)) buzz.setVolume(pct);
+    uint16_t mv = analog.batteryMv();       // cached, never blocks
+*/
+
+class AnalogInputs
+{
+public:
+    struct Stats
+    {
+        uint32_t bursts = 0;
+        uint32_t samples = 0;
+        uint32_t overflows = 0; // DMA frames lost (driver pool full)
+        uint32_t timeouts = 0;  // bursts that produced no frame
+    };
+
+    // battRatioX100: cell voltage / pin voltage * 100 (divider); periodMs: time between bursts
+    bool begin(uint8_t potPin, uint8_t battPin, uint16_t battRatioX100 = 200, uint16_t periodMs = 40);
+    void setPeriod(uint16_t ms) { _periodMs = ms; }
+
+    // Cached, any task
+    bool isReady() const { return _ready; }
+    uint8_t potPct() const { return _potPct; }
+    uint16_t potMv() const { return _potMv; }
+    uint16_t batteryMv() const { return _battMv; }
+    uint8_t batteryPct() const { return liIonPercent(_battMv); }
+
+    // loop(): true once per change past the hysteresis band
+    bool potChanged(uint8_t &pct);
+    bool batteryChanged(uint16_t &mv);
+
+    Stats stats() const;
+    void printStats(Print &out) const;
+
+private:
+    static const uint8_t FRAME_BYTES = 128;       // one DMA frame: 64 samples, 32 per channel
+    static const uint16_t POT_MIN_MV = 100;       // dead bands: the pot ends never quite reach the rails
+    static const uint16_t POT_MAX_MV = 3000;
+    static const uint16_t POT_BAND_MV = 30;       // ~1 % of travel
+    static const uint16_t BATT_BAND_MV = 20;
+
+    static void _taskFn(void *arg);
+    void _burst();
+
+    uint8_t _potCh = 0, _battCh = 0;
+    uint16_t _battRatioX100 = 200;
+    volatile uint16_t _periodMs = 40;
+    esp_adc_cal_characteristics_t _cal;
+    TaskHandle_t _task = nullptr;
+
+    // task only
+    AdcFilter<2> _potFilter;  // knob: responsive
+    AdcFilter<4> _battFilter; // battery: slow, load steps averaged out
+    Hysteresis _potHyst{POT_BAND_MV};
+    Hysteresis _battHyst{BATT_BAND_MV};
+
+    // written by the task, read by loop()
+    mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    volatile bool _ready = false;
+    volatile uint16_t _potMv = 0, _battMv = 0;
+    volatile uint8_t _potPct = 0;
+    bool _potNew = false, _battNew = false;
+    Stats _stats;
+};
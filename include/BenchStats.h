@@ -0,0 +1,129 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  BenchStats - latency histogram and clock-offset filter for LatencyBench
+  -----------------------------------------------------------------------
+  - LatencyHist: fixed-width bins (BIN_US) up to BINS * BIN_US, one overflow bin;
+    percentiles resolve to the upper edge of their bin, max / min / mean are exact.
+    Thousands of samples in BINS * 2 bytes.
+  - ClockSync: offset of a remote clock from four timestamps per exchange
+    (t1 local send, t2 remote receive, t3 remote send, t4 local receive), as in
+    NTP: offset = ((t2 - t1) + (t3 - t4)) / 2. Queueing delay makes exchanges
+    asymmetric, so the exchange with the smallest round trip among the last N
+    wins; the window lets the estimate follow crystal drift.
+
+  Quick start:
+    LatencyHist<256, 200> h;          // 0..51.2 ms in 200 us bins
+    h.add(us);
+    uint32_t p99 = h.percentile(99);
+    ClockSync<8> sync;
+    sync.add(t1, t2, t3, t4);
+    uint32_t local = remoteUs - sync.offset();
+*/
+
+template <size_t BINS, uint32_t BIN_US>
+class LatencyHist
+{
+public:
+    void add(uint32_t us)
+    {
+        size_t b = us / BIN_US;
+        if (b >= BINS)
+            _over++;
+        else if (_bin[b] < 0xFFFF)
+            _bin[b]++;
+        if (!_n || us < _min)
+            _min = us;
+        if (us > _max)
+            _max = us;
+        _sum += us;
+        _n++;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < BINS; i++)
+            _bin[i] = 0;
+        _over = _n = 0;
+        _min = _max = 0;
+        _sum = 0;
+    }
+
+    uint32_t count() const { return _n; }
+    uint32_t min() const { return _min; }
+    uint32_t max() const { return _max; }
+    uint32_t mean() const { return _n ? (uint32_t)(_sum / _n) : 0; }
+    uint32_t overflow() const { return _over; }
+
+    // Nearest-rank percentile (pct 0..100), upper edge of its bin (never above max)
+    uint32_t percentile(uint8_t pct) const
+    {
+        if (!_n)
+            return 0;
+        uint32_t rank = ((uint32_t)pct * _n + 99) / 100;
+        if (!rank)
+            rank = 1;
+        uint32_t seen = 0;
+        for (size_t i = 0; i < BINS; i++)
+        {
+            seen += _bin[i];
+            if (seen >= rank)
+            {
+                uint32_t edge = (uint32_t)(i + 1) * BIN_US;
+                return edge < _max ? edge : _max;
+            }
+        }
+        return _max; // in the overflow bin
+    }
+
+private:
+    uint16_t _bin[BINS] = {0};
+    uint32_t _over = 0;
+    uint32_t _n = 0;
+    uint32_t _min = 0, _max = 0;
+    uint64_t _sum = 0;
+};
+
+template <size_t N>
+class ClockSync
+{
+public:
+    // One exchange; times wrap (micros()), only differences are used
+    void add(uint32_t t1, uint32_t t2, uint32_t t3, uint32_t t4)
+    {
+        Sample &s = _s[_next];
+        s.rtt = (t4 - t1) - (t3 - t2);
+        s.offset = (int32_t)(((int64_t)(int32_t)(t2 - t1) + (int32_t)(t3 - t4)) / 2);
+        _next = (_next + 1) % N;
+        if (_n < N)
+            _n++;
+    }
+
+    bool valid() const { return _n > 0; }
+    void clear() { _n = _next = 0; }
+
+    // remote - local, from the best (shortest round trip) recent exchange
+    int32_t offset() const { return _best().offset; }
+    uint32_t rtt() const { return _best().rtt; }
+
+private:
+    struct Sample
+    {
+        uint32_t rtt;
+        int32_t offset;
+    };
+
+    const Sample &_best() const
+    {
+        size_t b = 0;
+        for (size_t i = 1; i < _n; i++)
+            if (_s[i].rtt < _s[b].rtt)
+                b = i;
+        return _s[b];
+    }
+
+    Sample _s[N] = {};
+    size_t _n = 0, _next = 0;
+};
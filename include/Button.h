@@ -0,0 +1,63 @@
+#pragma once
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#include "GestureCore.h"
+
+/*
+  Button - interrupt-driven button with gestures, no polling
+  ----------------------------------------------------------
+  - The GPIO interrupt feeds every raw edge to GestureCore; a Press is queued
+    from the interrupt itself (leading-edge debounce), so the loop sees it as
+    soon as it is woken
+  - One esp_timer, re-armed for GestureCore::nextDeadline(): end of the
+    debounce lockout, hold ticks, long press. Nothing runs while the button
+    is idle.
+  - The interrupt is level-triggered and flipped to the opposite level on
+    every edge: that is edge detection that also works as the light-sleep
+    GPIO wake source (it replaces PowerManager::wakeOnButton())
+  - Events: Press, Release, HoldTick, LongPress, DoubleClick (GestureCore.h);
+    the optional wake function is called after new events (isr = true from
+    the interrupt) so an idle loop() handles them at once
+  - inject() feeds a simulated edge (used by the latency benchmark)
+
+  Quick start:
+    Button button;
+    button.begin(PIN_BTN, GestureCore::Config(), wakeLoop);  // active-low, internal pull-up
+    // loop():
+    GestureEvent e;
+    while (button.poll(e)) if (e.type == Gesture::LongPress) ...
+    bool held = button.isDown();
+*/
+
+class Button
+{
+public:
+    typedef void (*WakeFn)(bool isr);
+
+    bool begin(uint8_t pin, const GestureCore::Config &cfg = GestureCore::Config(), WakeFn wake = nullptr);
+
+    // loop(): next queued event
+    bool poll(GestureEvent &e);
+    bool isDown() const { return _core.isDown(); }
+
+    void setLongMs(uint16_t ms);
+    // Any task: a simulated raw edge
+    void inject(bool down);
+
+    GestureCore::Stats stats() const;
+
+private:
+    static void IRAM_ATTR _isr(void *arg);
+    static void _onTimer(void *arg);
+    void _arm(uint32_t nowUs);
+
+    uint8_t _pin = 0;
+    WakeFn _wake = nullptr;
+    esp_timer_handle_t _timer = nullptr;
+    bool _injected = false; // inject() owns the level until it releases
+
+    // shared by the interrupt, the timer task and loop()
+    mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    GestureCore _core;
+};
@@ -28,12 +28,15 @@ public:
     // resolutionBits: 8..15 (duty resolution; default 10 bits => 0..1023)
     void init(uint8_t pin = 5, uint8_t channel = 0, uint8_t timer = 0, uint8_t resolutionBits = 10);
 
-    // Play a built-in melody
+    // Play a built-in melody (from flash, no copy)
     void play(BuiltInMelody m, bool repeat = false);
 
     // Play a custom sequence (copied into internal buffer)
     void play(const std::vector<Note> &seq, bool repeat = false);
 
+    // Count the current note from startMs instead of now (ScenePlayer: one start tick for every output)
+    void restartAt(uint32_t startMs) { _noteStartMs = startMs; }
+
     // Stop / pause / resume
     void stop();
     void pause();
@@ -45,11 +48,15 @@ public:
     // Status
     bool isPlaying() const { return _playing && !_paused; }
     bool isPaused() const { return _paused; }
+    // Audible notes started so far, and micros() when the last one hit the pin (latency benchmark)
+    uint32_t tones() const { return _tones; }
+    uint32_t lastToneUs() const { return _toneUs; }
 
     // Options
     void setVolume(uint8_t pct);       // 0..100 (% duty)
     void setTempoFactor(float factor); // multiply note durations (e.g. 0.8 faster, 1.2 slower)
     void setRepeat(bool rep) { _repeat = rep; }
+    void setMaxNotes(uint8_t n) { _maxNotes = n; } // cut melodies started from now on (0 = whole melody)
 
     // Convenience one-shot beep (non-blocking fire-and-forget)
     void beep(uint16_t freqHz, uint16_t durMs);
@@ -57,6 +64,8 @@ public:
 private:
     void _applyNote(const Note &n);
     void _silence();
+    void _set(const Note *notes, size_t n);
+    void _start(bool repeat);
     void _startIfNeeded();
 
     // LEDC
@@ -66,16 +75,23 @@ private:
     uint8_t _resBits = 10;
     uint32_t _dutyMax = 1023; // (1<<_resBits)-1
 
-    // Playback state
+    // Playback state: _notes points at a flash table, _seq (custom sequence) or _beep
+    const Note *_notes = nullptr;
+    size_t _len = 0;
     std::vector<Note> _seq;
+    Note _beep = {0, 0};
     size_t _idx = 0;
     bool _repeat = false;
     bool _playing = false;
     bool _paused = false;
     uint32_t _noteStartMs = 0;
     float _tempo = 1.0f; // 1.0 = original speed
+    uint8_t _maxNotes = 0;
     uint32_t _curNoteDurMs = 0;
 
     // Volume (duty)
     uint16_t _duty = 512; // ~50%
+
+    uint32_t _tones = 0;
+    uint32_t _toneUs = 0;
 };
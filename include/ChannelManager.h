@@ -0,0 +1,139 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_wifi.h>
+#include "ReliableLink.h"
+
+/*
+  ChannelManager - channel discovery, cached reconnect and joint migration
+  ------------------------------------------------------------------------
+  - Boot: the agreed channel is read from NVS ("pair"/"chan") and applied at once;
+    without a cached one both ends start on the rendezvous channel.
+  - First pairing: once the peer answers, the unit with the lower MAC surveys the
+    candidates (promiscuous sniff: foreign frames + noise floor per channel),
+    proposes the quietest one with an acknowledged CMD_CHANNEL, both switch,
+    and the proposer verifies with probes (MAC-level ack ratio) before saving.
+    A failed verification returns to the previous channel and proposes the
+    next best candidate from there. The peer that was moved probes too, after
+    the proposer's verification is over, and saves the channel only if they
+    get through; otherwise it goes back as well (no split survives a reboot).
+  - The survey dwells on one channel per update() (13 x dwellMs in all):
+    loop() keeps running; frames sent meanwhile may need retries.
+  - Degradation: onSent() results feed a 32-frame window; if the ack ratio drops
+    below minAckPct, the channel is re-surveyed and both units migrate together.
+  - Lost peer: after many consecutive send failures, the candidates are swept
+    with probes until the peer's channel answers.
+
+  Quick start:
+    ChannelManager chan;
+    uint8_t ch = chan.begin(radio, PEER_MAC);   // before esp_now_init()
+    // onSent callback:  chan.onSent(status == ESP_NOW_SEND_SUCCESS);
+    // loop(), CMD_CHANNEL: chan.onPropose(frame.body<ChannelBody>()->channel);
+    // loop():           chan.update(millis());
+*/
+
+class ChannelManager
+{
+public:
+    enum class State : uint8_t
+    {
+        Idle,
+        Surveying, // sniffing one candidate per dwell
+        Proposing, // CMD_CHANNEL in flight on the old channel
+        Switching, // proposal accepted, switching shortly
+        Confirming, // moved by the peer: probing the new channel before saving it
+        Verifying, // probing the new channel
+        Sweeping   // peer lost: probing candidates one by one
+    };
+
+    // Loads the cached channel (or rendezvousCh) and tunes the radio to it.
+    // peerMac may be nullptr while unpaired: the manager then stays on rendezvousCh.
+    uint8_t begin(ReliableLink &radio, const uint8_t *peerMac, uint8_t rendezvousCh = 1);
+
+    // A new peer was paired (on the rendezvous channel): forget the cached channel
+    // so the first-pairing survey runs again
+    void newPeer(const uint8_t peerMac[6]);
+
+    // Go to the rendezvous channel (pairing window); update() stays idle until newPeer()
+    void rendezvous();
+
+    // Feed from the ESP-NOW send callback (Wi-Fi task)
+    void onSent(bool ok);
+    // Call from loop() when the peer's CMD_CHANNEL arrives (RxRing)
+    void onPropose(uint8_t ch);
+
+    // Call in loop(): drives pairing, migration, verification and sweeps
+    void update(uint32_t now);
+
+    // Survey candidates, then start a joint move to the best one (update() drives both)
+    void migrate();
+
+    uint8_t channel() const { return _ch; }
+    State state() const { return _state; }
+    uint8_t ackPercent() const; // over the last 32 unicast frames
+    bool isBusy() const { return _state != State::Idle; }
+
+    // Options
+    void setMinAckPercent(uint8_t pct) { _minAckPct = pct; }
+    void setSurveyDwellMs(uint16_t ms) { _dwellMs = ms; }
+
+private:
+    void _setPeer(const uint8_t peerMac[6]);
+    void _apply(uint8_t ch);
+    void _save(uint8_t ch);
+    void _surveyNext(uint32_t now);
+    void _stopSurvey();
+    bool _startNextCandidate();
+    void _sendProbe();
+    static void _sniff(void *buf, wifi_promiscuous_pkt_type_t);
+
+    static const uint8_t NUM_CH = 13;
+    static const uint8_t VERIFY_PROBES = 8;
+    static const uint8_t VERIFY_MIN_OK = 6;
+    static const uint8_t LOST_AFTER_FAILS = 12;
+    static const uint16_t PROBE_GAP_MS = 25;
+    // Confirming waits out the proposer's verification (and its way back on failure)
+    static const uint16_t CONFIRM_DELAY_MS = (VERIFY_PROBES + 4) * PROBE_GAP_MS;
+
+    ReliableLink *_radio = nullptr;
+    uint8_t _peer[6] = {0};
+    bool _hasPeer = false;
+    bool _initiator = false; // lower MAC runs the first-pairing survey
+    bool _cached = false;    // channel came from NVS / has been agreed
+    uint8_t _rendezvousCh = 1;
+    uint8_t _ch = 1;
+    uint8_t _prevCh = 1;
+    uint8_t _pendingCh = 0;
+    uint8_t _minAckPct = 60;
+    uint16_t _dwellMs = 100;
+
+    State _state = State::Idle;
+    uint32_t _stateAt = 0;
+    uint32_t _nextSweepAt = 0;
+
+    // Survey: score per channel (lower is quieter), then candidates ordered best first
+    uint8_t _surveyCh = 0;
+    uint16_t _score[NUM_CH + 1] = {0};
+    uint8_t _order[NUM_CH] = {0};
+    uint8_t _orderLen = 0;
+    uint8_t _orderIdx = 0;
+    uint32_t _proposeSent = 0; // radio.stats().sent right after our CMD_CHANNEL
+
+    // Probing (verify / sweep)
+    uint8_t _probes = 0;
+    uint32_t _okAtStart = 0;
+    uint8_t _sweepIdx = 0;
+
+    uint8_t _proposedCh = 0; // set by onPropose(), acted on by update()
+
+    // Written by the Wi-Fi task (send callback)
+    volatile uint32_t _history = 0; // 1 bit per unicast frame, newest in bit 0
+    volatile uint8_t _samples = 0;
+    volatile uint32_t _okCount = 0;
+    volatile uint8_t _failRun = 0;
+
+    // Survey accumulators (promiscuous callback)
+    static ChannelManager *_self;
+    volatile uint32_t _frames = 0;
+    volatile int32_t _noiseSum = 0;
+    volatile uint32_t _noiseN = 0;
+};
@@ -0,0 +1,219 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  GestureCore - debounce + gesture state machine behind Button
+  ------------------------------------------------------------
+  - Fed with raw level changes (onEdge, from the GPIO interrupt) and with
+    deadlines (onTimer, from a one-shot timer armed for nextDeadline())
+  - Debounce: the first edge out of a stable state is taken at once
+    (leadingEdge, no added latency) and the contact is then ignored for
+    debounceMs; when that lockout ends the settled level is sampled, so a
+    bounce that ends in the other state is still seen. With leadingEdge off,
+    an edge only counts if the level still holds after debounceMs (rejects
+    short spikes at the cost of debounceMs latency).
+  - Events, in a fixed queue (oldest dropped first when full):
+      Press / Release  - debounced edges (Release carries the held time)
+      HoldTick         - every holdTickMs while held
+      LongPress        - once, when held for longMs
+      DoubleClick      - a press within doubleMs of a short click's release
+  - Times are microseconds (wrapping micros())
+
+  Quick start:
+    GestureCore g;
+    g.onEdge(level == LOW, micros());                // interrupt
+    uint32_t due; if (g.nextDeadline(due)) arm(due); // after every call
+    g.onTimer(micros(), level == LOW);               // timer
+    GestureEvent e; while (g.pop(e)) ...
+*/
+
+enum class Gesture : uint8_t
+{
+    Press,
+    Release,
+    HoldTick,
+    LongPress,
+    DoubleClick
+};
+
+struct GestureEvent
+{
+    Gesture type;
+    uint32_t atUs;   // when it happened (Press: the first edge)
+    uint32_t heldMs; // Release / HoldTick / LongPress: time since the press
+};
+
+struct GestureConfig
+{
+    uint16_t debounceMs = 15;
+    uint16_t holdTickMs = 250;
+    uint16_t longMs = 1500;
+    uint16_t doubleMs = 300;
+    bool leadingEdge = true;
+};
+
+class GestureCore
+{
+public:
+    static const uint8_t QUEUE = 8;
+
+    typedef GestureConfig Config;
+
+    struct Stats
+    {
+        uint32_t edges = 0;   // raw interrupts
+        uint32_t bounces = 0; // edges swallowed by the debounce
+        uint32_t dropped = 0; // events lost to a full queue
+    };
+
+    void begin(const Config &cfg = Config(), bool down = false)
+    {
+        _cfg = cfg;
+        _down = down;
+        _state = State::Stable;
+        _head = _tail = 0;
+        _lastClickUs = 0;
+        _haveClick = false;
+    }
+
+    void setLongMs(uint16_t ms) { _cfg.longMs = ms; }
+
+    // Raw level change (interrupt context)
+    void onEdge(bool down, uint32_t nowUs)
+    {
+        _stats.edges++;
+        if (_state != State::Stable || down == _down)
+        {
+            _stats.bounces++;
+            return;
+        }
+        _state = State::Lockout;
+        _lockoutUs = nowUs;
+        if (_cfg.leadingEdge)
+            _change(down, nowUs);
+    }
+
+    // A deadline passed (timer context); down = current pin level
+    void onTimer(uint32_t nowUs, bool down)
+    {
+        if (_state == State::Lockout && _due(_lockoutUs + _ms(_cfg.debounceMs), nowUs))
+        {
+            _state = State::Stable;
+            if (down != _down && _cfg.leadingEdge)
+            {
+                // bounced into the other state: a real change, locked out again from here
+                _state = State::Lockout;
+                _lockoutUs = nowUs;
+                _change(down, nowUs);
+            }
+            else if (down != _down)
+            {
+                _change(down, _lockoutUs); // trailing edge: confirmed, dated to the edge
+            }
+        }
+        if (!_down)
+            return;
+        while (_due(_nextTickUs, nowUs))
+        {
+            _push(Gesture::HoldTick, _nextTickUs, (_nextTickUs - _pressUs) / 1000u);
+            _nextTickUs += _ms(_cfg.holdTickMs);
+        }
+        if (!_longFired && _due(_pressUs + _ms(_cfg.longMs), nowUs))
+        {
+            _longFired = true;
+            _push(Gesture::LongPress, nowUs, _cfg.longMs);
+        }
+    }
+
+    // Earliest time onTimer() has work; false if nothing is pending
+    bool nextDeadline(uint32_t &dueUs) const
+    {
+        bool have = false;
+        if (_state == State::Lockout)
+            _earliest(dueUs, have, _lockoutUs + _ms(_cfg.debounceMs));
+        if (_down)
+        {
+            _earliest(dueUs, have, _nextTickUs);
+            if (!_longFired)
+                _earliest(dueUs, have, _pressUs + _ms(_cfg.longMs));
+        }
+        return have;
+    }
+
+    bool pop(GestureEvent &e)
+    {
+        if (_head == _tail)
+            return false;
+        e = _q[_tail % QUEUE];
+        _tail++;
+        return true;
+    }
+
+    bool isDown() const { return _down; }
+    const Stats &stats() const { return _stats; }
+
+private:
+    enum class State : uint8_t
+    {
+        Stable,
+        Lockout // edges ignored until debounceMs after the last accepted one
+    };
+
+    static uint32_t _ms(uint16_t ms) { return (uint32_t)ms * 1000u; }
+    static bool _due(uint32_t at, uint32_t now) { return (int32_t)(now - at) >= 0; }
+    static void _earliest(uint32_t &best, bool &have, uint32_t t)
+    {
+        if (!have || (int32_t)(t - best) < 0)
+            best = t;
+        have = true;
+    }
+
+    void _change(bool down, uint32_t atUs)
+    {
+        _down = down;
+        if (down)
+        {
+            _push(Gesture::Press, atUs);
+            _pressWasDouble = _haveClick && !_due(_lastClickUs + _ms(_cfg.doubleMs), atUs);
+            if (_pressWasDouble)
+                _push(Gesture::DoubleClick, atUs);
+            _haveClick = false;
+            _pressUs = atUs;
+            _nextTickUs = atUs + _ms(_cfg.holdTickMs);
+            _longFired = false;
+            return;
+        }
+        uint32_t held = (atUs - _pressUs) / 1000u;
+        _push(Gesture::Release, atUs, held);
+        // a short click may start a double click; the second click of one may not
+        _haveClick = !_longFired && held < _cfg.longMs && !_pressWasDouble;
+        _lastClickUs = atUs;
+    }
+
+    void _push(Gesture t, uint32_t atUs, uint32_t heldMs = 0)
+    {
+        if ((uint8_t)(_head - _tail) >= QUEUE)
+        {
+            _tail++; // drop the oldest
+            _stats.dropped++;
+        }
+        _q[_head % QUEUE] = GestureEvent{t, atUs, heldMs};
+        _head++;
+    }
+
+    Config _cfg;
+    Stats _stats;
+    State _state = State::Stable;
+    bool _down = false;       // debounced level
+    uint32_t _lockoutUs = 0;
+    uint32_t _pressUs = 0;
+    uint32_t _nextTickUs = 0;
+    bool _longFired = false;
+    bool _haveClick = false;  // last release was a short click
+    bool _pressWasDouble = false;
+    uint32_t _lastClickUs = 0;
+
+    GestureEvent _q[QUEUE];
+    uint8_t _head = 0, _tail = 0;
+};
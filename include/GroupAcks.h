@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  GroupAcks - member table and per-message ACK aggregation for group mode
+  -----------------------------------------------------------------------
+  - Members are learned from their CMD_GROUP_ACKs (up to MAX_MEMBERS ids)
+  - begin(seq) starts collecting ACKs for one broadcast; ack() marks a member
+  - complete() once every known member acknowledged
+  - A member that left the room would hold every message at incomplete and
+    cost MAX_ATTEMPTS broadcasts each: one that missed MEMBER_MISSES messages
+    in a row is dropped (an ACK brings it back)
+  - GroupPolicy holds the timing shared by the firmware and the host benchmarks
+*/
+
+namespace GroupPolicy
+{
+    static const uint8_t MAX_MEMBERS = 16;
+    static const uint16_t ACK_JITTER_MS = 12; // receivers spread their ACKs over this window
+    static const uint16_t RTO_MS = 25;        // > ACK_JITTER_MS + airtime; doubled per retry
+    static const uint16_t RTO_MAX_MS = 200;
+    static const uint8_t MAX_ATTEMPTS = 5;
+    static const uint8_t BLIND_COPIES = 3; // broadcasts when no member is known yet
+    static const uint8_t MEMBER_MISSES = 3; // unacknowledged messages in a row before a member is dropped
+    static const uint8_t RELAY_TTL = 4;       // hop budget of messages we originate
+    static const uint16_t RELAY_JITTER_MS = 8; // relays spread their rebroadcasts over this window
+    static const uint8_t RELAY_SUPPRESS = 2;  // drop our rebroadcast after hearing this many copies
+    static const uint8_t RELAY_RETRIES = 2;   // repeats when nobody further out forwards ours
+    static const uint16_t RELAY_ECHO_MS = 12; // > RELAY_JITTER_MS + airtime
+}
+
+class GroupAcks
+{
+public:
+    // Returns the member index (learning it if new), or -1 if the table is full
+    int learn(uint32_t id)
+    {
+        for (uint8_t i = 0; i < _n; i++)
+            if (_ids[i] == id)
+                return i;
+        if (_n >= GroupPolicy::MAX_MEMBERS)
+            return -1;
+        _ids[_n] = id;
+        _missed[_n] = 0;
+        return _n++;
+    }
+
+    // Starts a message; the previous one's missing ACKs count against their members
+    void begin(uint16_t seq)
+    {
+        if (_started)
+            _age();
+        _started = true;
+        _seq = seq;
+        _acked = 0;
+    }
+
+    // Returns true if this ACK was new for the current message
+    bool ack(uint32_t id, uint16_t seq)
+    {
+        if (seq != _seq)
+            return false;
+        int i = learn(id);
+        if (i < 0)
+            return false;
+        uint16_t bit = (uint16_t)(1u << i);
+        if (_acked & bit)
+            return false;
+        _acked |= bit;
+        return true;
+    }
+
+    uint8_t members() const { return _n; }
+    uint8_t acked() const { return (uint8_t)__builtin_popcount(_acked); }
+    bool complete() const { return _n > 0 && acked() >= _n; }
+
+private:
+    void _age()
+    {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < _n; i++)
+        {
+            uint8_t missed = (_acked & (1u << i)) ? 0 : (uint8_t)(_missed[i] + 1);
+            if (missed >= GroupPolicy::MEMBER_MISSES)
+                continue;
+            _ids[n] = _ids[i];
+            _missed[n++] = missed;
+        }
+        _n = n;
+    }
+
+    uint32_t _ids[GroupPolicy::MAX_MEMBERS] = {0};
+    uint8_t _missed[GroupPolicy::MAX_MEMBERS] = {0}; // messages in a row without its ACK
+    uint8_t _n = 0;
+    bool _started = false;
+    uint16_t _acked = 0; // bit i = member i acknowledged _seq
+    uint16_t _seq = 0;
+};
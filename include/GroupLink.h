@@ -0,0 +1,146 @@
+#pragma once
+#include <Arduino.h>
+#include "Protocol.h"
+#include "TxQueue.h"
+#include "RelayCore.h"
+#include "GroupAcks.h"
+
+/*
+  GroupLink - one button alerts a whole room (broadcast fan-out)
+  --------------------------------------------------------------
+  - One ESP-NOW broadcast per message instead of N serial unicasts
+  - Frames carry a group id (receivers ignore other groups), the sender id
+    (low 4 bytes of its MAC) and a per-sender sequence number
+  - Receivers de-duplicate through a small LRU of (sender, seq)
+  - Optional ACKs: every member answers with a unicast CMD_GROUP_ACK after a
+    random 0..ACK_JITTER_MS delay; the sender aggregates them and rebroadcasts
+    with backoff only while some known member is missing. A member re-ACKs a
+    rebroadcast only if its previous ACK was not confirmed at MAC level.
+  - Members are learned from their ACKs and dropped after MEMBER_MISSES
+    unacknowledged messages in a row; with no member known, BLIND_COPIES
+    broadcasts are sent instead
+  - Relay mode (range extension): a relay rebroadcasts every group message it
+    has not seen before with ttl - 1 after a random 0..RELAY_JITTER_MS delay,
+    and drops its copy once RELAY_SUPPRESS copies were heard from other relays.
+    A rebroadcast nobody further out forwards is repeated (RELAY_RETRIES).
+    Relayed copies are never ACKed (the ACK could not reach the origin), so
+    multi-hop groups should run without ACKs and rely on the flood instead.
+
+  Quick start:
+    GroupLink group;
+    group.init(tx, GROUP_ID);               // after esp_now_init()
+    group.setRelay(true);                   // optional: rebroadcast for others
+    group.send(CMD_START, 1000);
+    // loop(), for each RxRing frame, after Proto::parse():
+    GroupMsg g;
+    if (group.onRecv(mac, frame, g)) { ...handle g.body.inner... }
+    // loop():
+    group.update();
+*/
+
+// A group message as held by the sender and the relay queue (wire layout: GroupBody)
+struct GroupMsg
+{
+    uint16_t seq;   // per-sender sequence
+    uint8_t flags;  // MSG_FLAG_ACK_REQ / MSG_FLAG_RELAYED
+    GroupBody body; // group, origin, ttl, inner command, lease
+};
+
+class GroupLink
+{
+public:
+    struct Stats
+    {
+        uint32_t sent = 0;       // messages
+        uint32_t frames = 0;     // broadcasts put on air (incl. retransmits)
+        uint32_t complete = 0;   // messages acknowledged by every known member
+        uint32_t incomplete = 0; // gave up with members missing
+        uint32_t acksRx = 0;
+        uint32_t acksTx = 0;
+        uint32_t duplicates = 0; // dropped by the seen-cache
+        uint32_t lastLatencyUs = 0; // first broadcast -> last ACK
+        uint32_t relayed = 0;    // rebroadcasts for other senders
+    };
+
+    void init(TxQueue &tx, uint8_t groupId, bool wantAcks = true);
+    bool isEnabled() const { return _group != 0; }
+
+    // relay: rebroadcast other senders' messages; ttl: hop budget of our own messages
+    void setRelay(bool relay, uint8_t ttl = GroupPolicy::RELAY_TTL);
+    bool isRelay() const { return _relay.isEnabled(); }
+
+    // Broadcast a signal to the group (retransmitted until all members ACK)
+    bool send(uint8_t inner, uint16_t leaseMs);
+    // Single broadcast without ACKs (keepalives)
+    bool sendOnce(uint8_t inner, uint16_t leaseMs);
+
+    // Call often in loop(): retransmits, sends jittered ACKs
+    void update();
+
+    // Call from loop() with a parsed frame (RxRing).
+    // Returns true for a new group message (copied to `out`).
+    bool onRecv(const uint8_t *srcMac, const Proto::Frame &f, GroupMsg &out);
+
+    // Call from the ESP-NOW send callback (confirms our unicast ACKs)
+    void onSent(const uint8_t *dstMac, bool ok);
+
+    // Status
+    bool isBusy() const { return _inFlight || _ackPending || _relay.hasPending(); }
+    uint8_t members() const { return _acks.members(); }
+    uint8_t acked() const { return _acks.acked(); }
+    uint32_t id() const { return _myId; }
+    const Stats &stats() const { return _stats; }
+    void printStats(Print &out) const;
+
+private:
+    bool _broadcast(const GroupMsg &g);
+    void _finish(bool complete);
+    static uint32_t _idFromMac(const uint8_t *mac);
+
+    TxQueue *_tx = nullptr;
+    uint8_t _group = 0;
+    bool _wantAcks = true;
+    uint8_t _ttl = GroupPolicy::RELAY_TTL;
+    uint32_t _myId = 0;
+    uint16_t _nextSeq = 0;
+
+    // Sender (loop task)
+    GroupMsg _msg{};
+    bool _inFlight = false;
+    uint8_t _attempts = 0;
+    uint8_t _maxAttempts = 0;
+    uint16_t _rtoMs = 0;
+    uint32_t _nextTxMs = 0;
+    uint32_t _firstTxUs = 0;
+    GroupAcks _acks;
+
+    // Incoming ACKs, queued by onRecv() and aggregated by update()
+    struct AckIn
+    {
+        uint32_t id;
+        uint16_t seq;
+        uint32_t us;
+    };
+    static const uint8_t ACK_Q = 8;
+    AckIn _ackQ[ACK_Q] = {};
+    uint8_t _ackHead = 0; // written by onRecv()
+    uint8_t _ackTail = 0; // written by update()
+
+    // Outgoing ACK, written by onRecv(), sent from update() after a jitter
+    bool _ackPending = false;
+    uint8_t _ackTo[6] = {0};
+    uint32_t _ackOrigin = 0;
+    uint16_t _ackSeq = 0;
+    uint32_t _ackAtMs = 0;
+
+    // Last ACK put on air and whether the sender's radio confirmed it (send callback)
+    uint8_t _ackSentTo[6] = {0};
+    uint32_t _ackSentOrigin = 0;
+    uint16_t _ackSentSeq = 0;
+    volatile bool _ackConfirmed = false;
+
+    // Receiver de-duplication and relay queue: filled by onRecv(), drained by update()
+    RelayCore<GroupMsg, 16, 4> _relay;
+
+    Stats _stats;
+};
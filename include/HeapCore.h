@@ -0,0 +1,133 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  HeapCore - allocation counts per subsystem tag, steady-state violations
+  -----------------------------------------------------------------------
+  - Slots: BOOT (before begin()), LOOP (loop task, no tag), TASKS (every other
+    task: Wi-Fi, timers, ...) and up to TAGS named ones (the loop() sections)
+  - Per slot: allocations and bytes requested. Frees are counted globally
+    (a block does not remember who allocated it: no header, so blocks from
+    unwrapped allocators can be freed through the wrapper safely).
+  - Steady state: once armed (from a given time on), every allocation by the
+    loop task is a violation; the first VIOLATIONS are kept with size, slot,
+    caller and time
+  - Counters are updated with atomics (several tasks allocate); the current
+    tag belongs to the loop task
+  - HeapMonitor feeds it from the malloc / free wrappers
+
+  Quick start:
+    HeapCore<16, 8> h;
+    uint8_t disp = h.tag("refresh");
+    uint8_t prev = h.enter(disp);  ... h.leave(prev);
+    h.onAlloc(h.current(), 24, caller, ms);   // loop task
+    h.arm(10000);                             // steady state from 10 s on
+*/
+
+template <uint8_t TAGS, uint8_t VIOLATIONS>
+class HeapCore
+{
+public:
+    enum Slot : uint8_t
+    {
+        BOOT,
+        LOOP,
+        TASKS,
+        FIRST_TAG
+    };
+    static const uint8_t SLOTS = FIRST_TAG + TAGS;
+    static const uint8_t KEPT = VIOLATIONS;
+
+    struct Violation
+    {
+        uintptr_t caller;
+        uint32_t size;
+        uint32_t ms;
+        uint8_t slot;
+    };
+
+    // Registers a tag (name must outlive the core); same name -> same slot, LOOP when full
+    uint8_t tag(const char *name)
+    {
+        for (uint8_t i = FIRST_TAG; i < _n; i++)
+            if (_name[i] == name)
+                return i;
+        if (_n >= SLOTS)
+            return LOOP;
+        _name[_n] = name;
+        return _n++;
+    }
+
+    void start() { _current = LOOP; } // boot allocations end here
+
+    // Loop task: tag scope; leave() with what enter() returned (scopes may nest)
+    uint8_t enter(uint8_t slot)
+    {
+        const uint8_t prev = _current;
+        _current = slot;
+        return prev;
+    }
+    void leave(uint8_t prev) { _current = prev; }
+    uint8_t current() const { return _current; }
+
+    // Returns true for a steady-state violation
+    bool onAlloc(uint8_t slot, size_t size, uintptr_t caller, uint32_t ms)
+    {
+        if (slot >= _n)
+            slot = LOOP;
+        __atomic_fetch_add(&_allocs[slot], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&_bytes[slot], (uint32_t)size, __ATOMIC_RELAXED);
+        if (!_armed || (int32_t)(ms - _armAt) < 0 || slot == TASKS || slot == BOOT)
+            return false;
+        const uint32_t i = __atomic_fetch_add(&_violations, 1, __ATOMIC_RELAXED);
+        if (i < VIOLATIONS)
+            _v[i] = Violation{caller, (uint32_t)size, ms, slot};
+        return true;
+    }
+    void onFree() { __atomic_fetch_add(&_frees, 1, __ATOMIC_RELAXED); }
+
+    // New window: violations counted again from fromMs on
+    void arm(uint32_t fromMs)
+    {
+        _armed = false;
+        _armAt = fromMs;
+        __atomic_store_n(&_violations, 0, __ATOMIC_RELAXED);
+        _armed = true;
+    }
+    void disarm() { _armed = false; }
+    bool armed() const { return _armed; }
+    uint32_t armedAt() const { return _armAt; }
+
+    uint8_t slots() const { return _n; }
+    const char *name(uint8_t slot) const
+    {
+        static const char *const FIXED[] = {"boot", "loop", "tasks"};
+        return slot < FIRST_TAG ? FIXED[slot] : slot < _n ? _name[slot] : "?";
+    }
+    uint32_t allocs(uint8_t slot) const { return _allocs[slot]; }
+    uint32_t bytes(uint8_t slot) const { return _bytes[slot]; }
+    uint32_t totalAllocs() const
+    {
+        uint32_t n = 0;
+        for (uint8_t i = 0; i < _n; i++)
+            n += _allocs[i];
+        return n;
+    }
+    uint32_t frees() const { return _frees; }
+    uint32_t violations() const { return _violations; } // since arm()
+    uint8_t keptViolations() const { return _violations < VIOLATIONS ? (uint8_t)_violations : VIOLATIONS; }
+    const Violation &violation(uint8_t i) const { return _v[i]; }
+
+private:
+    const char *_name[SLOTS] = {};
+    uint8_t _n = FIRST_TAG;
+    uint8_t _current = BOOT;
+    bool _armed = false;
+    uint32_t _armAt = 0;
+    uint32_t _allocs[SLOTS] = {0};
+    uint32_t _bytes[SLOTS] = {0};
+    uint32_t _frees = 0;
+    uint32_t _violations = 0;
+    Violation _v[VIOLATIONS] = {};
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <Arduino.h>
+#include "HeapCore.h"
+
+/*
+  HeapMonitor - heap numbers, allocations per loop() section, steady-state check
+  ------------------------------------------------------------------------------
+  - Always: free heap, its low-water mark since boot and the largest free
+    block (fragmentation: free memory the biggest request can no longer use)
+  - -DHEAP_ACCOUNTING=1 (env esp32dev-heap in platformio.ini) adds the
+    accounting: malloc / calloc / realloc / free are wrapped at link time
+    (-Wl,--wrap=...) and operator new / delete go through the same counters,
+    so Arduino String, std::vector, the Arduino core and the SDK code linked
+    with the sketch are all seen. Allocations made inside the ROM or straight
+    through heap_caps_malloc() (parts of the Wi-Fi stack) are not.
+  - Tags: every PROF("name", call) section of loop() is also a heap tag
+    (LoopProfiler.h); allocations are counted per section, "loop" for the rest
+    of the loop task, "tasks" for every other task, "boot" until begin()
+  - Steady state: from armAfterMs on, every allocation by the loop task is
+    logged (LOG_W, with the caller's address: xtensa-esp32-elf-addr2line) and
+    the first ones are kept for the report. A firmware fit to run for months
+    reports none.
+  - HEAP_REPORT(Serial) (serial 'h') prints it all and restarts the window
+  - Cost when enabled: one task-handle read and three atomic adds per
+    allocation; no header, blocks are unchanged
+
+  Quick start:
+    HEAP_BEGIN(10000);              // end of setup(): steady state from 10 s on
+    PROF("buzz", buzz.update());    // loop(): tagged "buzz"
+    HEAP_REPORT(Serial);            // serial 'h'
+*/
+
+#ifndef HEAP_ACCOUNTING
+#define HEAP_ACCOUNTING 0
+#endif
+
+class HeapMonitor
+{
+public:
+    typedef HeapCore<24, 8> Core;
+
+    // Free / low-water / largest block; works without the accounting
+    static void printHeap(Print &out);
+
+#if HEAP_ACCOUNTING
+    static void begin(uint32_t armAfterMs);
+    static void printReport(Print &out);
+    static uint8_t tag(const char *name) { return _core.tag(name); }
+
+    // From the wrappers (any task)
+    static void onAlloc(size_t size, void *caller);
+    static void onFree() { _core.onFree(); }
+
+    // Tags the loop task's allocations for its lifetime
+    class Scope
+    {
+    public:
+        explicit Scope(uint8_t tag) : _prev(HeapMonitor::_core.enter(tag)) {}
+        ~Scope() { HeapMonitor::_core.leave(_prev); }
+
+    private:
+        uint8_t _prev;
+    };
+
+private:
+    static Core _core;
+    static TaskHandle_t _loopTask;
+#endif
+};
+
+#if HEAP_ACCOUNTING
+#define HEAP_BEGIN(armAfterMs) HeapMonitor::begin(armAfterMs)
+#define HEAP_TAG(name)                                              \
+    static const uint8_t _heapTag = HeapMonitor::tag(name);         \
+    HeapMonitor::Scope _heapScope(_heapTag)
+#define HEAP_REPORT(out) HeapMonitor::printReport(out)
+#else
+#define HEAP_BEGIN(armAfterMs) ((void)0)
+#define HEAP_TAG(name) ((void)0)
+#define HEAP_REPORT(out) HeapMonitor::printHeap(out)
+#endif
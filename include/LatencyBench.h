@@ -0,0 +1,135 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "Protocol.h"
+#include "TxQueue.h"
+#include "Buzzer.h"
+#include "BenchStats.h"
+
+/*
+  LatencyBench - end-to-end button -> buzzer latency, measured on the real path
+  -----------------------------------------------------------------------------
+  - Sender (start()): presses the button itself, `presses` times. An esp_timer
+    fires at a random phase to the loop, timestamps the "edge" and hands it to
+    the press function (Button::inject()), so loop() sees it through the normal
+    gesture path and the debounce, wake-up, TX queue and everything else in
+    loop() count. Then:
+      send  - the START frame reaches esp_now_send()        (onTx)
+      sent  - its MAC-level completion                      (onSent)
+  - Receiver (always on, answers once the peer synced): timestamps the receive
+    callback of the START (RxMsg::atUs) and the first buzzer tone hitting the
+    pin (Buzzer::lastToneUs()), and reports both back in a BENCH_REPORT
+  - Clocks: a BENCH_SYNC exchange before every press; ClockSync keeps the
+    shortest round trip of the last SYNC_WINDOW, which also follows drift
+  - Histograms per stage (p50 / p99 / max): button->send, send->sent,
+    button->rx, rx->tone and button->tone (the product's latency)
+  - Needs the 1:1 link (GROUP_ID 0); both units run the same firmware
+
+  Quick start:
+    LatencyBench bench;
+    bench.begin(tx, buzz);  bench.setPeer(PEER_MAC);
+    bench.setPressFn([](bool down) { button.inject(down); });
+    // TX wrapper:       bench.onTx(data, len);  before esp_now_send()
+    // send callback:    bench.onSent(mac);
+    // receive (loop):   if (bench.onRecv(mac, frame, atUs)) return;
+    //                   fresh START from the peer: bench.onRxStart(frame.seq(), atUs);
+    // loop():           bench.update(millis());
+    bench.start(1000);      // serial 'b'; prints the report when done
+*/
+
+class LatencyBench
+{
+public:
+    typedef LatencyHist<640, 250> Hist; // 0..160 ms in 250 us bins
+    typedef void (*PressFn)(bool down);    // simulated button edge
+
+    enum class Stage : uint8_t
+    {
+        ButtonToSend,
+        SendToSent,
+        ButtonToRx,
+        RxToTone,
+        ButtonToTone,
+        Count
+    };
+
+    void begin(TxQueue &tx, Buzzer &buzz);
+    void setPeer(const uint8_t *peerMac);
+    void setPressFn(PressFn fn) { _press = fn; }
+
+    // Sender: automated presses, each held holdMs
+    void start(uint16_t presses = 1000, uint16_t holdMs = 150);
+    void stop();
+    bool isRunning() const { return _state != State::Idle; }
+
+    // Hooks
+    void onTx(const uint8_t *data, uint8_t len);                           // loop(), TX wrapper
+    void onSent(const uint8_t *mac);                                       // Wi-Fi task
+    bool onRecv(const uint8_t *srcMac, const Proto::Frame &f, uint32_t atUs); // loop(), CMD_BENCH
+    void onRxStart(uint16_t seq, uint32_t atUs);                           // loop(), receiver
+
+    void update(uint32_t now);
+
+    const Hist &hist(Stage s) const { return _hist[(uint8_t)s]; }
+    void printReport(Print &out) const;
+
+private:
+    enum class State : uint8_t
+    {
+        Idle,
+        Sync,  // BENCH_SYNC out, waiting for the ACK
+        Armed, // press timer running
+        Held,
+        Wait,  // released, waiting for the receiver's report
+        Gap
+    };
+
+    static const uint8_t SYNC_WINDOW = 8;
+    static const uint8_t SYNC_AT_START = 8; // exchanges before the first press
+    static const uint16_t SYNC_TIMEOUT_MS = 100;
+    static const uint16_t REPORT_TIMEOUT_MS = 1000;
+    static const uint16_t RESPONDER_MS = 5000; // receiver reports this long after a SYNC
+
+    static void _onPressTimer(void *arg);
+    void _send(const BenchBody &b);
+    void _sendSync();
+    void _record(Stage s, int32_t us);
+    void _finishPress(const BenchBody *report);
+
+    TxQueue *_tx = nullptr;
+    Buzzer *_buzz = nullptr;
+    PressFn _press = nullptr;
+    uint8_t _peer[6] = {0};
+    bool _hasPeer = false;
+    esp_timer_handle_t _timer = nullptr;
+
+    // Sender
+    State _state = State::Idle;
+    uint32_t _stateAt = 0;
+    uint16_t _pressesLeft = 0;
+    uint16_t _holdMs = 150;
+    uint8_t _syncLeft = 0;
+    uint16_t _syncId = 0;
+    volatile bool _down = false;     // set by the press timer
+    volatile uint32_t _edgeUs = 0;
+    volatile bool _awaitTx = false;  // press timer -> onTx()
+    uint16_t _startSeq = 0;
+    uint32_t _txUs = 0;
+    volatile bool _awaitSent = false;
+    volatile uint32_t _sentUs = 0;
+    BenchBody _report{};
+    bool _haveReport = false;
+    ClockSync<SYNC_WINDOW> _sync;
+
+    uint32_t _presses = 0, _reports = 0, _noReport = 0, _noSent = 0, _noTone = 0;
+    Hist _hist[(uint8_t)Stage::Count];
+
+    // Receiver
+    uint32_t _syncSeenAt = 0;
+    bool _responder = false;
+    bool _reportPending = false;
+    uint16_t _rxSeq = 0;
+    uint32_t _rxUs = 0;
+    uint32_t _rxAt = 0;
+    uint32_t _tonesAtRx = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_wifi.h>
+#include "AdaptCore.h"
+
+/*
+  LinkAdapter - lowest TX power and fastest rate that still get ACKed
+  -------------------------------------------------------------------
+  - A ladder of (ESP-NOW PHY rate, max TX power) levels, from 24 Mbps at
+    2 dBm up to 802.11 LR 250 kbps at 20 dBm. Short links end up sending
+    short, quiet frames (less airtime and energy per message); far ones get
+    the long-range modulation.
+  - onSent() results for the peer drive AdaptCore: below targetPct ACKed ->
+    one level more robust, long good stretches -> probe one level cheaper
+  - LR needs WIFI_PROTOCOL_LR on both ends; begin() enables it next to b/g/n,
+    so normal-rate frames are still received
+  - The level is saved per peer (NVS "link", key = peer MAC) once it held for
+    SAVE_AFTER_MS, and loaded by setPeer(), so a rebooted unit starts where
+    the link settled. Unknown peers start at the stack default (1 Mbps, 19.5 dBm).
+  - Rate and power are global to the interface (IDF 4.x has no per-peer rate):
+    the ladder follows the paired peer; broadcasts go out at the same setting
+
+  Quick start:
+    LinkAdapter adapt;
+    adapt.begin();                         // after WiFi.mode(WIFI_STA)
+    adapt.setPeer(PEER_MAC);
+    // send callback (peer only): adapt.onSent(status == ESP_NOW_SEND_SUCCESS);
+    // loop():                    adapt.update(millis());
+*/
+
+class LinkAdapter
+{
+public:
+    struct Level
+    {
+        wifi_phy_rate_t rate;
+        int8_t powerQdBm; // esp_wifi_set_max_tx_power() units: 0.25 dBm
+        const char *name;
+    };
+    static const uint8_t LEVELS = 7;
+    static const uint8_t DEFAULT_LEVEL = 4; // what the stack uses without us
+
+    void begin(uint8_t targetPct = 90);
+    void setPeer(const uint8_t *peerMac);
+
+    // Send callback (Wi-Fi task), unicast frames to the peer only
+    void onSent(bool ok);
+    // loop(): feeds the results to the controller, applies and persists the level
+    void update(uint32_t now);
+
+    uint8_t level() const { return _core.level(); }
+    const Level &current() const { return LADDER[_core.level()]; }
+    void printStats(Print &out) const;
+
+    static const Level LADDER[LEVELS];
+
+private:
+    static const uint32_t SAVE_AFTER_MS = 60000;
+
+    void _apply(uint8_t level);
+    void _key(char out[14]) const;
+
+    uint8_t _targetPct = 90;
+    uint8_t _peer[6] = {0};
+    bool _hasPeer = false;
+    uint8_t _saved = 0xFF; // level in NVS for this peer
+    uint32_t _changedAt = 0;
+    AdaptCore<LEVELS> _core;
+    uint32_t _ok[LEVELS] = {0}, _fail[LEVELS] = {0};
+
+    // Written by the Wi-Fi task: 1 bit per result, oldest in the highest valid bit
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t _bits = 0;
+    uint8_t _nBits = 0;
+    uint32_t _dropped = 0; // results beyond 32 between two update() calls
+};
@@ -0,0 +1,187 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+  LinkStats - round-trip and per-peer link counters for LinkTelemetry
+  -------------------------------------------------------------------
+  - RttWindow: the last N round-trip times; percentiles are computed on demand
+    (copy + insertion sort of N values, only when someone asks)
+  - PeerLink: per-peer MAC-level delivery (onSent), loss over the last 32
+    frames, recovered failures (retries), worst failure burst, and RSSI of
+    everything received from the peer (last / smoothed / min / max)
+  - PeerTable: fixed set of PeerLinks, least recently active one is replaced,
+    except the pinned one (the paired peer: it goes quiet exactly when its
+    link fails, and strangers' beacons must not push its counters out)
+  - Fixed memory, no allocation
+
+  Quick start:
+    RttWindow<32> rtt;
+    rtt.add(us);
+    uint32_t p99 = rtt.percentile(99);
+    PeerTable<4> peers;
+    peers.pin(PEER_MAC);
+    if (PeerLink *p = peers.find(mac, true)) p->onRx(rssi, nowMs);
+*/
+
+template <size_t N>
+class RttWindow
+{
+public:
+    void add(uint32_t us)
+    {
+        _v[_next] = us;
+        _next = (_next + 1) % N;
+        if (_n < N)
+            _n++;
+    }
+
+    size_t count() const { return _n; }
+    void clear() { _n = _next = 0; }
+
+    // Nearest-rank percentile (pct 0..100) of the window; 0 while empty
+    uint32_t percentile(uint8_t pct) const
+    {
+        if (!_n)
+            return 0;
+        uint32_t s[N];
+        memcpy(s, _v, sizeof(uint32_t) * _n);
+        for (size_t i = 1; i < _n; i++)
+        {
+            uint32_t x = s[i];
+            size_t j = i;
+            for (; j > 0 && s[j - 1] > x; j--)
+                s[j] = s[j - 1];
+            s[j] = x;
+        }
+        size_t rank = ((size_t)pct * _n + 99) / 100; // ceil(pct/100 * n), 1-based
+        return s[rank ? rank - 1 : 0];
+    }
+
+private:
+    uint32_t _v[N];
+    size_t _n = 0, _next = 0;
+};
+
+struct PeerLink
+{
+    uint8_t mac[6];
+    uint32_t txOk = 0;     // MAC-level ACK received
+    uint32_t txFail = 0;   // no MAC-level ACK
+    uint32_t retries = 0;  // failures followed by a success (the frame got through on a retransmit)
+    uint8_t failRun = 0;   // current run of failures
+    uint8_t maxFailRun = 0;
+    uint32_t history = 0;  // 1 bit per frame, newest in bit 0, 1 = failed
+    uint8_t samples = 0;   // valid bits in history (max 32)
+
+    uint32_t rxFrames = 0;
+    uint32_t rssiFrames = 0; // of those, with a measured RSSI (0 dBm = not available)
+    int8_t rssi = 0;       // last measured frame
+    int8_t rssiMin = 0, rssiMax = 0;
+    int16_t rssiAvg16 = 0; // smoothed (1/8 EWMA), dBm * 16
+    uint32_t lastRxMs = 0;
+    uint32_t activeMs = 0; // last tx or rx, for replacement
+    bool pinned = false;   // never replaced
+
+    void onSent(bool ok, uint32_t nowMs)
+    {
+        history = (history << 1) | (ok ? 0u : 1u);
+        if (samples < 32)
+            samples++;
+        activeMs = nowMs;
+        if (ok)
+        {
+            txOk++;
+            retries += failRun;
+            failRun = 0;
+            return;
+        }
+        txFail++;
+        if (failRun < 255)
+            failRun++;
+        if (failRun > maxFailRun)
+            maxFailRun = failRun;
+    }
+
+    void onRx(int8_t dBm, uint32_t nowMs)
+    {
+        rxFrames++;
+        lastRxMs = activeMs = nowMs;
+        if (!dBm)
+            return;
+        if (!rssiFrames++)
+        {
+            rssiMin = rssiMax = dBm;
+            rssiAvg16 = (int16_t)(dBm * 16);
+        }
+        else
+        {
+            if (dBm < rssiMin)
+                rssiMin = dBm;
+            if (dBm > rssiMax)
+                rssiMax = dBm;
+            rssiAvg16 += (int16_t)((dBm * 16 - rssiAvg16) / 8);
+        }
+        rssi = dBm;
+    }
+
+    int8_t rssiAvg() const { return (int8_t)(rssiAvg16 >= 0 ? (rssiAvg16 + 8) / 16 : (rssiAvg16 - 8) / 16); }
+
+    // Failed share of the last (up to) 32 frames
+    uint8_t lossPercent() const
+    {
+        if (!samples)
+            return 0;
+        uint32_t mask = samples >= 32 ? 0xFFFFFFFFu : ((1u << samples) - 1u);
+        return (uint8_t)(__builtin_popcount(history & mask) * 100u / samples);
+    }
+};
+
+template <size_t N>
+class PeerTable
+{
+public:
+    static_assert(N >= 2, "one entry is pinned");
+
+    // The entry for mac; with create, a new one (replacing the least recently
+    // active unpinned entry when full). nullptr if unknown and !create.
+    PeerLink *find(const uint8_t mac[6], bool create = false)
+    {
+        for (size_t i = 0; i < _n; i++)
+            if (memcmp(_p[i].mac, mac, 6) == 0)
+                return &_p[i];
+        if (!create)
+            return nullptr;
+        size_t slot = _n;
+        if (_n < N)
+            _n++;
+        else
+        {
+            slot = _p[0].pinned ? 1 : 0; // one pinned at most
+            for (size_t i = slot + 1; i < N; i++)
+                if (!_p[i].pinned && (int32_t)(_p[i].activeMs - _p[slot].activeMs) < 0)
+                    slot = i;
+        }
+        _p[slot] = PeerLink();
+        memcpy(_p[slot].mac, mac, 6);
+        return &_p[slot];
+    }
+
+    // Keeps mac's entry (created if needed) for good; one at a time, nullptr = none
+    void pin(const uint8_t *mac)
+    {
+        for (size_t i = 0; i < _n; i++)
+            _p[i].pinned = false;
+        if (mac)
+            find(mac, true)->pinned = true;
+    }
+    const PeerLink *find(const uint8_t mac[6]) const { return const_cast<PeerTable *>(this)->find(mac, false); }
+
+    size_t size() const { return _n; }
+    const PeerLink &operator[](size_t i) const { return _p[i]; }
+
+private:
+    PeerLink _p[N];
+    size_t _n = 0;
+};
@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+#include "Protocol.h"
+#include "TxQueue.h"
+#include "LinkStats.h"
+#include "SevenSegmentDisplay.h"
+
+/*
+  LinkTelemetry - how healthy is the link, before alerts stop arriving
+  --------------------------------------------------------------------
+  - Ping: every pingMs (0 = none; main follows the view and the power tier,
+    as each PING wakes the peer's radio) a CMD_PING carrying our timestamp
+    goes to the peer, which echoes it at once as CMD_PONG; RTT = PONG arrival -
+    timestamp, so it covers queueing, air time and the responder's loop. The
+    last RTT_WINDOW results give p50 / p90 / p99 / max; a PONG missing after
+    pingTimeoutMs is lost.
+  - Per peer (PeerTable): MAC-level delivery from onSent (ok / fail, loss over
+    the last 32 frames, retries = failures later recovered, worst failure
+    burst) and the RSSI of every frame received from it. The PONG also carries
+    the RSSI the peer measured on our PING, i.e. the other direction.
+  - RSSI comes from the receive callback (esp_now_recv_info_t::rx_ctrl on
+    IDF 5; IDF 4.x only with RX_RSSI_IDF4, see rxRssi() in main.cpp), recorded
+    per frame in RxRing; 0 = not available, counted but kept out of the RSSI
+    figures
+  - Optional display view: RSSI (-dBm), median RTT (ms) or loss (%) on the two
+    digits; values over 99 show "HI", no data "--"
+
+  Quick start:
+    LinkTelemetry telem;
+    telem.begin(tx);
+    telem.setPeer(PEER_MAC);                       // ping target, nullptr = no pings
+    telem.setPingPeriod(4000);                     // e.g. slower on battery, 0 = no pings
+    // send callback:  telem.onSent(mac, status == ESP_NOW_SEND_SUCCESS);
+    // every received frame (loop): telem.onRx(msg.mac, msg.rssi);
+    //                              if (telem.onRecv(msg.mac, frame, msg.atUs)) return;
+    // loop():         telem.update(millis());
+    LinkTelemetry::Rtt r = telem.rtt();            // r.p99Us ...
+*/
+
+class LinkTelemetry
+{
+public:
+    static const uint8_t RTT_WINDOW = 32;
+    static const uint8_t MAX_PEERS = 4;
+
+    struct Rtt
+    {
+        uint32_t pings = 0;  // sent
+        uint32_t pongs = 0;  // answered in time
+        uint32_t lost = 0;   // no PONG within pingTimeoutMs
+        uint32_t late = 0;   // PONG for an older PING (already counted lost)
+        uint32_t p50Us = 0, p90Us = 0, p99Us = 0, maxUs = 0; // over the last RTT_WINDOW
+        int8_t peerRssi = 0; // last RSSI the peer reported for our PINGs
+    };
+
+    enum class View : uint8_t
+    {
+        Off,
+        Rssi, // smoothed RSSI of the peer, -dBm
+        RttMs, // median RTT, ms
+        Loss, // MAC-level loss over the last 32 frames, %
+        Count // number of views, not a view
+    };
+
+    void begin(TxQueue &tx, uint16_t pingMs = 2000, uint16_t pingTimeoutMs = 500);
+    void setPeer(const uint8_t *peerMac);
+    // 0 = no PINGs; from 0, the first one goes out at the next update()
+    void setPingPeriod(uint16_t ms);
+
+    // Send callback (Wi-Fi task)
+    void onSent(const uint8_t *mac, bool ok);
+    // loop(): every received frame, before dispatch
+    void onRx(const uint8_t *mac, int8_t rssi);
+    // loop(): consumes CMD_PING / CMD_PONG; atUs = arrival time (RxMsg::atUs)
+    bool onRecv(const uint8_t *srcMac, const Proto::Frame &f, uint32_t atUs);
+
+    // loop(): sends the next PING, expires an unanswered one
+    void update(uint32_t now);
+
+    Rtt rtt() const;
+    // Copy of a peer's counters; false if nothing was exchanged with it yet
+    bool peer(const uint8_t *mac, PeerLink &out) const;
+
+    // Display view: render() writes it to the display (false with View::Off)
+    void setView(View v) { _view = v; }
+    View view() const { return _view; }
+    bool render(SevenSegmentText &disp) const;
+
+    void printStats(Print &out) const;
+
+private:
+    void _sendPing(uint32_t now);
+
+    TxQueue *_tx = nullptr;
+    uint8_t _peer[6] = {0};
+    bool _hasPeer = false;
+    uint16_t _pingMs = 2000;
+    uint16_t _pingTimeoutMs = 500;
+    View _view = View::Off;
+
+    uint16_t _pingSeq = 0;
+    bool _pingPending = false;
+    uint32_t _pingAt = 0;     // millis() of the pending PING
+    uint32_t _nextPingAt = 0;
+
+    Rtt _rtt;
+    RttWindow<RTT_WINDOW> _window;
+
+    // onSent() updates the table from the Wi-Fi task
+    mutable portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    PeerTable<MAX_PEERS> _peers;
+};
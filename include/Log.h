@@ -0,0 +1,97 @@
+#pragma once
+#include <Arduino.h>
+#include "LogCore.h"
+
+/*
+  Log - non-blocking printf for callbacks, timers and loop()
+  ----------------------------------------------------------
+  - LOG_E / LOG_W / LOG_I / LOG_D(fmt, args...) queue a record (format
+    pointer + raw arguments, LogCore.h) and return: no formatting, no UART.
+    A low-priority task formats and writes them to Serial, so a Wi-Fi callback
+    never waits for 115200 baud.
+  - Full ring: the record is dropped and counted; the task prints
+    "log: N dropped" before the next line it writes
+  - Compile-time filter: -DLOG_LEVEL=LOG_LEVEL_WARN (platformio.ini) removes
+    the INFO / DEBUG calls entirely (default INFO)
+  - Formats are checked at compile time as for printf. Arguments are copied
+    by value: %s only with strings that outlive the record (literals, static
+    tables), never String::c_str() of a temporary
+  - Records written before begin() wait in the ring
+
+  Quick start:
+    Log::begin(Serial);                       // setup(), after Serial.begin()
+    LOG_I("seq %u: ACK in %lu us\n", seq, (unsigned long)us);
+*/
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+class Log
+{
+public:
+    static const uint16_t RECORDS = 64; // ~2.8 KB
+
+    static bool begin(Print &out, UBaseType_t priority = tskIDLE_PRIORITY + 1);
+
+    // Any task or ISR
+    template <typename... A>
+    static void write(uint8_t level, const char *fmt, A... args)
+    {
+        static_assert(sizeof...(A) <= LogRecord::MAX_ARGS, "too many log arguments");
+        const uintptr_t v[] = {logArg(args)..., 0};
+        LogRecord r;
+        r.fmt = fmt;
+        r.level = level;
+        r.ms = millis();
+        r.n = sizeof...(A);
+        for (uint8_t i = 0; i < r.n; i++)
+            r.arg[i] = v[i];
+        if (_ring.push(r))
+            _wake();
+    }
+
+    static uint32_t dropped() { return _dropped; } // total, for the stats
+
+private:
+    static void _wake();
+    static void _taskFn(void *);
+
+    static LogRing<RECORDS> _ring;
+    static Print *_out;
+    static TaskHandle_t _task;
+    static uint32_t _dropped;
+};
+
+// Never called: lets the compiler check the format against the real argument types
+static inline void logCheck(const char *, ...) __attribute__((format(printf, 1, 2)));
+static inline void logCheck(const char *, ...) {}
+
+#define LOG_AT(level, fmt, ...)                  \
+    do                                           \
+    {                                            \
+        if (0)                                   \
+            logCheck(fmt, ##__VA_ARGS__);        \
+        Log::write(level, fmt, ##__VA_ARGS__);   \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(fmt, ...) LOG_AT(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOG_E(fmt, ...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(fmt, ...) LOG_AT(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOG_W(fmt, ...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(fmt, ...) LOG_AT(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOG_I(fmt, ...) ((void)0)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(fmt, ...) LOG_AT(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) ((void)0)
+#endif
@@ -0,0 +1,137 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <type_traits>
+
+/*
+  LogCore - deferred printf: format pointer + raw arguments in a bounded ring
+  ---------------------------------------------------------------------------
+  - LogRecord: the format string's address (string literals live forever, so
+    the pointer is the format ID), up to MAX_ARGS integer / pointer arguments,
+    level and timestamp. Formatting happens later, on the consumer side.
+  - LogRing: bounded multi-producer / single-consumer queue (per-slot sequence
+    numbers, one compare-and-swap per record). No lock, no waiting: a full
+    ring drops the record and counts it. Any task or ISR may write; one
+    consumer reads.
+  - Arguments are captured as uintptr_t: integers, chars, bools and pointers
+    to strings that outlive the record (literals, static tables). Floats and
+    64-bit integers do not fit and fail to compile (logArg()).
+
+  Quick start:
+    LogRing<64> ring;
+    LogRecord r;  r.fmt = "seq %u: %s\n";  r.arg[0] = 7;  r.arg[1] = (uintptr_t)"ok";  r.n = 2;
+    ring.push(r);
+    LogRecord out;
+    while (ring.pop(out)) { char buf[128]; logFormat(out, buf, sizeof(buf)); }
+*/
+
+// Levels are macros: Log.h compares them in #if to compile calls out
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+struct LogRecord
+{
+    static const uint8_t MAX_ARGS = 8;
+
+    const char *fmt = nullptr;
+    uintptr_t arg[MAX_ARGS] = {0};
+    uint32_t ms = 0;
+    uint8_t n = 0;
+    uint8_t level = LOG_LEVEL_INFO;
+};
+
+// Argument capture: what the record can carry, by value
+template <typename T>
+inline uintptr_t logArg(T v)
+{
+    static_assert((std::is_integral<T>::value || std::is_enum<T>::value) && sizeof(T) <= sizeof(uintptr_t),
+                  "log arguments: integers, enums and pointers only");
+    return (uintptr_t)v;
+}
+template <typename T>
+inline uintptr_t logArg(T *p) { return (uintptr_t)p; }
+template <typename T>
+inline uintptr_t logArg(const T *p) { return (uintptr_t)p; }
+
+// Formats a record; every argument slot is passed, printf ignores the unused ones
+inline int logFormat(const LogRecord &r, char *buf, size_t size)
+{
+    const uintptr_t *a = r.arg;
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+    return snprintf(buf, size, r.fmt, a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7]);
+#pragma GCC diagnostic pop
+}
+
+template <uint16_t N>
+class LogRing
+{
+    static_assert((N & (N - 1)) == 0, "LogRing size must be a power of two");
+
+public:
+    LogRing()
+    {
+        for (uint16_t i = 0; i < N; i++)
+            _cell[i].seq = i;
+    }
+
+    // Any context; false (and counted) when the ring is full
+    bool push(const LogRecord &r)
+    {
+        uint32_t pos = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+        Cell *c;
+        for (;;)
+        {
+            c = &_cell[pos & (N - 1)];
+            const int32_t diff = (int32_t)(__atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) - pos);
+            if (diff == 0)
+            {
+                if (__atomic_compare_exchange_n(&_head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                    break; // slot claimed
+            }
+            else if (diff < 0)
+            {
+                __atomic_fetch_add(&_dropped, 1, __ATOMIC_RELAXED);
+                return false; // the consumer has not freed it yet
+            }
+            else
+                pos = __atomic_load_n(&_head, __ATOMIC_RELAXED); // another producer took it
+        }
+        c->rec = r;
+        __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE); // publish
+        return true;
+    }
+
+    // Single consumer
+    bool pop(LogRecord &out)
+    {
+        Cell &c = _cell[_tail & (N - 1)];
+        if ((int32_t)(__atomic_load_n(&c.seq, __ATOMIC_ACQUIRE) - (_tail + 1)) < 0)
+            return false; // empty, or the next record is still being written
+        out = c.rec;
+        __atomic_store_n(&c.seq, _tail + N, __ATOMIC_RELEASE); // free for the next lap
+        _tail++;
+        return true;
+    }
+
+    // Drops since the last call
+    uint32_t takeDropped() { return __atomic_exchange_n(&_dropped, 0, __ATOMIC_RELAXED); }
+    static uint16_t capacity() { return N; }
+
+private:
+    struct Cell
+    {
+        uint32_t seq;
+        LogRecord rec;
+    };
+
+    Cell _cell[N];
+    uint32_t _head = 0;
+    uint32_t _tail = 0;
+    uint32_t _dropped = 0;
+};
@@ -0,0 +1,114 @@
+#pragma once
+#include <Arduino.h>
+#include "ProfileCore.h"
+#include "HeapMonitor.h"
+
+/*
+  LoopProfiler - where loop() spends its time, in CPU cycles (CCOUNT)
+  -------------------------------------------------------------------
+  - PROF_LOOP_BEGIN() / PROF_LOOP_END() around the work of one loop() pass,
+    PROF("name", call) around each driver update() / refresh() / callback
+    worth watching. Log2 histograms per section and per pass, the slowest
+    samples tagged with the section responsible ("other": code outside every
+    section, e.g. a delay() or a Serial.printf)
+  - Samples over the budget (default 2 ms) are counted as blocking calls
+  - PROF_REPORT(Serial) prints count / mean / p50 / p99 / max / blocking per
+    section and the worst offenders, then starts a new window
+  - Build with -DLOOP_PROFILER=1 (platformio.ini). Otherwise every macro
+    compiles to the bare call: no code, no RAM
+  - Cycles count CPU work: they stop in light sleep (end the pass before
+    power.idle()) and scale with DFS; us are shown at the current CPU clock
+  - Overhead when enabled: two CCOUNT reads and ProfileCore::record() per
+    section (~50 cycles, measured by begin() and printed with the report)
+  - loop() task only (no locking)
+  - Each PROF() section is also a heap tag (HeapMonitor.h), with or without
+    the profiler
+
+  Quick start:
+    PROF_BEGIN();                   // setup()
+    // loop():
+    PROF_LOOP_BEGIN();
+    PROF("refresh", disp.refresh());
+    PROF("radio", radio.update());
+    PROF_LOOP_END();
+    power.idle();
+    // serial 'p':
+    PROF_REPORT(Serial);
+*/
+
+#ifndef LOOP_PROFILER
+#define LOOP_PROFILER 0
+#endif
+
+#if LOOP_PROFILER
+
+class LoopProfiler
+{
+public:
+    typedef ProfileCore<24, 8> Core;
+
+    static uint32_t cycles() { return ESP.getCycleCount(); }
+
+    void begin(uint32_t budgetUs = 2000);
+    uint8_t section(const char *name) { return _core.section(name); }
+
+    void beginLoop()
+    {
+        _core.beginLoop();
+        _loopStart = cycles();
+    }
+    void endLoop() { _core.endLoop(cycles() - _loopStart, millis()); }
+    void record(uint8_t id, uint32_t start) { _core.record(id, cycles() - start, millis()); }
+
+    void printReport(Print &out);
+    const Core &core() const { return _core; }
+
+    // Times its own lifetime as one sample of a section
+    class Scope
+    {
+    public:
+        explicit Scope(uint8_t id) : _id(id), _start(LoopProfiler::cycles()) {}
+        ~Scope();
+
+    private:
+        uint8_t _id;
+        uint32_t _start;
+    };
+
+private:
+    Core _core;
+    uint32_t _loopStart = 0;
+    uint32_t _overhead = 0; // cycles of an empty PROF(), measured by begin()
+};
+
+extern LoopProfiler loopProfiler;
+
+inline LoopProfiler::Scope::~Scope() { loopProfiler.record(_id, _start); }
+
+#define PROF_BEGIN() loopProfiler.begin()
+#define PROF_LOOP_BEGIN() loopProfiler.beginLoop()
+#define PROF_LOOP_END() loopProfiler.endLoop()
+#define PROF(name, call)                                                     \
+    do                                                                       \
+    {                                                                        \
+        static const uint8_t _profId = loopProfiler.section(name);           \
+        HEAP_TAG(name);                                                      \
+        LoopProfiler::Scope _profScope(_profId);                             \
+        call;                                                                \
+    } while (0)
+#define PROF_REPORT(out) loopProfiler.printReport(out)
+
+#else
+
+#define PROF_BEGIN() ((void)0)
+#define PROF_LOOP_BEGIN() ((void)0)
+#define PROF_LOOP_END() ((void)0)
+#define PROF(name, call) \
+    do                   \
+    {                    \
+        HEAP_TAG(name);  \
+        call;            \
+    } while (0)
+#define PROF_REPORT(out) (out).println("prof: off (build with -DLOOP_PROFILER=1)")
+
+#endif
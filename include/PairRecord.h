@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+
+// Persisted peer, stored as one blob in Preferences ("pair" namespace, key "peer").
+// Shared by the firmware (Pairing) and the standalone test sketch.
+
+enum PeerCaps : uint8_t
+{
+    CAP_DISPLAY = 1 << 0,
+    CAP_BUZZER = 1 << 1,
+    CAP_LEDS = 1 << 2,
+    CAP_BATTERY = 1 << 3
+};
+
+struct __attribute__((packed)) PairRecord
+{
+    uint8_t mac[6];
+    uint8_t caps; // PeerCaps of the peer
+};
@@ -0,0 +1,78 @@
+#pragma once
+#include <Arduino.h>
+#include "Protocol.h"
+#include "TxQueue.h"
+#include "PairRecord.h"
+
+/*
+  Pairing - zero-config pairing via broadcast discovery
+  -----------------------------------------------------
+  - start() opens a pairing window: a CMD_PAIR_BEACON (with our capabilities)
+    is broadcast every beaconMs on the current (rendezvous) channel
+  - A unit in pairing mode that hears a beacon answers with a unicast
+    CMD_PAIR_ACCEPT, but adopts nobody yet. Hearing an ACCEPT adopts its
+    sender (it chose us) and answers with an ACCEPT of our own, which lets the
+    sender adopt us in turn; so two units long-pressed within the same window
+    pair with each other, and neither one commits on a frame the other may
+    never have received. Until the window would have closed, a paired unit
+    answers its new peer's beacons again (the confirming ACCEPT was lost).
+  - The peer is persisted in Preferences ("pair" namespace, key "peer") as one
+    PairRecord blob, so boot loads MAC + capabilities with a single read
+
+  Quick start:
+    Pairing pairing;
+    if (pairing.begin(tx, CAP_DISPLAY | CAP_BUZZER | CAP_LEDS)) use(pairing.peerMac());
+    // long press:          pairing.start(millis());
+    // loop(), RxRing frame: if (pairing.onRecv(mac, frame)) return;
+    // loop():              if (pairing.update(millis()) == Pairing::Event::Paired) ...
+*/
+
+class Pairing
+{
+public:
+    enum class Event : uint8_t
+    {
+        None,
+        Paired,
+        TimedOut
+    };
+
+    // Loads the cached peer; returns true if one exists. Frames go out through `tx`.
+    bool begin(TxQueue &tx, uint8_t myCaps);
+
+    // Pairing window
+    void start(uint32_t now, uint16_t windowMs = 30000, uint16_t beaconMs = 200);
+    void cancel();
+    bool isActive() const { return _active; }
+
+    // Call from loop() with a parsed frame (RxRing); returns true if it was a pairing frame
+    bool onRecv(const uint8_t *srcMac, const Proto::Frame &f);
+
+    // Call in loop(): sends beacons, completes or times out the window
+    Event update(uint32_t now);
+
+    // Peer
+    bool isPaired() const { return _paired; }
+    const uint8_t *peerMac() const { return _rec.mac; }
+    uint8_t peerCaps() const { return _rec.caps; }
+    void forget();
+
+private:
+    void _beacon();
+    void _accept(const uint8_t *mac);
+    void _save();
+
+    TxQueue *_tx = nullptr;
+    uint8_t _myCaps = 0;
+    PairRecord _rec{};
+    bool _paired = false;
+
+    bool _active = false;
+    uint32_t _until = 0;
+    uint32_t _nextBeacon = 0;
+    uint16_t _beaconMs = 200;
+
+    // Set by onRecv() when a peer answered, consumed by update()
+    bool _found = false;
+    PairRecord _candidate{};
+};
@@ -0,0 +1,157 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  PowerGovernor - battery voltage -> power tier, and what each tier may spend
+  ---------------------------------------------------------------------------
+  - Tiers, from full service down: Full, Eco, Low, Critical. The UI and the
+    radio ask profile() what they may spend instead of using fixed values.
+  - The first reading after begin() sets the tier at once: a device switched
+    on with a flat cell must not spend dwellMs (or several) at Full.
+  - Fed with the filtered cell voltage (AnalogInputs). Going down needs the
+    voltage below a threshold for dwellMs (a buzzer burst or a TX spike sags
+    the cell for a moment); going back up (charger plugged in) also needs
+    hysteresisMv above it, so a cell resting on a threshold does not flap.
+  - Below absentMv no cell is sensed (USB only, divider not fitted): Full
+  - Critical is meant to end in deep sleep; the caller does that
+
+  Quick start:
+    PowerGovernor gov;
+    // loop():
+    if (gov.update(analog.batteryMv(), millis())) applyTier(gov.profile());
+    Serial.println(PowerGovernor::name(gov.tier()));
+*/
+
+enum class PowerTier : uint8_t
+{
+    Full,
+    Eco,
+    Low,
+    Critical
+};
+
+enum class MelodyPolicy : uint8_t
+{
+    All,      // everything as composed
+    Short,    // melodies cut to maxNotes
+    AlertOnly // only the remote signal sounds, cut to maxNotes
+};
+
+// What a tier may spend; percentages scale the user's settings (knob)
+struct TierProfile
+{
+    uint8_t displayPct;     // display ON time
+    uint8_t ledPct;         // LED brightness
+    uint8_t volumePct;      // buzzer duty
+    MelodyPolicy melodies;
+    uint8_t maxNotes;       // Short / AlertOnly: notes per melody
+    uint16_t radioWakeMs;   // ESP-NOW listen interval while idle
+    uint16_t adcPeriodMs;   // AnalogInputs burst period
+};
+
+struct GovernorConfig
+{
+    uint16_t ecoMv = 3750;      // below: Eco   (~30 %)
+    uint16_t lowMv = 3600;      // below: Low   (~5 %)
+    uint16_t criticalMv = 3400; // below: Critical, protect the cell
+    uint16_t hysteresisMv = 80; // extra needed to climb back up
+    uint32_t dwellMs = 10000;   // how long a new tier must hold
+    uint16_t absentMv = 2500;   // below: no cell sensed
+};
+
+class PowerGovernor
+{
+public:
+    typedef GovernorConfig Config;
+
+    void begin(const Config &cfg = Config())
+    {
+        _cfg = cfg;
+        _tier = PowerTier::Full;
+        _pending = false;
+        _changes = 0;
+        _started = false;
+    }
+
+    // Returns true when the tier changed
+    bool update(uint16_t mv, uint32_t nowMs)
+    {
+        PowerTier target = _tierFor(mv);
+        if (!_started) // boot: no history to smooth over
+        {
+            _started = true;
+            if (target == _tier)
+                return false;
+            _tier = target;
+            _changes++;
+            return true;
+        }
+        if (target < _tier) // better: only with margin
+        {
+            PowerTier withMargin = _tierFor(mv > _cfg.hysteresisMv ? mv - _cfg.hysteresisMv : 0);
+            target = mv < _cfg.absentMv ? PowerTier::Full : withMargin < _tier ? withMargin : _tier;
+        }
+        if (target == _tier)
+        {
+            _pending = false;
+            return false;
+        }
+        if (!_pending || target != _next)
+        {
+            _pending = true;
+            _next = target;
+            _sinceMs = nowMs;
+        }
+        if (nowMs - _sinceMs < _cfg.dwellMs)
+            return false;
+        _tier = target;
+        _pending = false;
+        _changes++;
+        return true;
+    }
+
+    PowerTier tier() const { return _tier; }
+    const TierProfile &profile() const { return profile(_tier); }
+    uint32_t changes() const { return _changes; }
+
+    static const TierProfile &profile(PowerTier t)
+    {
+        static const TierProfile P[] = {
+            // disp led  vol  melodies                notes radio adc
+            {100, 100, 100, MelodyPolicy::All,       0, 100,  40},   // Full
+            {60,  50,  80,  MelodyPolicy::Short,     6, 200,  100},  // Eco
+            {30,  20,  60,  MelodyPolicy::AlertOnly, 3, 500,  250},  // Low
+            {0,   0,   0,   MelodyPolicy::AlertOnly, 1, 1000, 1000}, // Critical: about to sleep
+        };
+        return P[(uint8_t)t];
+    }
+
+    static const char *name(PowerTier t)
+    {
+        static const char *const N[] = {"full", "eco", "low", "critical"};
+        return N[(uint8_t)t];
+    }
+
+private:
+    PowerTier _tierFor(uint16_t mv) const
+    {
+        if (mv < _cfg.absentMv)
+            return PowerTier::Full;
+        if (mv < _cfg.criticalMv)
+            return PowerTier::Critical;
+        if (mv < _cfg.lowMv)
+            return PowerTier::Low;
+        if (mv < _cfg.ecoMv)
+            return PowerTier::Eco;
+        return PowerTier::Full;
+    }
+
+    Config _cfg;
+    PowerTier _tier = PowerTier::Full;
+    PowerTier _next = PowerTier::Full;
+    bool _pending = false;
+    bool _started = false; // first reading seen
+    uint32_t _sinceMs = 0;
+    uint32_t _changes = 0;
+};
@@ -0,0 +1,88 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_pm.h>
+
+/*
+  PowerManager - DFS + automatic light sleep between events
+  ---------------------------------------------------------
+  - Configures esp_pm: CPU scales between maxMhz and minMhz, idle -> light sleep
+  - Holds PM locks only while outputs need a steady clock:
+      display multiplexing -> CPU max + no light sleep (refresh() busy-waits)
+      buzzer / LED PWM     -> APB max + no light sleep (LEDC runs from APB)
+  - Puts Wi-Fi into modem power save; ESP-NOW keeps receiving in the wake window
+  - The button GPIO wakes the chip from light sleep
+  - idle() blocks on a task notification, so wake() from another task (e.g. the
+    ESP-NOW receive callback) lets loop() handle new work at once
+  - deepSleep(): last resort for an empty cell (PowerGovernor's Critical tier)
+
+  Quick start:
+    PowerManager power;
+    power.init();                       // after WiFi.mode(), before esp_now_init()
+    power.wakeOnButton(PIN_BTN);
+    // in loop():
+    power.update(disp.isActive(), buzz.isPlaying() || leds.isActive());
+    if (!power.isBusy()) power.idle();  // lets FreeRTOS idle enter light sleep
+
+  If the SDK was built without CONFIG_PM_ENABLE, init() returns false and
+  everything else becomes a no-op (the device simply keeps running at full clock).
+*/
+
+class PowerManager
+{
+public:
+    // maxMhz/minMhz: DFS range, lightSleep: allow automatic light sleep when idle
+    bool init(uint16_t maxMhz = 240, uint16_t minMhz = 80, bool lightSleep = true);
+
+    // Wi-Fi modem sleep; wakeIntervalMs/wakeWindowMs define how often and how long
+    // the radio listens for ESP-NOW frames while nothing is going on
+    void enableRadioPowerSave(uint16_t wakeIntervalMs = 100, uint16_t wakeWindowMs = 50);
+
+    // Allow the (active-low) button to wake the chip from light sleep
+    // (not needed with Button, whose interrupt is the wake source)
+    void wakeOnButton(uint8_t pin);
+
+    // Acquire / release locks according to what the outputs are doing right now
+    void update(bool displayActive, bool pwmActive);
+
+    // Sleep-friendly wait for the main loop when nothing needs the CPU
+    void idle(uint32_t ms = 10);
+
+    // Deep sleep until the (active-low, RTC-capable) button is pressed; does not return.
+    // The chip reboots on wake.
+    void deepSleep(uint8_t wakePin);
+
+    // Any task: end the loop's current (or next) idle() early
+    void wake()
+    {
+        if (_loopTask)
+            xTaskNotifyGive(_loopTask);
+    }
+    // Same, from an interrupt handler
+    void IRAM_ATTR wakeFromISR()
+    {
+        if (!_loopTask)
+            return;
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_loopTask, &woken);
+        if (woken)
+            portYIELD_FROM_ISR();
+    }
+
+    bool isEnabled() const { return _enabled; }
+    bool isBusy() const { return _uiLocked || _pwmLocked; }
+
+private:
+    void _hold(esp_pm_lock_handle_t h, bool &held, bool want);
+
+    bool _enabled = false;
+    TaskHandle_t _loopTask = nullptr; // task that calls idle(), set by init()
+
+    esp_pm_lock_handle_t _lockCpu = nullptr;     // display: exact delayMicroseconds, fast loop
+    esp_pm_lock_handle_t _lockApb = nullptr;     // LEDC: stable PWM/tone frequency
+    esp_pm_lock_handle_t _lockAwakeUi = nullptr; // display: no light sleep while multiplexing
+    esp_pm_lock_handle_t _lockAwakePwm = nullptr;
+
+    bool _uiLocked = false;
+    bool _pwmLocked = false;
+    bool _cpuHeld = false, _apbHeld = false, _awakeUiHeld = false, _awakePwmHeld = false;
+};
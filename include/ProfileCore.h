@@ -0,0 +1,220 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  ProfileCore - loop() / section timing in cycles, fixed memory
+  -------------------------------------------------------------
+  - Log2Hist: one bucket per power of two (bucket b holds 2^b .. 2^(b+1)-1
+    cycles), 32 buckets cover the whole uint32_t range in 128 bytes.
+    Percentiles resolve to the upper edge of their bucket (within 2x), count,
+    mean and max are exact.
+  - ProfileCore: a histogram per named section (a driver update(), a callback,
+    ...) and one for whole loop() iterations. Per iteration it remembers which
+    section took longest; a slow iteration is tagged with that section, or
+    with "other" when more of it went to code outside any section (a delay(),
+    a Serial.printf, ...).
+  - Worst offenders: the WORST slowest samples (sections and iterations) with
+    their tag and time; samples over the budget are counted per section.
+  - Sections must not nest (their cycles are summed per iteration).
+  - Cost per sample: a clz, a counter increment and one compare unless the
+    sample is a new worst offender (then a WORST-entry scan).
+  - LoopProfiler feeds it CCOUNT deltas.
+
+  Quick start:
+    ProfileCore<16, 8> p;
+    uint8_t id = p.section("refresh");
+    p.beginLoop();
+    p.record(id, cycles, millis());
+    p.endLoop(loopCycles, millis());
+    p.hist(id).percentile(99);
+*/
+
+class Log2Hist
+{
+public:
+    static const uint8_t BUCKETS = 32;
+
+    static uint8_t bucketOf(uint32_t v) { return v ? (uint8_t)(31 - __builtin_clz(v)) : 0; }
+
+    void add(uint32_t v)
+    {
+        _b[bucketOf(v)]++;
+        if (v > _max)
+            _max = v;
+        _sum += v;
+        _n++;
+    }
+
+    void clear()
+    {
+        for (uint8_t i = 0; i < BUCKETS; i++)
+            _b[i] = 0;
+        _n = _max = 0;
+        _sum = 0;
+    }
+
+    uint32_t count() const { return _n; }
+    uint32_t max() const { return _max; }
+    uint32_t mean() const { return _n ? (uint32_t)(_sum / _n) : 0; }
+    uint64_t sum() const { return _sum; }
+    uint32_t bucket(uint8_t b) const { return b < BUCKETS ? _b[b] : 0; }
+
+    // Nearest-rank percentile (pct 0..100), upper edge of its bucket (never above max)
+    uint32_t percentile(uint8_t pct) const
+    {
+        if (!_n)
+            return 0;
+        uint32_t rank = ((uint32_t)pct * _n + 99) / 100;
+        if (!rank)
+            rank = 1;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKETS; i++)
+        {
+            seen += _b[i];
+            if (seen >= rank)
+            {
+                const uint32_t edge = i >= 31 ? 0xFFFFFFFFu : (2u << i) - 1;
+                return edge < _max ? edge : _max;
+            }
+        }
+        return _max;
+    }
+
+private:
+    uint32_t _b[BUCKETS] = {0};
+    uint32_t _n = 0;
+    uint32_t _max = 0;
+    uint64_t _sum = 0;
+};
+
+template <uint8_t SECTIONS, uint8_t WORST>
+class ProfileCore
+{
+public:
+    static const uint8_t LOOP = 0xFE;  // section of a whole-iteration sample
+    static const uint8_t OTHER = 0xFF; // tag: time outside every section
+    static const uint8_t FULL = 0xFF;  // section(): no slot left
+
+    struct Offender
+    {
+        uint32_t cycles = 0;
+        uint8_t section = FULL; // LOOP or a section id
+        uint8_t tag = OTHER;    // section that dominated (LOOP samples), else the section itself
+        uint32_t atMs = 0;
+    };
+
+    // Registers a section (name must outlive the profiler); same name -> same id
+    uint8_t section(const char *name)
+    {
+        for (uint8_t i = 0; i < _n; i++)
+            if (_s[i].name == name)
+                return i;
+        if (_n >= SECTIONS)
+            return FULL;
+        _s[_n].name = name;
+        return _n++;
+    }
+
+    void setBudget(uint32_t cycles) { _budget = cycles; }
+    uint32_t budget() const { return _budget; }
+
+    void beginLoop()
+    {
+        _iterSum = 0;
+        _iterTop = 0;
+        _iterTag = OTHER;
+    }
+
+    void record(uint8_t id, uint32_t cycles, uint32_t atMs)
+    {
+        if (id >= _n)
+            return;
+        Sec &s = _s[id];
+        s.hist.add(cycles);
+        if (cycles > _budget)
+            s.over++;
+        _iterSum += cycles;
+        if (cycles > _iterTop)
+        {
+            _iterTop = cycles;
+            _iterTag = id;
+        }
+        _offend(cycles, id, id, atMs);
+    }
+
+    void endLoop(uint32_t cycles, uint32_t atMs)
+    {
+        _loop.add(cycles);
+        const uint32_t other = cycles > _iterSum ? cycles - _iterSum : 0;
+        _other.add(other);
+        if (cycles > _budget)
+            _loopOver++;
+        _offend(cycles, LOOP, other > _iterTop ? OTHER : _iterTag, atMs);
+    }
+
+    void clear()
+    {
+        for (uint8_t i = 0; i < _n; i++)
+        {
+            _s[i].hist.clear();
+            _s[i].over = 0;
+        }
+        _loop.clear();
+        _other.clear();
+        _loopOver = 0;
+        for (uint8_t i = 0; i < WORST; i++)
+            _worst[i] = Offender();
+        _floor = 0;
+    }
+
+    uint8_t sections() const { return _n; }
+    const char *name(uint8_t id) const
+    {
+        return id < _n ? _s[id].name : id == LOOP ? "loop" : "other";
+    }
+    const Log2Hist &hist(uint8_t id) const { return _s[id].hist; }
+    uint32_t overBudget(uint8_t id) const { return _s[id].over; }
+    const Log2Hist &loop() const { return _loop; }
+    const Log2Hist &other() const { return _other; } // per iteration: loop - sections
+    uint32_t loopOverBudget() const { return _loopOver; }
+
+    // Slowest first; entries with cycles == 0 are unused
+    const Offender &worst(uint8_t i) const { return _worst[i]; }
+    static uint8_t worstSlots() { return WORST; }
+
+private:
+    struct Sec
+    {
+        const char *name = nullptr;
+        Log2Hist hist;
+        uint32_t over = 0;
+    };
+
+    void _offend(uint32_t cycles, uint8_t section, uint8_t tag, uint32_t atMs)
+    {
+        if (cycles <= _floor)
+            return;
+        uint8_t i = WORST - 1; // drop the smallest, bubble the new one up
+        while (i > 0 && _worst[i - 1].cycles < cycles)
+        {
+            _worst[i] = _worst[i - 1];
+            i--;
+        }
+        _worst[i].cycles = cycles;
+        _worst[i].section = section;
+        _worst[i].tag = tag;
+        _worst[i].atMs = atMs;
+        _floor = _worst[WORST - 1].cycles;
+    }
+
+    Sec _s[SECTIONS];
+    uint8_t _n = 0;
+    Log2Hist _loop, _other;
+    uint32_t _loopOver = 0;
+    uint32_t _budget = 0xFFFFFFFFu;
+    uint32_t _iterSum = 0, _iterTop = 0;
+    uint8_t _iterTag = OTHER;
+    Offender _worst[WORST];
+    uint32_t _floor = 0; // smallest worst-offender entry: the fast path skips everything below
+};
@@ -0,0 +1,277 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+/*
+  Protocol - the single wire format of every ESP-NOW frame
+  --------------------------------------------------------
+  Frame = Header (7 bytes) + typed body, little-endian, packed:
+    tag    0xB0 | PROTO_VERSION (high nibble marks our frames, low nibble = version)
+    type   MsgCmd
+    flags  MSG_FLAG_*
+    seq    sender sequence number (CMD_ACK: the acknowledged seq)
+    len    body length in bytes
+    crc    CRC-8 (poly 0x07) over the five header bytes before it and the body
+  - parse() checks the frame in place on the callback buffer, cheapest test first:
+    length, tag/version, known type, body size, and only then the CRC. Foreign
+    and unknown frames are rejected after a few compares.
+  - Later versions may append fields to a body: a longer body is accepted, a
+    shorter one is rejected
+  - Frame::body<T>() returns a pointer into the buffer (packed, alignment 1),
+    or nullptr if the frame's type does not carry a T
+  - Shared by the firmware, test/test.cpp and host tests
+
+  Quick start:
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_START, 0, seq, SignalBody{1000});
+    esp_now_send(peer, buf, n);
+    // receive callback:
+    Proto::Frame f;
+    if (Proto::parse(data, len, f) != Proto::Status::Ok) return;
+    if (const SignalBody *s = f.body<SignalBody>()) lease.extend(s->leaseMs);
+*/
+
+enum MsgCmd : uint8_t
+{
+    CMD_START = 1,       // hold signal START (SignalBody)
+    CMD_HEARTBEAT = 2,   // hold signal keepalive (SignalBody)
+    CMD_STOP = 3,        // hold signal released (no body)
+    CMD_CHANNEL = 4,     // channel migration proposal (ChannelBody)
+    CMD_PROBE = 5,       // link probe, only the MAC-level ack matters (no body)
+    CMD_PAIR_BEACON = 6, // broadcast discovery beacon (PairBody)
+    CMD_PAIR_ACCEPT = 7, // unicast answer to a beacon (PairBody)
+    CMD_GROUP = 8,       // group broadcast (GroupBody, see GroupLink.h)
+    CMD_GROUP_ACK = 9,   // per-member ACK of a group broadcast (GroupAckBody)
+    CMD_ACK = 10,        // ReliableLink ACK, seq = acknowledged seq (no body)
+    CMD_PING = 11,       // telemetry probe (PingBody), answered at once with a PONG
+    CMD_PONG = 12,       // echo of a PING: same seq and timestamp, responder's RSSI (PingBody)
+    CMD_BENCH = 13,      // latency benchmark: clock sync and receiver timestamps (BenchBody)
+    CMD_SCENE = 14       // play / end a scene from the receiver's table (SceneBody)
+};
+
+enum MsgFlags : uint8_t
+{
+    MSG_FLAG_NOACK = 1 << 0,   // single frame, do not acknowledge or de-duplicate
+    MSG_FLAG_ACK_REQ = 1 << 1, // group members should acknowledge
+    MSG_FLAG_RELAYED = 1 << 2  // group frame rebroadcast by a relay, not by the origin
+};
+
+// ---- Typed bodies ----
+
+struct __attribute__((packed)) SignalBody
+{
+    uint16_t leaseMs; // how long the signal stays on without a further frame
+    static bool carriedBy(uint8_t t) { return t == CMD_START || t == CMD_HEARTBEAT; }
+};
+
+struct __attribute__((packed)) ChannelBody
+{
+    uint8_t channel;
+    static bool carriedBy(uint8_t t) { return t == CMD_CHANNEL; }
+};
+
+struct __attribute__((packed)) PairBody
+{
+    uint8_t caps; // PeerCaps of the sender
+    static bool carriedBy(uint8_t t) { return t == CMD_PAIR_BEACON || t == CMD_PAIR_ACCEPT; }
+};
+
+struct __attribute__((packed)) GroupBody
+{
+    uint8_t group;    // group id (0 = group mode off)
+    uint32_t origin;  // sender id (low 4 bytes of its MAC)
+    uint8_t ttl;      // hops left, each relay decrements (1 = do not relay)
+    uint8_t inner;    // MsgCmd carried (START / HEARTBEAT / STOP)
+    uint16_t leaseMs; // lease for START / HEARTBEAT
+    static bool carriedBy(uint8_t t) { return t == CMD_GROUP; }
+};
+
+struct __attribute__((packed)) GroupAckBody
+{
+    uint8_t group;
+    uint32_t member; // id of the acknowledging member
+    static bool carriedBy(uint8_t t) { return t == CMD_GROUP_ACK; }
+};
+
+struct __attribute__((packed)) PingBody
+{
+    uint32_t sentUs; // sender's clock when the PING was queued, echoed unchanged
+    int8_t rssi;     // PONG: RSSI (dBm) at which the responder heard the PING
+    static bool carriedBy(uint8_t t) { return t == CMD_PING || t == CMD_PONG; }
+};
+
+enum BenchOp : uint8_t
+{
+    BENCH_SYNC = 1,     // us[0] = sender's send time
+    BENCH_SYNC_ACK = 2, // us[0] echoed, us[1] = receive time, us[2] = send time (receiver clock)
+    BENCH_REPORT = 3    // id = START seq, us[0] = receive callback, us[1] = first buzzer tone (receiver clock)
+};
+
+struct __attribute__((packed)) BenchBody
+{
+    uint8_t op;      // BenchOp
+    uint16_t id;
+    uint32_t us[3];  // timestamps, micros()
+    static bool carriedBy(uint8_t t) { return t == CMD_BENCH; }
+};
+
+// What a CMD_SCENE changes in the receiver's table entry (none: played as stored)
+enum SceneArgs : uint8_t
+{
+    SCENE_ARG_DURATION = 1 << 0, // durationMs replaces the scene's (0 = held until SCENE_ARG_STOP)
+    SCENE_ARG_REPEAT = 1 << 1,   // the melody loops until the scene ends
+    SCENE_ARG_TEXT = 1 << 2,     // text replaces the scene's two characters
+    SCENE_ARG_STOP = 1 << 3      // end the scene instead (releases a held one)
+};
+
+// The scene is an index into a table both units carry: the frame holds no
+// colours, notes or timings, and dispatch is one lookup
+struct __attribute__((packed)) SceneBody
+{
+    uint8_t scene; // receiver's scene ID (1..)
+    uint8_t args;  // SceneArgs
+    uint16_t durationMs;
+    char text[2]; // not NUL-terminated
+    static bool carriedBy(uint8_t t) { return t == CMD_SCENE; }
+};
+
+namespace Proto
+{
+    static const uint8_t VERSION = 1;
+    static const uint8_t TAG = 0xB0 | VERSION;
+    static const uint8_t MAX_BODY = 16;
+
+    struct __attribute__((packed)) Header
+    {
+        uint8_t tag;
+        uint8_t type;
+        uint8_t flags;
+        uint16_t seq;
+        uint8_t len;
+        uint8_t crc;
+    };
+
+    static const size_t MAX_FRAME = sizeof(Header) + MAX_BODY;
+
+    enum class Status : uint8_t
+    {
+        Ok,
+        Short,     // shorter than a header, or than header + len
+        Foreign,   // not our tag (other ESP-NOW traffic, pre-protocol firmware)
+        Version,   // our tag, other protocol version
+        Unknown,   // type this firmware does not know: skip
+        Truncated, // body shorter than its type requires
+        Crc
+    };
+
+    // Smallest body a type may carry; -1 for unknown types
+    inline int minBody(uint8_t type)
+    {
+        switch (type)
+        {
+        case CMD_START:
+        case CMD_HEARTBEAT:
+            return sizeof(SignalBody);
+        case CMD_CHANNEL:
+            return sizeof(ChannelBody);
+        case CMD_PAIR_BEACON:
+        case CMD_PAIR_ACCEPT:
+            return sizeof(PairBody);
+        case CMD_GROUP:
+            return sizeof(GroupBody);
+        case CMD_GROUP_ACK:
+            return sizeof(GroupAckBody);
+        case CMD_PING:
+        case CMD_PONG:
+            return sizeof(PingBody);
+        case CMD_BENCH:
+            return sizeof(BenchBody);
+        case CMD_SCENE:
+            return sizeof(SceneBody);
+        case CMD_STOP:
+        case CMD_PROBE:
+        case CMD_ACK:
+            return 0;
+        default:
+            return -1;
+        }
+    }
+
+    // CRC-8, poly 0x07, init 0 (CRC-8/SMBUS), nibble table: 16 bytes of flash
+    inline uint8_t crc8(const uint8_t *p, size_t n, uint8_t crc = 0)
+    {
+        static const uint8_t T[16] = {0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+                                      0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D};
+        while (n--)
+        {
+            crc ^= *p++;
+            crc = (uint8_t)(crc << 4) ^ T[crc >> 4];
+            crc = (uint8_t)(crc << 4) ^ T[crc >> 4];
+        }
+        return crc;
+    }
+
+    // A validated frame; points into the receive buffer, valid for the callback only
+    struct Frame
+    {
+        const Header *hdr = nullptr;
+        const uint8_t *data = nullptr; // body
+        uint8_t len = 0;               // body length
+
+        uint8_t type() const { return hdr->type; }
+        uint8_t flags() const { return hdr->flags; }
+        uint16_t seq() const { return hdr->seq; }
+
+        template <typename T>
+        const T *body() const
+        {
+            return (T::carriedBy(hdr->type) && len >= sizeof(T)) ? reinterpret_cast<const T *>(data) : nullptr;
+        }
+    };
+
+    inline Status parse(const uint8_t *buf, int n, Frame &out)
+    {
+        if (n < (int)sizeof(Header))
+            return Status::Short;
+        const Header *h = reinterpret_cast<const Header *>(buf);
+        if ((h->tag & 0xF0) != (TAG & 0xF0))
+            return Status::Foreign;
+        if (h->tag != TAG)
+            return Status::Version;
+        if (n < (int)sizeof(Header) + h->len)
+            return Status::Short;
+        int need = minBody(h->type);
+        if (need < 0)
+            return Status::Unknown;
+        if (h->len < need)
+            return Status::Truncated;
+        const uint8_t *body = buf + sizeof(Header);
+        if (crc8(body, h->len, crc8(buf, offsetof(Header, crc))) != h->crc)
+            return Status::Crc;
+        out.hdr = h;
+        out.data = body;
+        out.len = h->len;
+        return Status::Ok;
+    }
+
+    // Writes header + body into buf (MAX_FRAME bytes); returns the frame size, 0 if the body is too big
+    inline size_t encode(uint8_t *buf, uint8_t type, uint8_t flags, uint16_t seq,
+                         const void *body = nullptr, uint8_t len = 0)
+    {
+        if (len > MAX_BODY)
+            return 0;
+        Header h{TAG, type, flags, seq, len, 0};
+        memcpy(buf, &h, sizeof(h));
+        if (len)
+            memcpy(buf + sizeof(Header), body, len);
+        buf[offsetof(Header, crc)] = crc8(buf + sizeof(Header), len, crc8(buf, offsetof(Header, crc)));
+        return sizeof(Header) + len;
+    }
+
+    template <typename T>
+    inline size_t encode(uint8_t *buf, uint8_t type, uint8_t flags, uint16_t seq, const T &body)
+    {
+        return encode(buf, type, flags, seq, &body, sizeof(T));
+    }
+}
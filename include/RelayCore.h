@@ -0,0 +1,192 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "SeenCache.h"
+
+/*
+  RelayCore - flood relay decisions (TTL, seen-cache, jittered rebroadcast)
+  -------------------------------------------------------------------------
+  - onFrame(): every received copy goes through the (origin, seq) seen-cache;
+    the first copy is delivered locally and, if relaying is enabled and
+    ttl > 1, queued for rebroadcast with ttl - 1 after a random 0..jitter delay
+  - Copies of a queued frame heard from other relays are counted; once
+    suppressAfter copies were heard the own rebroadcast is cancelled
+    (0 = never suppress)
+  - Passive ACK: after a rebroadcast the relay listens for a copy with a lower
+    ttl (somebody further out forwarded it); without one within echoTimeout it
+    rebroadcasts again, at most `retries` more times
+  - poll() hands out rebroadcasts that are due
+  - Time is in caller units (ms on the device, us in the host simulator);
+    no allocation, not thread-safe by itself
+
+  Quick start:
+    RelayCore<GroupMsg> relay;
+    relay.setEnabled(true);
+    if (relay.onFrame(g.body.origin, g.seq, g.body.ttl, g, now, esp_random())) deliver(g);
+    RelayCore<GroupMsg>::Out o;
+    while (relay.poll(now, o)) { o.frame.body.ttl = o.ttl; broadcast(o.frame); }
+*/
+
+template <typename Frame, size_t SEEN = 32, size_t PENDING = 4>
+class RelayCore
+{
+public:
+    struct Out
+    {
+        uint32_t origin;
+        uint16_t seq;
+        uint8_t ttl; // ttl to put on air (already decremented)
+        Frame frame;
+    };
+
+    struct Stats
+    {
+        uint32_t delivered = 0;  // first copies
+        uint32_t duplicates = 0; // dropped by the seen-cache
+        uint32_t queued = 0;     // rebroadcasts scheduled
+        uint32_t relayed = 0;    // rebroadcasts handed out by poll()
+        uint32_t suppressed = 0; // cancelled because enough copies were heard
+        uint32_t retried = 0;    // rebroadcasts repeated for lack of an echo
+        uint32_t echoed = 0;     // rebroadcasts confirmed by a downstream copy
+        uint32_t overflow = 0;   // no free pending slot
+    };
+
+    void setEnabled(bool on) { _enabled = on; }
+    bool isEnabled() const { return _enabled; }
+    void setJitter(uint32_t maxDelay) { _jitter = maxDelay; }
+    void setSuppressAfter(uint8_t copies) { _suppressAfter = copies; }
+    void setRetries(uint8_t retries, uint32_t echoTimeout)
+    {
+        _retries = retries;
+        _echoTimeout = echoTimeout;
+    }
+
+    // Returns true if this is the first copy (deliver it locally)
+    bool onFrame(uint32_t origin, uint16_t seq, uint8_t ttl, const Frame &f, uint32_t now, uint32_t rnd)
+    {
+        if (!_seen.check(origin, seq))
+        {
+            _stats.duplicates++;
+            for (size_t i = 0; i < PENDING; i++)
+            {
+                Slot &s = _p[i];
+                if (!s.used || s.out.origin != origin || s.out.seq != seq)
+                    continue;
+                if (s.tries)
+                {
+                    // waiting for the echo: a copy from further out confirms our rebroadcast
+                    if (ttl < s.out.ttl)
+                    {
+                        s.used = false;
+                        _stats.echoed++;
+                    }
+                }
+                else
+                {
+                    s.heard++;
+                    if (_suppressAfter && s.heard >= _suppressAfter)
+                    {
+                        s.used = false;
+                        _stats.suppressed++;
+                    }
+                }
+            }
+            return false;
+        }
+
+        _stats.delivered++;
+        if (!_enabled || ttl <= 1)
+            return true;
+
+        for (size_t i = 0; i < PENDING; i++)
+        {
+            Slot &s = _p[i];
+            if (s.used)
+                continue;
+            s.used = true;
+            s.heard = 0;
+            s.tries = 0;
+            s.due = now + (_jitter ? rnd % (_jitter + 1) : 0);
+            s.out = Out{origin, seq, (uint8_t)(ttl - 1), f};
+            _stats.queued++;
+            return true;
+        }
+        _stats.overflow++;
+        return true;
+    }
+
+    // Remember an own transmission so echoes from relays are not delivered / relayed
+    void markSeen(uint32_t origin, uint16_t seq) { _seen.check(origin, seq); }
+
+    bool poll(uint32_t now, Out &out)
+    {
+        for (size_t i = 0; i < PENDING; i++)
+        {
+            Slot &s = _p[i];
+            if (s.used && (int32_t)(now - s.due) >= 0)
+            {
+                out = s.out;
+                if (s.tries)
+                    _stats.retried++;
+                else
+                    _stats.relayed++;
+                // nobody can forward a ttl 1 copy, so there is no echo to wait for
+                if (s.tries < _retries && s.out.ttl > 1)
+                {
+                    s.tries++;
+                    s.due = now + _echoTimeout;
+                }
+                else
+                {
+                    s.used = false;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool hasPending() const
+    {
+        for (size_t i = 0; i < PENDING; i++)
+            if (_p[i].used)
+                return true;
+        return false;
+    }
+
+    // Earliest due time of a queued rebroadcast (false if none)
+    bool nextDue(uint32_t now, uint32_t &due) const
+    {
+        bool any = false;
+        for (size_t i = 0; i < PENDING; i++)
+            if (_p[i].used && (!any || (int32_t)(_p[i].due - due) < 0))
+            {
+                due = _p[i].due;
+                any = true;
+            }
+        if (any && (int32_t)(due - now) < 0)
+            due = now;
+        return any;
+    }
+
+    const Stats &stats() const { return _stats; }
+
+private:
+    struct Slot
+    {
+        Out out;
+        uint32_t due;
+        uint8_t heard; // copies heard before our rebroadcast
+        uint8_t tries; // rebroadcasts done, waiting for an echo
+        bool used;
+    };
+
+    SeenCache<SEEN> _seen;
+    Slot _p[PENDING] = {};
+    bool _enabled = false;
+    uint32_t _jitter = 8;
+    uint8_t _suppressAfter = 0;
+    uint8_t _retries = 0;
+    uint32_t _echoTimeout = 0;
+    Stats _stats;
+};
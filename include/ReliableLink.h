@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+#include "Protocol.h"
+#include "TxQueue.h"
+
+/*
+  ReliableLink - acknowledged, sequenced ESP-NOW delivery
+  -------------------------------------------------------
+  - Every data message carries a 16-bit sequence number (Protocol.h header)
+  - The receiver answers with an application-level CMD_ACK echoing that seq
+  - The sender retransmits with exponential backoff only until the ACK arrives
+    (rtoMs, 2*rtoMs, 4*rtoMs ... capped at rtoMaxMs, at most maxAttempts frames)
+  - Duplicates (same seq as the last delivered one) are re-ACKed but not delivered
+  - One message in flight; a new send() supersedes an unacknowledged one
+  - sendOnce() puts a single frame on air flagged MSG_FLAG_NOACK (keepalives):
+    it is neither acknowledged nor de-duplicated and never touches the in-flight one
+
+  Quick start:
+    ReliableLink radio;
+    radio.init(tx, PEER_MAC);               // frames go out through the TxQueue
+    radio.send(CMD_START, SignalBody{1000}); // non-blocking
+    // in loop(), for each RxRing frame, after Proto::parse():
+    if (radio.onRecv(mac, frame, atUs)) { ...handle frame... }
+    // in loop():
+    radio.update();                         // drives retransmits, records latency
+*/
+
+class ReliableLink
+{
+public:
+    enum class Result : uint8_t
+    {
+        Pending,
+        Acked,
+        Failed // no ACK after maxAttempts, or superseded by a newer send()
+    };
+
+    struct Stats
+    {
+        uint32_t sent = 0;        // messages handed to send()
+        uint32_t acked = 0;       // messages confirmed by the peer
+        uint32_t failed = 0;      // gave up after maxAttempts
+        uint32_t superseded = 0;  // replaced by a newer send() before the ACK
+        uint32_t frames = 0;      // data frames put on air (incl. retransmits)
+        uint32_t duplicates = 0;  // received duplicates dropped
+        uint32_t lastLatencyUs = 0;
+        uint32_t minLatencyUs = UINT32_MAX;
+        uint32_t maxLatencyUs = 0;
+        uint64_t sumLatencyUs = 0; // avg = sumLatencyUs / acked
+        uint8_t lastAttempts = 0;
+    };
+
+    // rtoMs: first retransmit timeout, doubled per attempt up to rtoMaxMs
+    void init(TxQueue &tx, const uint8_t peerMac[6], uint16_t rtoMs = 15, uint16_t rtoMaxMs = 400, uint8_t maxAttempts = 6);
+
+    // Queue a message for reliable delivery (returns false if the first frame could not be queued)
+    bool send(uint8_t cmd, const void *body = nullptr, uint8_t len = 0);
+    template <typename T>
+    bool send(uint8_t cmd, const T &body) { return send(cmd, &body, sizeof(T)); }
+
+    // Fire-and-forget single frame (no ACK, no retransmit)
+    bool sendOnce(uint8_t cmd, const void *body = nullptr, uint8_t len = 0);
+    template <typename T>
+    bool sendOnce(uint8_t cmd, const T &body) { return sendOnce(cmd, &body, sizeof(T)); }
+
+    // Call often in loop(): retransmits and completes acknowledged messages
+    void update();
+
+    // Call from loop() with a parsed frame (RxRing). Handles ACKs and
+    // sends ACKs for data. Returns true if `f` is a new (non-duplicate) data message.
+    // atUs: when the frame arrived (RxMsg::atUs); an ACK's latency ends there
+    bool onRecv(const uint8_t *srcMac, const Proto::Frame &f, uint32_t atUs);
+
+    // Status
+    bool isBusy() const { return _inFlight; }
+    Result result() const { return _result; } // outcome of the most recent send()
+    const Stats &stats() const { return _stats; }
+    void printStats(Print &out) const;
+
+private:
+    bool _transmit();
+    void _finish(bool acked, uint32_t nowUs);
+
+    TxQueue *_tx = nullptr;
+    uint8_t _peer[6] = {0};
+    uint16_t _rtoMs = 15;
+    uint16_t _rtoMaxMs = 400;
+    uint8_t _maxAttempts = 6;
+
+    // Sender state (owned by loop task)
+    uint16_t _nextSeq = 0;
+    uint8_t _frame[Proto::MAX_FRAME] = {0}; // encoded in-flight message
+    uint8_t _frameLen = 0;
+    uint16_t _seq = 0; // its seq
+    bool _inFlight = false;
+    Result _result = Result::Failed;
+    uint8_t _attempts = 0;
+    uint16_t _curRtoMs = 0;
+    uint32_t _firstTxUs = 0;
+    uint32_t _nextTxMs = 0;
+
+    // Written by onRecv(), read by update()
+    bool _ackSeen = false;
+    uint16_t _ackSeq = 0;
+    uint32_t _ackAtUs = 0;
+
+    // Receiver duplicate filter
+    bool _haveRxSeq = false;
+    uint16_t _lastRxSeq = 0;
+
+    Stats _stats;
+};
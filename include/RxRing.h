@@ -0,0 +1,122 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Protocol.h"
+
+/*
+  RxRing - lock-free single-producer / single-consumer receive queue
+  ------------------------------------------------------------------
+  - The ESP-NOW receive callback (Wi-Fi task) validates a frame with
+    Proto::parse() and push()es a copy with source MAC, RSSI and arrival time;
+    loop() drains it, so a burst of frames is handled one by one instead of
+    overwriting a single flag
+  - Fixed N slots (power of two), no allocation, no locks: head is written only
+    by the producer, tail only by the consumer, with release/acquire ordering
+    so a slot is complete before the consumer can see it (dual-core safe)
+  - A full ring drops the new frame and counts it in stats().overflow
+  - Consumer side is zero-copy: front() points at the slot, pop() frees it
+
+  Quick start:
+    RxRing<16> rx;
+    // receive callback:
+    if (Proto::parse(data, len, f) == Proto::Status::Ok) rx.push(mac, data, len, rssi, micros());
+    // loop():
+    while (const RxMsg *m = rx.front()) { handle(m->mac, m->frame()); rx.pop(); }
+*/
+
+struct RxMsg
+{
+    uint32_t atUs;  // micros() when the callback ran
+    uint8_t mac[6]; // source
+    int8_t rssi;    // dBm, 0 = unknown
+    uint8_t len;
+    uint8_t data[Proto::MAX_FRAME]; // frame that passed Proto::parse()
+
+    // View of the stored frame (already validated on push)
+    Proto::Frame frame() const
+    {
+        Proto::Frame f;
+        f.hdr = reinterpret_cast<const Proto::Header *>(data);
+        f.data = data + sizeof(Proto::Header);
+        f.len = f.hdr->len;
+        return f;
+    }
+};
+
+template <size_t N>
+class RxRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "RxRing size must be a power of two");
+
+public:
+    struct Stats
+    {
+        uint32_t pushed = 0;
+        uint32_t overflow = 0;  // frames dropped because the ring was full
+        uint32_t oversize = 0;  // frames longer than a slot (bigger future body)
+        uint32_t highWater = 0; // deepest backlog seen by the producer
+    };
+
+    // Producer (receive callback). Returns false if the ring is full or the frame too long.
+    bool push(const uint8_t *mac, const uint8_t *data, int len, int8_t rssi, uint32_t atUs)
+    {
+        uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+        uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+        if (len < 0 || len > (int)Proto::MAX_FRAME)
+        {
+            _count(_stats.oversize);
+            return false;
+        }
+        if (head - tail >= N)
+        {
+            _count(_stats.overflow);
+            return false;
+        }
+        RxMsg &m = _slots[head & (N - 1)];
+        m.atUs = atUs;
+        memcpy(m.mac, mac, 6);
+        m.rssi = rssi;
+        m.len = (uint8_t)len;
+        memcpy(m.data, data, len);
+        __atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+
+        _count(_stats.pushed);
+        if (head + 1 - tail > _stats.highWater)
+            __atomic_store_n(&_stats.highWater, head + 1 - tail, __ATOMIC_RELAXED);
+        return true;
+    }
+
+    // Consumer (loop). Oldest message, or nullptr if empty; stays valid until pop().
+    const RxMsg *front() const
+    {
+        uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&_head, __ATOMIC_ACQUIRE) == tail)
+            return nullptr;
+        return &_slots[tail & (N - 1)];
+    }
+
+    void pop()
+    {
+        uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+        if (__atomic_load_n(&_head, __ATOMIC_ACQUIRE) != tail)
+            __atomic_store_n(&_tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    size_t size() const
+    {
+        return __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+    }
+    static constexpr size_t capacity() { return N; }
+
+    // Counters are written by the producer only (single 32-bit stores), safe to read anywhere
+    const Stats &stats() const { return _stats; }
+
+private:
+    static void _count(uint32_t &c) { __atomic_store_n(&c, c + 1, __ATOMIC_RELAXED); }
+
+    RxMsg _slots[N];
+    uint32_t _head = 0; // next slot to fill (producer)
+    uint32_t _tail = 0; // next slot to drain (consumer)
+    Stats _stats;
+};
@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+#include "SevenSegmentDisplay.h"
+#include "TriLeds.h"
+#include "Buzzer.h"
+
+/*
+  ScenePlayer - one call starts a whole reaction on display, LEDs and buzzer
+  --------------------------------------------------------------------------
+  - A scene is a const descriptor (SceneDesc, in flash): LED animation,
+    melody, two characters of text (steady or blinking), duration and
+    priority, plus the outputs it owns. The table is indexed by scene ID:
+    play(id) is a lookup and a handful of driver calls, nothing parsed,
+    copied or allocated (melodies play in place).
+  - Every output of a scene counts from the same tick (restartAt() on each
+    driver), so LED steps, notes and blinking stay in phase
+  - Teardown: a timed scene ends by itself (update()); a held one
+    (durationMs 0) runs until stop(id). Only the outputs the scene owns
+    are reset (LEDs off, buzzer silent, display blank), the others are
+    left to whoever uses them.
+  - Priority: a scene replaces a running one of the same or lower priority,
+    a lower one is refused. A held scene interrupted by a higher-priority
+    timed one (remote signal under an alert) resumes when that one ends.
+  - TRACE(Scene, id, 1 / 0) at start / end
+  - Cosmetic sounds (SCENE_COSMETIC) are skipped when setCosmeticSound(false)
+    (battery tiers); loop() task only (no locking)
+  - SceneParams change one play() of a table scene (duration, repeat, text):
+    remote requests (CMD_SCENE) pick a scene by ID and adjust it this way
+
+  Quick start:
+    static const SceneDesc SCENES[] = {
+        {},                                                             // 0 = none
+        {SCENE_LEDS | SCENE_SOUND | SCENE_TEXT | SCENE_REPEAT, 1, 0,   // 1: held remote signal
+         "HI", 300, TriLeds::Anim::ChaseGYR, 150, BuiltInMelody::BEEP_BEEP},
+        {SCENE_TEXT, 2, 1500, "--", 0, TriLeds::Anim::Off, 0, BuiltInMelody::BEEP_BEEP}, // 2: timed, text only
+    };
+    scenes.begin(SCENES, 3, disp, leds, buzz);
+    scenes.play(1, millis());     // lease started
+    scenes.stop(1, millis());     // lease ended
+    scenes.update(millis());      // loop(): timed teardown
+    SceneParams p;
+    p.text = "AB";
+    scenes.play(2, millis(), p);  // scene 2 showing "AB"
+*/
+
+enum SceneFlags : uint8_t
+{
+    // the outputs a scene owns ...
+    SCENE_LEDS = 1 << 0,
+    SCENE_SOUND = 1 << 1,
+    SCENE_TEXT = 1 << 2,
+    SCENE_OUTPUTS = SCENE_LEDS | SCENE_SOUND | SCENE_TEXT,
+    // ... and how it plays them
+    SCENE_REPEAT = 1 << 3,  // melody loops until the scene ends
+    SCENE_COSMETIC = 1 << 4, // sound skipped when cosmetic sounds are off
+    SCENE_REMOTE = 1 << 5    // the peer may request it (CMD_SCENE); not used by the player
+};
+
+struct SceneDesc
+{
+    uint8_t flags;       // SceneFlags
+    uint8_t priority;    // higher wins
+    uint16_t durationMs; // 0 = held until stop()
+    char text[3];        // two characters
+    uint16_t blinkMs;    // full on+off period, 0 = steady
+    TriLeds::Anim leds;
+    uint16_t ledPeriodMs;
+    BuiltInMelody melody;
+};
+
+// Changes to one play() of a table scene
+struct SceneParams
+{
+    int32_t durationMs = -1;    // >= 0 replaces the scene's (0 = held until stop())
+    bool repeat = false;        // melody loops even if the scene's does not
+    const char *text = nullptr; // two characters replacing the scene's (NUL-terminated or not)
+};
+
+class ScenePlayer
+{
+public:
+    // table[0] is "no scene"; the table must outlive the player
+    void begin(const SceneDesc *table, uint8_t count, SevenSegmentText &disp, TriLeds &leds, Buzzer &buzz);
+
+    bool play(uint8_t id, uint32_t now) { return play(id, now, SceneParams()); }
+    bool play(uint8_t id, uint32_t now, const SceneParams &p); // false: unknown ID or a higher-priority scene is running
+    void stop(uint8_t id, uint32_t now); // ends it if running (or forgets it if waiting to resume)
+    void update(uint32_t now);           // call in loop(): ends timed scenes
+
+    uint8_t current() const { return _id; } // 0 = none
+    bool isActive() const { return _id != 0; }
+    void setCosmeticSound(bool on) { _cosmetic = on; }
+
+private:
+    void _start(uint8_t id, const SceneDesc &s, uint32_t now);
+    void _end(uint8_t keepOutputs); // resets the outputs of the running scene not in keepOutputs
+    void _finish(uint32_t now);     // running scene over: blank its outputs, resume the held one
+
+    const SceneDesc *_table = nullptr;
+    uint8_t _count = 0;
+    SevenSegmentText *_disp = nullptr;
+    TriLeds *_leds = nullptr;
+    Buzzer *_buzz = nullptr;
+
+    uint8_t _id = 0;     // running scene
+    SceneDesc _cur = {}; // ... as played (params applied)
+    uint32_t _startMs = 0;
+    uint8_t _held = 0;   // held scene interrupted by the running one, resumed after it
+    SceneDesc _heldDesc = {};
+    bool _cosmetic = true;
+};
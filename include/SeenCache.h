@@ -0,0 +1,75 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  SeenCache - tiny LRU of (origin, seq) pairs for duplicate suppression
+  ---------------------------------------------------------------------
+  - Fixed memory (N entries), no allocation
+  - check() returns true the first time a pair is seen and remembers it;
+    a repeat refreshes the entry and returns false
+  - When full, the least recently seen entry is evicted
+
+  Quick start:
+    SeenCache<16> seen;
+    if (!seen.check(origin, seq)) return; // duplicate
+*/
+
+template <size_t N>
+class SeenCache
+{
+public:
+    bool check(uint32_t origin, uint16_t seq)
+    {
+        _tick++;
+        size_t victim = 0;
+        for (size_t i = 0; i < N; i++)
+        {
+            Entry &e = _e[i];
+            if (e.used && e.origin == origin && e.seq == seq)
+            {
+                e.age = _tick;
+                return false;
+            }
+            // prefer a free slot, otherwise the oldest entry
+            if (!e.used)
+            {
+                if (_e[victim].used)
+                    victim = i;
+            }
+            else if (_e[victim].used && e.age < _e[victim].age)
+            {
+                victim = i;
+            }
+        }
+        _e[victim] = Entry{origin, seq, _tick, true};
+        return true;
+    }
+
+    bool contains(uint32_t origin, uint16_t seq) const
+    {
+        for (size_t i = 0; i < N; i++)
+            if (_e[i].used && _e[i].origin == origin && _e[i].seq == seq)
+                return true;
+        return false;
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < N; i++)
+            _e[i].used = false;
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    struct Entry
+    {
+        uint32_t origin;
+        uint16_t seq;
+        uint32_t age; // _tick of last sighting
+        bool used;
+    };
+    Entry _e[N] = {};
+    uint32_t _tick = 0;
+};
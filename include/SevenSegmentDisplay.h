@@ -1,6 +1,8 @@
 #pragma once
 
 #include <Arduino.h>
+#include "SevenSegmentGlyphs.h"
+#include "Trace.h"
 
 /*
  =============================================================================
@@ -60,24 +62,81 @@
          disp.setBrightnessMicros(1000); // adjust per-digit ON time
          disp.setSegmentMapping(map);    // override QOF_SEG mapping if needed
 
+  Fixed wiring:
+    Once the board is done, SevenSegmentFixed<pins, polarity, mapping>
+    (SevenSegmentFixed.h) does the same with everything resolved at compile
+    time. Both share SevenSegmentText (what to show: pair, scrolling,
+    blinking); code that only sets text takes a SevenSegmentText&.
+
   Notes:
     - refresh() must run frequently; do not use long blocking delays in loop().
     - updateScrolling() uses millis() timing for non-blocking scrolling.
     - getCharSegments() includes digits, many letters, and some lowercase forms
-      (b, c, d, h, o, u) with custom shapes.
+      (b, c, d, h, o, u) with custom shapes (SevenSegmentGlyphs.h).
  =============================================================================
 */
 
-#define SEG_A (1 << 0)
-#define SEG_B (1 << 1)
-#define SEG_C (1 << 2)
-#define SEG_D (1 << 3)
-#define SEG_E (1 << 4)
-#define SEG_F (1 << 5)
-#define SEG_G (1 << 6)
-#define SEG_DP (1 << 7)
+// What the display shows: two characters, a scrolling string or blinking text
+class SevenSegmentText
+{
+public:
+  SevenSegmentText() : _onMicros(1000), _left(' '), _right(' ') {}
+
+  // Store desired characters; call refresh() rapidly in loop() for a stable display.
+  void setPair(char left, char right)
+  {
+    if (left != _left || right != _right)
+      TRACE(Display, left, right);
+    _left = left;
+    _right = right;
+  }
+  void setString(const char *s); // uses first two chars of s, pads with space
+
+  void setBrightnessMicros(uint16_t onMicros) { _onMicros = onMicros; } // per-digit ON time (μs)
+
+  static uint8_t getCharSegments(char c) { return SegFont<SegMapLogical, false>::raw[(uint8_t)c]; }
 
-class SevenSegmentDisplay
+  void setScrollingString(const char *s, uint16_t intervalMs = 400);
+  void updateScrolling(); // call this in loop() along with refresh()
+
+  void setBlinkingText(const char *s, uint16_t periodMs); // period of full on+off cycle
+  void stopBlinking();
+  void updateBlinking();
+
+  // Time blinking / scrolling from startMs instead of now (ScenePlayer: one start tick for every output)
+  void restartAt(uint32_t startMs)
+  {
+    _lastBlinkToggle = startMs;
+    _lastScroll = startMs;
+  }
+
+  // true while something is (or may become) visible, i.e. refresh() has work to do
+  bool isActive() const { return _blinkActive || _scrollingActive || _left != ' ' || _right != ' '; }
+
+protected:
+  void visiblePair(char &l, char &r) const; // what refresh() paints now
+
+  uint16_t _onMicros; // per-digit ON time in microseconds (brightness)
+
+private:
+  String _scrollBuffer;
+  uint16_t _scrollInterval = 400;
+  uint32_t _lastScroll = 0;
+  int _scrollIndex = 0;
+  bool _scrollingActive = false;
+
+  bool _blinkActive = false;
+  bool _blinkVisible = true;
+  uint16_t _blinkPeriodMs = 500; // full cycle (on+off) in ms
+  uint32_t _lastBlinkToggle = 0;
+  String _blinkBuffer; // up to two chars used when blinking
+
+  // Current content for refresh()
+  volatile char _left;
+  volatile char _right;
+};
+
+class SevenSegmentDisplay : public SevenSegmentText
 {
 public:
   enum class SevenSegmentPosition
@@ -94,8 +153,7 @@ public:
 
   SevenSegmentDisplay()
       : _PIN_DATA(0), _PIN_CLOCK(0), _PIN_LATCH(0), _PIN_DIG1(0), _PIN_DIG2(0),
-        _digitActiveHigh(true), _segmentsActiveLow(true), _onMicros(1000),
-        _left(' '), _right(' ')
+        _digitActiveHigh(true), _segmentsActiveLow(true)
   {
   }
 
@@ -106,34 +164,17 @@ public:
   void printChars(char l, char r);
   void printString(const char *str);
 
-  // Store desired characters; call refresh() rapidly in loop() for a stable display.
-  void setPair(char left, char right)
-  {
-    _left = left;
-    _right = right;
-  }
-  void setString(const char *s); // uses first two chars of s, pads with space
-  void refresh();                // paints LEFT then RIGHT each call
+  void refresh(); // paints LEFT then RIGHT each call
   void clearDisplay();
 
   void setDigitActiveHigh(bool activeHigh) { _digitActiveHigh = activeHigh; }
   void setSegmentsActiveLow(bool activeLow) { _segmentsActiveLow = activeLow; }
-  void setBrightnessMicros(uint16_t onMicros) { _onMicros = onMicros; } // per-digit ON time (μs)
   void setSegmentMapping(const uint8_t map[8])
   {
     for (int i = 0; i < 8; i++)
       _QOF_SEG[i] = map[i];
   }
 
-  uint8_t getCharSegments(char c);
-
-  void setScrollingString(const char *s, uint16_t intervalMs = 400);
-  void updateScrolling(); // call this in loop() along with refresh()
-
-  void setBlinkingText(const char *s, uint16_t periodMs); // period of full on+off cycle
-  void stopBlinking();
-  void updateBlinking();
-
 private:
   uint8_t buildRawFromLogical(uint8_t logicalMask);
   void shift595(uint8_t data);
@@ -141,18 +182,6 @@ private:
   inline void _digitOn(uint8_t pin) { digitalWrite(pin, _digitActiveHigh ? HIGH : LOW); }
   inline void _digitOff(uint8_t pin) { digitalWrite(pin, _digitActiveHigh ? LOW : HIGH); }
 
-  String _scrollBuffer;
-  uint16_t _scrollInterval;
-  uint32_t _lastScroll;
-  int _scrollIndex;
-  bool _scrollingActive;
-
-  bool _blinkActive = false;
-  bool _blinkVisible = true;
-  uint16_t _blinkPeriodMs = 500; // full cycle (on+off) in ms
-  uint32_t _lastBlinkToggle = 0;
-  String _blinkBuffer; // up to two chars used when blinking
-
   uint8_t _PIN_DATA;
   uint8_t _PIN_CLOCK;
   uint8_t _PIN_LATCH;
@@ -161,11 +190,6 @@ private:
 
   bool _digitActiveHigh;   // HIGH enables a digit (typical for common-anode)
   bool _segmentsActiveLow; // LOW lights a segment (typical when 595 sinks current)
-  uint16_t _onMicros;      // per-digit ON time in microseconds (brightness)
-
-  // Current content for refresh()
-  volatile char _left;
-  volatile char _right;
 
   // Maps segments A..DP (index 0..7) to 74HC595 bit positions Q0..Q7
   //   a->Q5, b->Q6, c->Q2, d->Q1, e->Q0, f->Q7, g->Q3, dp->Q4
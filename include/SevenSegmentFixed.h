@@ -0,0 +1,99 @@
+#pragma once
+#include <Arduino.h>
+#include <soc/soc.h>
+#include <soc/gpio_reg.h>
+#include "SevenSegmentDisplay.h"
+
+/*
+  SevenSegmentFixed - SevenSegmentDisplay with the wiring fixed at compile time
+  -----------------------------------------------------------------------------
+  - Pins, digit / segment polarity and the segment -> 74HC595 mapping are
+    template arguments: the glyph bytes come from a table generated at compile
+    time (SegFont, in flash), the GPIO masks are constants and the polarity
+    picks the set / clear register at compile time. refresh() has no branch
+    on configuration and no digitalWrite(): every pin change is one store to
+    GPIO_OUT_W1TS / W1TC (both digits switched off in one store).
+  - Same text API as SevenSegmentDisplay (SevenSegmentText: pair, scrolling,
+    blinking, brightness); the runtime class stays for prototyping new wiring
+  - GPIO 0..31 only (the pins must be in GPIO_OUT_REG; checked at compile time)
+  - Shift timing: three stores per bit, tens of ns apart; well inside the
+    74HC595 limits at 3.3 V
+
+  Quick start:
+    SevenSegmentFixed<PIN_DATA, PIN_CLOCK, PIN_LATCH, PIN_DIG1, PIN_DIG2,
+                      true, true, SegMapBoard> disp;   // digits HIGH = on, segments LOW = on
+    disp.init();
+    disp.setString("Hi");
+    disp.refresh();                                    // loop(), very often
+*/
+
+template <uint8_t DATA, uint8_t CLOCK, uint8_t LATCH, uint8_t DIG1, uint8_t DIG2, bool DIGIT_ACTIVE_HIGH = true,
+          bool SEGMENTS_ACTIVE_LOW = true, class MAP = SegMapBoard>
+class SevenSegmentFixed : public SevenSegmentText
+{
+    static_assert(DATA < 32 && CLOCK < 32 && LATCH < 32 && DIG1 < 32 && DIG2 < 32,
+                  "SevenSegmentFixed drives GPIO 0..31 only");
+
+    typedef SegFont<MAP, SEGMENTS_ACTIVE_LOW> Font;
+
+    static const uint32_t DATA_BIT = 1u << DATA;
+    static const uint32_t CLOCK_BIT = 1u << CLOCK;
+    static const uint32_t LATCH_BIT = 1u << LATCH;
+    static const uint32_t DIG1_BIT = 1u << DIG1;
+    static const uint32_t DIG2_BIT = 1u << DIG2;
+    static const uint32_t DIGIT_ON = DIGIT_ACTIVE_HIGH ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG;
+    static const uint32_t DIGIT_OFF = DIGIT_ACTIVE_HIGH ? GPIO_OUT_W1TC_REG : GPIO_OUT_W1TS_REG;
+
+public:
+    void init()
+    {
+        pinMode(DATA, OUTPUT);
+        pinMode(CLOCK, OUTPUT);
+        pinMode(LATCH, OUTPUT);
+        pinMode(DIG1, OUTPUT);
+        pinMode(DIG2, OUTPUT);
+
+        // Known idle states to avoid glitches
+        REG_WRITE(GPIO_OUT_W1TC_REG, DATA_BIT | CLOCK_BIT | LATCH_BIT);
+        clearDisplay();
+    }
+
+    // paints LEFT then RIGHT each call
+    void refresh()
+    {
+        char l, r;
+        visiblePair(l, r);
+        REG_WRITE(DIGIT_OFF, DIG1_BIT | DIG2_BIT);
+        _slice(Font::raw[(uint8_t)l], DIG1_BIT);
+        _slice(Font::raw[(uint8_t)r], DIG2_BIT);
+    }
+
+    void clearDisplay()
+    {
+        REG_WRITE(DIGIT_OFF, DIG1_BIT | DIG2_BIT);
+        _shift(Font::BLANK);
+    }
+
+private:
+    void _slice(uint8_t raw, uint32_t digit)
+    {
+        _shift(raw);
+        delayMicroseconds(2);
+        REG_WRITE(DIGIT_ON, digit);
+        delayMicroseconds(_onMicros);
+        REG_WRITE(DIGIT_OFF, digit);
+    }
+
+    // MSB first, as shiftOut(); the latch copies the byte to the outputs on its rising edge
+    static void _shift(uint8_t data)
+    {
+        REG_WRITE(GPIO_OUT_W1TC_REG, LATCH_BIT);
+        for (uint8_t i = 0; i < 8; i++, data <<= 1)
+        {
+            REG_WRITE(data & 0x80 ? GPIO_OUT_W1TS_REG : GPIO_OUT_W1TC_REG, DATA_BIT);
+            REG_WRITE(GPIO_OUT_W1TS_REG, CLOCK_BIT);
+            REG_WRITE(GPIO_OUT_W1TC_REG, CLOCK_BIT);
+        }
+        REG_WRITE(GPIO_OUT_W1TS_REG, LATCH_BIT);
+    }
+};
@@ -0,0 +1,154 @@
+#pragma once
+#include <stdint.h>
+
+/*
+  SevenSegmentGlyphs - character shapes and 74HC595 byte tables, built by the compiler
+  ------------------------------------------------------------------------------------
+  - segGlyph(c): logical segments (SEG_A..SEG_DP) of a character: digits,
+    most letters (lowercase b c d h o u with their own shapes, the other
+    lowercase ones as uppercase), ! - _ . and space; 0 for the rest
+  - SegMap<a, b, ..., dp>: which 74HC595 output (Q0..Q7) drives each segment
+  - SegFont<MAP, ACTIVE_LOW>::raw[c]: the byte to shift out for character c,
+    mapping and polarity applied: a 256-byte table in flash, generated at
+    compile time (no segment loop, no polarity branch at run time)
+  - gnu++11 constexpr (single-return functions), as the firmware is built
+
+  Quick start:
+    typedef SegFont<SegMapBoard, true> Font;   // this board: common anode, 595 sinks
+    shift(Font::raw[(uint8_t)'H']);
+*/
+
+#define SEG_A (1 << 0)
+#define SEG_B (1 << 1)
+#define SEG_C (1 << 2)
+#define SEG_D (1 << 3)
+#define SEG_E (1 << 4)
+#define SEG_F (1 << 5)
+#define SEG_G (1 << 6)
+#define SEG_DP (1 << 7)
+
+constexpr uint8_t SEG_DIGITS[10] = {
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,         // 0
+    SEG_B | SEG_C,                                         // 1
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,                 // 2
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_G,                 // 3
+    SEG_F | SEG_G | SEG_B | SEG_C,                         // 4
+    SEG_A | SEG_F | SEG_G | SEG_C | SEG_D,                 // 5
+    SEG_A | SEG_F | SEG_E | SEG_D | SEG_C | SEG_G,         // 6
+    SEG_A | SEG_B | SEG_C,                                 // 7
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G, // 8
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,         // 9
+};
+
+constexpr uint8_t SEG_UPPER[26] = {
+    SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G, // A
+    SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,         // B
+    SEG_A | SEG_F | SEG_E | SEG_D,                 // C
+    SEG_B | SEG_C | SEG_D | SEG_E | SEG_G,         // D
+    SEG_A | SEG_F | SEG_E | SEG_D | SEG_G,         // E
+    SEG_A | SEG_F | SEG_E | SEG_G,                 // F
+    SEG_A | SEG_F | SEG_E | SEG_D | SEG_C | SEG_G, // G
+    SEG_B | SEG_C | SEG_E | SEG_F | SEG_G,         // H
+    SEG_B | SEG_C,                                 // I
+    SEG_B | SEG_C | SEG_D | SEG_E,                 // J
+    0,                                             // K
+    SEG_F | SEG_E | SEG_D,                         // L
+    0,                                             // M
+    SEG_C | SEG_E | SEG_G,                         // N
+    SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F, // O
+    SEG_A | SEG_B | SEG_E | SEG_F | SEG_G,         // P
+    SEG_A | SEG_B | SEG_C | SEG_F | SEG_G,         // Q
+    SEG_E | SEG_G,                                 // R
+    SEG_A | SEG_F | SEG_G | SEG_C | SEG_D,         // S
+    SEG_F | SEG_E | SEG_D | SEG_G,                 // T
+    SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,         // U
+    SEG_C | SEG_D | SEG_E,                         // V
+    0,                                             // W
+    0,                                             // X
+    SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,         // Y
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,         // Z
+};
+
+constexpr uint8_t SEG_LOWER[26] = {
+    SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G, // a (as A)
+    SEG_C | SEG_D | SEG_E | SEG_F | SEG_G,         // b
+    SEG_D | SEG_E | SEG_G,                         // c
+    SEG_B | SEG_C | SEG_D | SEG_E | SEG_G,         // d
+    SEG_A | SEG_F | SEG_E | SEG_D | SEG_G,         // e (as E)
+    SEG_A | SEG_F | SEG_E | SEG_G,                 // f (as F)
+    SEG_A | SEG_F | SEG_E | SEG_D | SEG_C | SEG_G, // g (as G)
+    SEG_C | SEG_E | SEG_F | SEG_G,                 // h
+    SEG_B | SEG_C,                                 // i (as I)
+    SEG_B | SEG_C | SEG_D | SEG_E,                 // j (as J)
+    0,                                             // k
+    SEG_F | SEG_E | SEG_D,                         // l (as L)
+    0,                                             // m
+    SEG_C | SEG_E | SEG_G,                         // n (as N)
+    SEG_C | SEG_D | SEG_E | SEG_G,                 // o
+    SEG_A | SEG_B | SEG_E | SEG_F | SEG_G,         // p (as P)
+    SEG_A | SEG_B | SEG_C | SEG_F | SEG_G,         // q (as Q)
+    SEG_E | SEG_G,                                 // r (as R)
+    SEG_A | SEG_F | SEG_G | SEG_C | SEG_D,         // s (as S)
+    SEG_F | SEG_E | SEG_D | SEG_G,                 // t (as T)
+    SEG_C | SEG_D | SEG_E,                         // u
+    SEG_C | SEG_D | SEG_E,                         // v (as V)
+    0,                                             // w
+    0,                                             // x
+    SEG_B | SEG_C | SEG_D | SEG_F | SEG_G,         // y (as Y)
+    SEG_A | SEG_B | SEG_D | SEG_E | SEG_G,         // z (as Z)
+};
+
+constexpr uint8_t segGlyph(char c)
+{
+    return c >= '0' && c <= '9'   ? SEG_DIGITS[c - '0']
+           : c >= 'A' && c <= 'Z' ? SEG_UPPER[c - 'A']
+           : c >= 'a' && c <= 'z' ? SEG_LOWER[c - 'a']
+           : c == '!'             ? SEG_B | SEG_DP
+           : c == '-'             ? SEG_G
+           : c == '_'             ? SEG_D
+           : c == '.'             ? SEG_DP
+                                  : 0;
+}
+
+// 74HC595 output (0..7) wired to each segment
+template <uint8_t A, uint8_t B, uint8_t C, uint8_t D, uint8_t E, uint8_t F, uint8_t G, uint8_t DP>
+struct SegMap
+{
+    static constexpr uint8_t raw(uint8_t m)
+    {
+        return (uint8_t)((m & SEG_A ? 1 << A : 0) | (m & SEG_B ? 1 << B : 0) | (m & SEG_C ? 1 << C : 0) |
+                         (m & SEG_D ? 1 << D : 0) | (m & SEG_E ? 1 << E : 0) | (m & SEG_F ? 1 << F : 0) |
+                         (m & SEG_G ? 1 << G : 0) | (m & SEG_DP ? 1 << DP : 0));
+    }
+};
+
+typedef SegMap<0, 1, 2, 3, 4, 5, 6, 7> SegMapLogical; // bit n = segment n
+typedef SegMap<5, 6, 2, 1, 0, 7, 3, 4> SegMapBoard;   // this board (SevenSegmentDisplay's default mapping)
+
+// 0..N-1 as a parameter pack (std::index_sequence is C++14)
+template <uint8_t... I>
+struct SegSeq
+{
+};
+template <uint16_t N, uint8_t... I>
+struct SegMakeSeq : SegMakeSeq<N - 1, N - 1, I...>
+{
+};
+template <uint8_t... I>
+struct SegMakeSeq<0, I...>
+{
+    typedef SegSeq<I...> type;
+};
+
+template <class MAP, bool ACTIVE_LOW, class SEQ = typename SegMakeSeq<256>::type>
+struct SegFont;
+
+template <class MAP, bool ACTIVE_LOW, uint8_t... I>
+struct SegFont<MAP, ACTIVE_LOW, SegSeq<I...>>
+{
+    static constexpr uint8_t BLANK = ACTIVE_LOW ? 0xFF : 0x00; // all segments off
+    static constexpr uint8_t raw[256] = {(uint8_t)(MAP::raw(segGlyph((char)I)) ^ BLANK)...};
+};
+
+template <class MAP, bool ACTIVE_LOW, uint8_t... I>
+constexpr uint8_t SegFont<MAP, ACTIVE_LOW, SegSeq<I...>>::raw[256];
@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+
+/*
+  SignalLease - hold-to-signal with heartbeat keepalive
+  -----------------------------------------------------
+  Sender side (button):
+    press          -> START      (acknowledged, carries the lease length)
+    while held     -> HEARTBEAT  every heartbeatMs (single frame, no ACK)
+    release        -> STOP       (acknowledged)
+  Receiver side:
+    START/HEARTBEAT extend the lease to now + leaseMs, STOP ends it at once,
+    and if every STOP copy is lost the lease simply times out.
+    A HEARTBEAT that arrives while idle starts the signal (lost START).
+
+  Quick start:
+    SignalLease lease;
+    // loop(), sender:
+    switch (lease.poll(buttonDown, millis())) { case SignalLease::Action::Start: ... }
+    // loop(), receiving (RxRing):
+    lease.extend(body->leaseMs);  /  lease.cancel();
+    // loop(), receiver:
+    SignalLease::Event e = lease.update(millis());   // Started / Ended edges
+*/
+
+class SignalLease
+{
+public:
+    enum class Action : uint8_t
+    {
+        None,
+        Start,
+        Heartbeat,
+        Stop
+    };
+
+    enum class Event : uint8_t
+    {
+        None,
+        Started,
+        Ended
+    };
+
+    // heartbeatMs: keepalive period while held; leaseMs: what each frame grants the receiver
+    void setTiming(uint16_t heartbeatMs, uint16_t leaseMs)
+    {
+        _heartbeatMs = heartbeatMs ? heartbeatMs : 1;
+        _leaseMs = leaseMs;
+    }
+    uint16_t leaseMs() const { return _leaseMs; }
+
+    // ---- Sender ----
+    // pressed: debounced button state; returns what to transmit now (if anything)
+    Action poll(bool pressed, uint32_t now);
+    bool isHeld() const { return _held; }
+
+    // ---- Receiver ----
+    // Call from loop() when START / HEARTBEAT / STOP arrive
+    void extend(uint16_t leaseMs);
+    void cancel() { _until = 0; }
+
+    // Call in loop(): reports start / end edges of the remote signal
+    Event update(uint32_t now);
+    bool isActive() const { return _active; }
+
+private:
+    uint16_t _heartbeatMs = 300;
+    uint16_t _leaseMs = 1000; // ~3 heartbeats: two lost keepalives are tolerated
+
+    // Sender
+    bool _held = false;
+    uint32_t _lastBeat = 0;
+
+    // Receiver: deadline, 0 = no lease
+    uint32_t _until = 0;
+    bool _active = false;
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include "TraceCore.h"
+
+/*
+  Trace - always-on event recorder for timing between boards
+  ----------------------------------------------------------
+  - TRACE(Type, a, b) appends an 8-byte event (esp_timer us, type, args) to
+    the ring of the calling core (TraceCore.h): no lock, safe in ISRs and
+    both cores. Recorded: button edges, TX enqueue / esp_now_send / send
+    callback, receive callback, scene start / end, buzzer notes, LED
+    animations, display text.
+  - Cost per event: the esp_timer read plus a few dozen cycles (atomic slot
+    claim, four stores). EVENTS per core, 4 KB each; oldest overwritten.
+  - dump() (serial 't'): pauses, prints both rings as "trace:" lines with
+    this board's MAC and a 64-bit time anchor, clears, resumes.
+    tools/trace_to_perfetto.py turns the dumps of both boards into one
+    Chrome Trace / Perfetto JSON, clocks aligned on the frames they exchanged.
+  - -DTRACE_EVENTS=0 compiles every TRACE() out
+
+  Quick start:
+    TRACE(Send, f.type(), f.seq());     // anywhere, ISR included
+    Trace::dump(Serial, myMac);         // serial 't'
+    // host:  python3 tools/trace_to_perfetto.py a.log b.log -o trace.json
+*/
+
+#ifndef TRACE_EVENTS
+#define TRACE_EVENTS 1
+#endif
+
+class Trace
+{
+public:
+    static const uint16_t EVENTS = 512; // per core
+
+    static inline void IRAM_ATTR record(TraceType t, uint8_t a, uint16_t b)
+    {
+        _ring[xPortGetCoreID()].put((uint32_t)esp_timer_get_time(), t, a, b);
+    }
+
+    static void dump(Print &out, const uint8_t *mac);
+
+private:
+    static TraceRing<EVENTS> _ring[portNUM_PROCESSORS];
+};
+
+#if TRACE_EVENTS
+#define TRACE(type, a, b) Trace::record(TraceType::type, (uint8_t)(a), (uint16_t)(b))
+#else
+#define TRACE(type, a, b) ((void)sizeof((a), (b))) // arguments not evaluated
+#endif
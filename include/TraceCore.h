@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+  TraceCore - compact timestamped events in an overwrite ring
+  -----------------------------------------------------------
+  - TraceEvent: 8 bytes (us timestamp, type, two small arguments)
+  - TraceRing: fixed array, keeps the newest N events (flight recorder).
+    put() claims a slot with one atomic increment, so the task, an ISR and
+    the other task on the same core may all record without a lock. The
+    reader pauses the ring first (a slot being filled while the ring is read
+    would show up half-written).
+  - Event names are shared with the host converter (tools/trace_to_perfetto.py)
+
+  Quick start:
+    TraceRing<512> r;
+    r.put(micros(), TraceType::Send, CMD_START, seq);
+    r.pause();
+    for (uint32_t i = r.first(); i != r.head(); i++) use(r.at(i));
+    r.clear();  r.resume();
+*/
+
+enum class TraceType : uint8_t
+{
+    Mark,    // a, b: free
+    Button,  // a: 1 down / 0 up (raw edge, bounce included)
+    Enqueue, // a: frame type, b: seq (TxQueue::send())
+    Send,    // a: frame type, b: seq (esp_now_send())
+    Sent,    // a: 1 ACKed / 0 failed
+    Recv,    // a: frame type, b: seq (receive callback)
+    Scene,   // a: scene id, b: 1 start / 0 end
+    Note,    // a: 0 silent / 1 tone, b: Hz
+    LedAnim, // a: TriLeds::Anim
+    Display, // a, b: left and right character
+    Count
+};
+
+inline const char *traceName(TraceType t)
+{
+    static const char *const NAMES[] = {"mark", "button", "enqueue", "send", "sent", "recv",
+                                        "scene", "note", "led", "display"};
+    return t < TraceType::Count ? NAMES[(uint8_t)t] : "?";
+}
+
+struct TraceEvent
+{
+    uint32_t us;
+    uint8_t type;
+    uint8_t a;
+    uint16_t b;
+};
+
+template <uint16_t N>
+class TraceRing
+{
+    static_assert((N & (N - 1)) == 0, "TraceRing size must be a power of two");
+
+public:
+    void put(uint32_t us, TraceType type, uint8_t a, uint16_t b)
+    {
+        if (_paused)
+            return;
+        TraceEvent &e = _e[__atomic_fetch_add(&_head, 1, __ATOMIC_RELAXED) & (N - 1)];
+        e.us = us;
+        e.type = (uint8_t)type;
+        e.a = a;
+        e.b = b;
+    }
+
+    void pause() { __atomic_store_n(&_paused, true, __ATOMIC_SEQ_CST); }
+    void resume() { __atomic_store_n(&_paused, false, __ATOMIC_SEQ_CST); }
+    void clear() { __atomic_store_n(&_head, 0, __ATOMIC_SEQ_CST); }
+
+    // Indices of the events still held: first() .. head() - 1, oldest first
+    uint32_t head() const { return __atomic_load_n(&_head, __ATOMIC_SEQ_CST); }
+    uint32_t first() const { return head() > N ? head() - N : 0; }
+    uint32_t overwritten() const { return first(); }
+    const TraceEvent &at(uint32_t i) const { return _e[i & (N - 1)]; }
+    static uint16_t capacity() { return N; }
+
+private:
+    TraceEvent _e[N] = {};
+    uint32_t _head = 0; // events ever put (wraps after 2^32: days of tracing)
+    bool _paused = false;
+};
@@ -39,10 +39,16 @@ public:
     void playLEDAnim(Anim a, uint16_t periodMs = 150,
                      uint16_t gMs = 1500, uint16_t yMs = 400, uint16_t rMs = 1500);
 
+    // Run the animation from startMs instead of now (ScenePlayer: one start tick for every output)
+    void restartAt(uint32_t startMs) { _t0 = startMs; }
+
     // Fade controls
     void setKittStep(uint16_t ms) { _kittStep = ms; }             // per-hop duration (smooth)
     void setTrafficCrossfade(uint16_t ms) { _trafficXfade = ms; } // blend window at phase end
 
+    // Overall brightness 0..100 % (PWM mode; digital mode only knows on / off at 0 %)
+    void setBrightness(uint8_t pct) { _level = (uint16_t)(pct > 100 ? 100 : pct) * 255u / 100u; }
+
     // Simple control
     void solid(bool g, bool y, bool r);
     void off();
@@ -50,6 +56,9 @@ public:
     // Update
     void update();
 
+    // Status: true while an animation or solid colour is driving the LEDs
+    bool isActive() const { return _anim != Anim::Off; }
+
 private:
     // IO
     void _digital(bool g, bool y, bool r);
@@ -77,6 +86,7 @@ private:
     bool _activeHigh = true, _usePwm = false;
     uint8_t _chG = 1, _chY = 2, _chR = 3, _timer = 1, _res = 8;
     uint16_t _dutyMax = 255;
+    uint8_t _level = 255; // brightness scale
 
     // State
     Anim _anim = Anim::Off;
@@ -0,0 +1,256 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "Protocol.h"
+
+/*
+  TxQueue - outbound ESP-NOW queue, one frame in flight per peer
+  --------------------------------------------------------------
+  - send() only queues (never blocks, never calls the driver twice for one peer):
+    a frame is handed to the driver when its peer has nothing in flight, and the
+    peer's next frame follows once onSent() reported the previous one
+  - Coalescing: a queued (not yet in flight) frame to the same peer with the same
+    non-zero key is replaced in place by the newer one, so repeated keepalives,
+    retransmits or ACKs never pile up behind a slow link
+  - A completion that never comes (lost callback) is given up after timeoutUs.
+    The driver still owes it: completions arrive in send order, so the
+    peer's next one belongs to the timed-out frame and is dropped (late),
+    not credited to the frame now in flight. Given up for good after
+    20 x timeoutUs.
+  - Stats: depth / peak depth, coalesced, rejected (queue full), driver errors,
+    and enqueue -> onSent completion latency
+  - Optional queue hook: sees every accepted frame (tracing)
+  - onSent() runs in the Wi-Fi task and only flags the in-flight slot (release
+    store); everything else runs in loop(). The driver call and the clock are
+    injected, so host tests drive it with fakes.
+
+  Quick start:
+    TxQueue tx;
+    tx.begin(espNowTx, nowUs);              // wrappers around esp_now_send() / micros()
+    tx.send(peer, buf, n, CMD_HEARTBEAT);   // key: coalesce with a pending HEARTBEAT
+    // send callback:  tx.onSent(mac, status == ESP_NOW_SEND_SUCCESS);
+    // loop():         tx.update();
+*/
+
+class TxQueue
+{
+public:
+    typedef bool (*TxFn)(const uint8_t *mac, const uint8_t *data, uint8_t len);
+    typedef uint32_t (*ClockFn)();
+    typedef void (*QueueFn)(const uint8_t *data, uint8_t len);
+
+    static const uint8_t SLOTS = 16;
+    static const uint8_t NO_COALESCE = 0;
+
+    struct Stats
+    {
+        uint32_t queued = 0;    // frames accepted by send()
+        uint32_t coalesced = 0; // replaced a pending frame instead of queueing
+        uint32_t rejected = 0;  // queue full
+        uint32_t completed = 0; // onSent() received
+        uint32_t delivered = 0; // ... with MAC-level success
+        uint32_t timeouts = 0;  // no onSent() within timeoutUs
+        uint32_t late = 0;      // ... that came afterwards, dropped
+        uint32_t errors = 0;    // driver refused the frame
+        uint8_t depth = 0;      // frames queued or in flight right now
+        uint8_t peakDepth = 0;
+        uint32_t lastLatencyUs = 0; // send() -> onSent()
+        uint32_t maxLatencyUs = 0;
+        uint64_t sumLatencyUs = 0; // avg = sumLatencyUs / completed
+    };
+
+    void begin(TxFn tx, ClockFn clockUs, uint32_t timeoutUs = 50000)
+    {
+        _tx = tx;
+        _clock = clockUs;
+        _timeoutUs = timeoutUs;
+        for (uint8_t i = 0; i < SLOTS; i++)
+            _s[i].state = Free;
+    }
+
+    void setQueueHook(QueueFn fn) { _onQueue = fn; }
+
+    // Queue a frame; key != 0 coalesces with a pending frame (same peer, same key)
+    bool send(const uint8_t mac[6], const uint8_t *data, uint8_t len, uint16_t key = NO_COALESCE)
+    {
+        if (len > Proto::MAX_FRAME)
+            return false;
+        Slot *slot = nullptr;
+        if (key != NO_COALESCE)
+            for (uint8_t i = 0; i < SLOTS && !slot; i++)
+                if (_s[i].state == Queued && _s[i].key == key && memcmp(_s[i].mac, mac, 6) == 0)
+                    slot = &_s[i];
+        if (slot)
+        {
+            _stats.coalesced++; // keeps its place in line and its enqueue time
+        }
+        else
+        {
+            for (uint8_t i = 0; i < SLOTS && !slot; i++)
+                if (_s[i].state == Free)
+                    slot = &_s[i];
+            if (!slot)
+            {
+                _stats.rejected++;
+                return false;
+            }
+            memcpy(slot->mac, mac, 6);
+            slot->key = key;
+            slot->order = _nextOrder++;
+            slot->queuedUs = _clock();
+            slot->state = Queued;
+            _stats.queued++;
+            _stats.depth++;
+            if (_stats.depth > _stats.peakDepth)
+                _stats.peakDepth = _stats.depth;
+        }
+        memcpy(slot->data, data, len);
+        slot->len = len;
+        if (_onQueue)
+            _onQueue(data, len);
+        _pump();
+        return true;
+    }
+
+    // Wi-Fi task: completion of the oldest frame sent to `mac` (a timed-out one first)
+    void onSent(const uint8_t *mac, bool ok)
+    {
+        Slot *first = nullptr;
+        for (uint8_t i = 0; i < SLOTS; i++)
+        {
+            Slot &s = _s[i];
+            const State st = __atomic_load_n(&s.state, __ATOMIC_ACQUIRE);
+            if ((st != InFlight && st != Late) || s.done || memcmp(s.mac, mac, 6) != 0)
+                continue;
+            if (!first || (int32_t)(s.order - first->order) < 0)
+                first = &s;
+        }
+        if (!first)
+            return;
+        first->ok = ok;
+        first->doneUs = _clock();
+        __atomic_store_n(&first->done, true, __ATOMIC_RELEASE);
+    }
+
+    // loop(): retire completed frames, start the next one per peer
+    void update()
+    {
+        uint32_t now = _clock();
+        for (uint8_t i = 0; i < SLOTS; i++)
+        {
+            Slot &s = _s[i];
+            if (s.state == Late)
+            {
+                if (__atomic_load_n(&s.done, __ATOMIC_ACQUIRE))
+                    _stats.late++;
+                else if (now - s.sentUs < 20 * _timeoutUs)
+                    continue;
+                __atomic_store_n(&s.state, Free, __ATOMIC_RELEASE);
+                continue;
+            }
+            if (s.state != InFlight)
+                continue;
+            if (__atomic_load_n(&s.done, __ATOMIC_ACQUIRE))
+            {
+                uint32_t lat = s.doneUs - s.queuedUs;
+                _stats.completed++;
+                if (s.ok)
+                    _stats.delivered++;
+                _stats.lastLatencyUs = lat;
+                _stats.sumLatencyUs += lat;
+                if (lat > _stats.maxLatencyUs)
+                    _stats.maxLatencyUs = lat;
+                _free(s);
+            }
+            else if (now - s.sentUs >= _timeoutUs)
+            {
+                // the peer's next frame may start; the slot waits for the completion it is owed
+                _stats.timeouts++;
+                _stats.depth--;
+                __atomic_store_n(&s.state, Late, __ATOMIC_RELEASE);
+            }
+        }
+        _pump();
+    }
+
+    bool isIdle() const { return _stats.depth == 0; }
+    // true if nothing is queued or in flight to `mac`
+    bool isIdle(const uint8_t mac[6]) const
+    {
+        for (uint8_t i = 0; i < SLOTS; i++)
+            if ((_s[i].state == Queued || _s[i].state == InFlight) && memcmp(_s[i].mac, mac, 6) == 0)
+                return false;
+        return true;
+    }
+    const Stats &stats() const { return _stats; }
+
+private:
+    enum State : uint8_t
+    {
+        Free,
+        Queued,
+        InFlight,
+        Late // timed out, its completion not yet arrived
+    };
+
+    struct Slot
+    {
+        uint8_t mac[6];
+        uint8_t data[Proto::MAX_FRAME];
+        uint8_t len;
+        uint16_t key;
+        uint32_t order; // FIFO position (also send order within a peer)
+        uint32_t queuedUs, sentUs, doneUs;
+        bool ok;
+        bool done;      // set by onSent()
+        State state;
+    };
+
+    void _free(Slot &s)
+    {
+        __atomic_store_n(&s.state, Free, __ATOMIC_RELEASE);
+        _stats.depth--;
+    }
+
+    bool _busy(const uint8_t *mac) const
+    {
+        for (uint8_t i = 0; i < SLOTS; i++)
+            if (_s[i].state == InFlight && memcmp(_s[i].mac, mac, 6) == 0)
+                return true;
+        return false;
+    }
+
+    // Start the oldest queued frame of every idle peer
+    void _pump()
+    {
+        for (;;)
+        {
+            Slot *next = nullptr;
+            for (uint8_t i = 0; i < SLOTS; i++)
+            {
+                Slot &s = _s[i];
+                if (s.state == Queued && (!next || (int32_t)(s.order - next->order) < 0) && !_busy(s.mac))
+                    next = &s;
+            }
+            if (!next)
+                return;
+            next->done = false;
+            next->sentUs = _clock();
+            __atomic_store_n(&next->state, InFlight, __ATOMIC_RELEASE);
+            if (!_tx(next->mac, next->data, next->len))
+            {
+                _stats.errors++;
+                _free(*next);
+            }
+        }
+    }
+
+    TxFn _tx = nullptr;
+    QueueFn _onQueue = nullptr;
+    ClockFn _clock = nullptr;
+    uint32_t _timeoutUs = 50000;
+    uint32_t _nextOrder = 0;
+    Slot _s[SLOTS] = {};
+    Stats _stats;
+};
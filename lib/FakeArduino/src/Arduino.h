@@ -0,0 +1,160 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+#include "esp_err.h"
+
+/*
+  FakeArduino - the slice of the Arduino-ESP32 API the drivers use, for host builds
+  --------------------------------------------------------------------------------
+  - Virtual time: millis() / micros() only move when a test advances them
+    (FakeHal.h) or a driver calls delay() / delayMicroseconds(), so busy-waits
+    cost no wall time and runs are deterministic
+  - digitalWrite / shiftOut / ledcWrite / ledcWriteTone are recorded (levels,
+    duties, counters, optional event log) instead of touching hardware
+  - Serial prints to stdout; interrupts are plain calls (FakeHal.h
+    setPinInput() runs the handler), critical sections are no-ops
+  - Only built for the native env (library.json "platforms": "native"); the
+    board builds use the real core
+
+  Quick start (test):
+    #include <Arduino.h>
+    #include "FakeHal.h"
+    fake::reset();
+    disp.refresh();
+    fake::counters().gpioWrites;   // pin writes, shiftOut bits included
+*/
+
+using std::max;
+using std::min;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define LSBFIRST 0
+#define MSBFIRST 1
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define IRAM_ATTR
+
+// one thread: critical sections have nothing to exclude
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux) ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux) ((void)(mux))
+#define portNUM_PROCESSORS 2
+inline int xPortGetCoreID() { return 0; } // everything runs on "core 0"
+
+// no FreeRTOS tasks: xTaskCreate() fails (Log::begin(): records stay in the ring)
+typedef void *TaskHandle_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+#define tskIDLE_PRIORITY 0
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define portYIELD_FROM_ISR() ((void)0)
+inline BaseType_t xTaskCreate(void (*)(void *), const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *) { return 0; }
+inline void xTaskNotifyGive(TaskHandle_t) {}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *) {}
+inline uint32_t ulTaskNotifyTake(BaseType_t, uint32_t) { return 0; }
+inline bool xPortInIsrContext() { return false; }
+
+// time
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// GPIO
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val);
+void attachInterrupt(uint8_t pin, void (*fn)(), int mode);
+void detachInterrupt(uint8_t pin);
+inline uint8_t digitalPinToInterrupt(uint8_t pin) { return pin; }
+
+// LEDC
+double ledcSetup(uint8_t chan, double freq, uint8_t bits);
+void ledcAttachPin(uint8_t pin, uint8_t chan);
+void ledcWrite(uint8_t chan, uint32_t duty);
+double ledcWriteTone(uint8_t chan, double freq);
+
+uint32_t esp_random();
+long random(long max);
+long random(long min, long max);
+
+class String
+{
+public:
+    String(const char *s = "") : _s(s ? s : "") {}
+    String &operator=(const char *s)
+    {
+        _s = s ? s : "";
+        return *this;
+    }
+    size_t length() const { return _s.size(); }
+    char operator[](size_t i) const { return i < _s.size() ? _s[i] : 0; }
+    void remove(size_t from) { _s.erase(std::min(from, _s.size())); }
+    const char *c_str() const { return _s.c_str(); }
+
+private:
+    std::string _s;
+};
+
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buf, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+            write(buf[i]);
+        return n;
+    }
+    size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+    size_t print(const String &s) { return print(s.c_str()); }
+    size_t println(const char *s = "") { return print(s) + print("\n"); }
+    size_t println(const String &s) { return println(s.c_str()); }
+    size_t printf(const char *fmt, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char buf[256];
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+        va_end(ap);
+        return n > 0 ? print(buf) : 0;
+    }
+};
+
+class HardwareSerial : public Print
+{
+public:
+    void begin(unsigned long) {}
+    int available() { return 0; }
+    int read() { return -1; }
+    void flush() { fflush(stdout); }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+public:
+    void restart(); // logged, ignored
+};
+
+extern EspClass ESP;
@@ -0,0 +1,433 @@
+#include "EspNowSim.h"
+#include "FakeHal.h"
+#include "WiFi.h"
+#include "esp_wifi.h"
+#include <algorithm>
+
+// Airtime at 1 Mbit/s DSSS, long preamble
+static const uint32_t PLCP_US = 192;
+static const uint32_t US_PER_BYTE = 8;
+static const uint32_t ESPNOW_OVERHEAD = 43; // MAC header, action + vendor element, FCS
+static const uint32_t ACK_US = PLCP_US + 14 * US_PER_BYTE;
+static const uint32_t SIFS_US = 10, DIFS_US = 50, SLOT_US = 20;
+static const uint32_t CW_MIN = 15, CW_MAX = 1023;
+static const uint32_t SENT_CB_US = 50; // TX done -> send callback (Wi-Fi task)
+static const size_t TXQ_MAX = 8;       // driver buffers; more -> ESP_ERR_ESPNOW_NO_MEM
+
+static const uint8_t BROADCAST[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static uint32_t frameUs(size_t len) { return PLCP_US + (ESPNOW_OVERHEAD + (uint32_t)len) * US_PER_BYTE; }
+
+EspNowSim &EspNowSim::instance()
+{
+    static EspNowSim s;
+    return s;
+}
+
+void EspNowSim::reset(uint32_t seed)
+{
+    fake::reset(0);
+    _nodes.clear();
+    while (!_q.empty())
+        _q.pop();
+    for (auto &row : _links)
+        for (Link &l : row)
+            l = Link();
+    for (double &j : _chanLoss)
+        j = 0;
+    _seq = 0;
+    _now = 0;
+    _rng = seed ? seed : 1;
+    _stats = Stats();
+}
+
+uint8_t EspNowSim::addNode(const uint8_t mac[6], void (*setup)(), void (*loop)())
+{
+    Node n;
+    memcpy(n.mac, mac, 6);
+    n.setup = setup;
+    n.loop = loop;
+    _nodes.push_back(n);
+    const uint8_t i = (uint8_t)(_nodes.size() - 1);
+    fake::setNode(i);
+    fake::setMac(mac);
+    return i;
+}
+
+void EspNowSim::setLink(uint8_t from, uint8_t to, const Link &l)
+{
+    if (from < 4 && to < 4)
+        _links[from][to] = l;
+}
+
+void EspNowSim::setLinks(const Link &l)
+{
+    for (auto &row : _links)
+        for (Link &x : row)
+            x = l;
+}
+
+void EspNowSim::setChannelLoss(uint8_t ch, double loss)
+{
+    if (ch < 15)
+        _chanLoss[ch] = loss;
+}
+
+void EspNowSim::start()
+{
+    for (uint8_t i = 0; i < _nodes.size(); i++)
+    {
+        _run(i, _now, _nodes[i].setup);
+        _nodes[i].nextLoopUs = std::max<uint64_t>(fake::now(), _now);
+    }
+}
+
+void EspNowSim::at(uint64_t us, uint8_t node, std::function<void()> fn)
+{
+    _q.push(Ev{us, _seq++, node, fn});
+}
+
+void EspNowSim::runUntil(uint64_t us)
+{
+    for (;;)
+    {
+        int next = -1;
+        for (uint8_t i = 0; i < _nodes.size(); i++)
+            if (_nodes[i].loop && (next < 0 || _nodes[i].nextLoopUs < _nodes[next].nextLoopUs))
+                next = i;
+        const uint64_t tLoop = next >= 0 ? _nodes[next].nextLoopUs : UINT64_MAX;
+        const uint64_t tEv = _q.empty() ? UINT64_MAX : _q.top().at;
+        if (std::min(tLoop, tEv) > us)
+            break;
+        if (tEv <= tLoop)
+        {
+            Ev e = _q.top();
+            _q.pop();
+            _run(e.node, e.at, e.fn);
+        }
+        else
+        {
+            Node &n = _nodes[next];
+            const uint64_t start = n.nextLoopUs;
+            _run((uint8_t)next, start, n.loop);
+            n.nextLoopUs = std::max<uint64_t>(fake::now(), start + _loopUs);
+        }
+    }
+    _now = us;
+    fake::setTime(us);
+}
+
+void EspNowSim::_run(uint8_t node, uint64_t t, const std::function<void()> &fn)
+{
+    _now = t;
+    fake::setNode(node);
+    fake::setTime(t);
+    fn();
+}
+
+double EspNowSim::_uniform()
+{
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return (_rng & 0xFFFFFF) / double(0x1000000);
+}
+
+// ---- Medium ----
+
+void EspNowSim::_kick(uint8_t node, uint64_t t)
+{
+    Node &n = _nodes[node];
+    if (!n.txBusy && !n.txq.empty())
+        _transmit(node, t);
+}
+
+// Plays out the head frame of a node's queue: attempts, ACKs, deliveries, send callback
+void EspNowSim::_transmit(uint8_t node, uint64_t t)
+{
+    Node &n = _nodes[node];
+    n.txBusy = true;
+    const Frame f = n.txq.front();
+    const uint32_t air = frameUs(f.data.size());
+    uint64_t cur = std::max(t, n.radioFreeUs);
+    uint64_t done = cur;
+    bool ok = false;
+
+    if (memcmp(f.dst, BROADCAST, 6) == 0)
+    {
+        const uint64_t end = cur + DIFS_US + (uint64_t)(_uniform() * (CW_MIN + 1)) * SLOT_US + air;
+        _stats.attempts++;
+        _stats.airUs += air;
+        for (uint8_t j = 0; j < _nodes.size(); j++)
+        {
+            if (j == node || !_nodes[j].inited || _nodes[j].channel != n.channel)
+                continue;
+            _stats.expected++;
+            if (!_lost(node, j))
+                _deliver(node, j, f, end, true);
+        }
+        done = end;
+        ok = true;
+    }
+    else
+    {
+        const int to = _find(f.dst);
+        const bool reachable = to >= 0 && _nodes[to].inited && _nodes[to].channel == n.channel;
+        bool got = false;
+        uint32_t cw = CW_MIN;
+        _stats.expected++;
+        for (uint8_t k = 0; k <= MAX_RETRIES && !ok; k++)
+        {
+            const uint64_t end = cur + DIFS_US + (uint64_t)(_uniform() * (cw + 1)) * SLOT_US + air;
+            _stats.attempts++;
+            _stats.airUs += air;
+            cw = std::min(cw * 2 + 1, CW_MAX);
+            if (reachable && !_lost(node, (uint8_t)to))
+            {
+                if (!got) // a retransmission of a frame it already has is dropped by the receiver's MAC
+                    _deliver(node, (uint8_t)to, f, end, true);
+                got = true;
+                _stats.airUs += ACK_US;
+                if (!_lost((uint8_t)to, node))
+                {
+                    ok = true;
+                    done = end + SIFS_US + ACK_US;
+                    break;
+                }
+            }
+            cur = end + SIFS_US + ACK_US; // ACK timeout
+            done = cur;
+        }
+    }
+    n.radioFreeUs = done;
+
+    const esp_now_send_status_t status = ok ? ESP_NOW_SEND_SUCCESS : ESP_NOW_SEND_FAIL;
+    at(done + SENT_CB_US, node, [this, node, f, status]
+       {
+           Node &me = _nodes[node];
+           me.txq.erase(me.txq.begin());
+           me.txBusy = false;
+           if (memcmp(f.dst, BROADCAST, 6) != 0)
+               (status == ESP_NOW_SEND_SUCCESS ? _stats.acked : _stats.failed)++;
+           if (me.sent)
+               me.sent(f.dst, status);
+           _kick(node, fake::now());
+       });
+}
+
+void EspNowSim::_deliver(uint8_t from, uint8_t to, const Frame &f, uint64_t endUs, bool first)
+{
+    const Link &l = _links[from][to];
+    const uint64_t atUs = endUs + l.delayUs + (uint64_t)(_uniform() * l.jitterUs);
+    const uint8_t *src = _nodes[from].mac;
+    std::vector<uint8_t> data = f.data;
+    const uint64_t queued = f.queuedUs;
+    uint8_t srcMac[6];
+    memcpy(srcMac, src, 6);
+    at(atUs, to, [this, to, data, srcMac, first, queued]
+       {
+           if (first)
+           {
+               _stats.delivered++;
+               _stats.latencyUs.push_back((uint32_t)(fake::now() - queued));
+           }
+           else
+               _stats.duplicates++;
+           if (_nodes[to].recv && _nodes[to].inited)
+               _nodes[to].recv(srcMac, data.data(), (int)data.size());
+       });
+    if (first && _uniform() < l.duplicate)
+        _deliver(from, to, f, atUs, false);
+}
+
+// ---- Driver side ----
+
+EspNowSim::Node &EspNowSim::_cur() { return _nodes[fake::node()]; }
+const EspNowSim::Node &EspNowSim::_cur() const { return _nodes[fake::node()]; }
+
+int EspNowSim::_find(const uint8_t *mac) const
+{
+    for (size_t i = 0; i < _nodes.size(); i++)
+        if (memcmp(_nodes[i].mac, mac, 6) == 0)
+            return (int)i;
+    return -1;
+}
+
+esp_err_t EspNowSim::init()
+{
+    if (fake::node() >= _nodes.size())
+        return ESP_FAIL;
+    _cur().inited = true;
+    return ESP_OK;
+}
+
+esp_err_t EspNowSim::deinit()
+{
+    Node &n = _cur();
+    n.inited = false;
+    n.recv = nullptr;
+    n.sent = nullptr;
+    n.peers.clear();
+    return ESP_OK;
+}
+
+esp_err_t EspNowSim::setRecvCb(esp_now_recv_cb_t cb)
+{
+    if (!_cur().inited)
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    _cur().recv = cb;
+    return ESP_OK;
+}
+
+esp_err_t EspNowSim::setSendCb(esp_now_send_cb_t cb)
+{
+    if (!_cur().inited)
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    _cur().sent = cb;
+    return ESP_OK;
+}
+
+esp_err_t EspNowSim::addPeer(const esp_now_peer_info_t *p)
+{
+    if (!_cur().inited)
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    if (!p)
+        return ESP_ERR_ESPNOW_ARG;
+    if (hasPeer(p->peer_addr))
+        return ESP_ERR_ESPNOW_EXIST;
+    _cur().peers.push_back(std::vector<uint8_t>(p->peer_addr, p->peer_addr + 6));
+    return ESP_OK;
+}
+
+esp_err_t EspNowSim::delPeer(const uint8_t *mac)
+{
+    std::vector<std::vector<uint8_t>> &peers = _cur().peers;
+    for (auto it = peers.begin(); it != peers.end(); ++it)
+    {
+        if (memcmp(it->data(), mac, 6) == 0)
+        {
+            peers.erase(it);
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_ESPNOW_NOT_FOUND;
+}
+
+bool EspNowSim::hasPeer(const uint8_t *mac) const
+{
+    if (fake::node() >= _nodes.size())
+        return false;
+    for (const std::vector<uint8_t> &p : _cur().peers)
+        if (memcmp(p.data(), mac, 6) == 0)
+            return true;
+    return false;
+}
+
+esp_err_t EspNowSim::send(const uint8_t *mac, const uint8_t *data, size_t len)
+{
+    Node &n = _cur();
+    if (!n.inited)
+        return ESP_ERR_ESPNOW_NOT_INIT;
+    if (!mac || !data || !len || len > ESP_NOW_MAX_DATA_LEN)
+        return ESP_ERR_ESPNOW_ARG;
+    if (!hasPeer(mac))
+        return ESP_ERR_ESPNOW_NOT_FOUND;
+    if (n.txq.size() >= TXQ_MAX)
+        return ESP_ERR_ESPNOW_NO_MEM;
+    Frame f;
+    memcpy(f.dst, mac, 6);
+    f.data.assign(data, data + len);
+    f.queuedUs = fake::now();
+    n.txq.push_back(f);
+    _stats.sends++;
+    _kick(fake::node(), fake::now());
+    return ESP_OK;
+}
+
+void EspNowSim::setChannel(uint8_t ch)
+{
+    if (fake::node() < _nodes.size())
+        _cur().channel = ch;
+}
+
+uint8_t EspNowSim::channel() const
+{
+    return fake::node() < _nodes.size() ? _cur().channel : 1;
+}
+
+// ---- Report ----
+
+uint32_t EspNowSim::percentile(std::vector<uint32_t> v, uint8_t pct)
+{
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    size_t i = (v.size() * pct + 99) / 100;
+    return v[i ? i - 1 : 0];
+}
+
+void EspNowSim::printReport(const char *label) const
+{
+    const Stats &s = _stats;
+    printf("%-22s sends %5lu  delivered %5lu/%-5lu (%5.1f%%)  dup %4lu  ack %5lu fail %4lu  "
+           "tx/send %4.2f  air %7.1f ms (%4.0f us/send)  latency ms p50 %5.2f p90 %5.2f p99 %5.2f max %6.2f\n",
+           label, (unsigned long)s.sends, (unsigned long)s.delivered, (unsigned long)s.expected,
+           s.expected ? 100.0 * s.delivered / s.expected : 0.0, (unsigned long)s.duplicates,
+           (unsigned long)s.acked, (unsigned long)s.failed, s.sends ? (double)s.attempts / s.sends : 0.0,
+           s.airUs / 1000.0, s.sends ? (double)s.airUs / s.sends : 0.0,
+           percentile(s.latencyUs, 50) / 1000.0, percentile(s.latencyUs, 90) / 1000.0,
+           percentile(s.latencyUs, 99) / 1000.0, percentile(s.latencyUs, 100) / 1000.0);
+}
+
+// ---- esp_now_* / esp_wifi_* / WiFi of the current node ----
+
+esp_err_t esp_now_init() { return EspNowSim::instance().init(); }
+esp_err_t esp_now_deinit() { return EspNowSim::instance().deinit(); }
+esp_err_t esp_now_register_recv_cb(esp_now_recv_cb_t cb) { return EspNowSim::instance().setRecvCb(cb); }
+esp_err_t esp_now_register_send_cb(esp_now_send_cb_t cb) { return EspNowSim::instance().setSendCb(cb); }
+esp_err_t esp_now_add_peer(const esp_now_peer_info_t *peer) { return EspNowSim::instance().addPeer(peer); }
+esp_err_t esp_now_del_peer(const uint8_t *mac) { return EspNowSim::instance().delPeer(mac); }
+bool esp_now_is_peer_exist(const uint8_t *mac) { return EspNowSim::instance().hasPeer(mac); }
+esp_err_t esp_now_mod_peer(const esp_now_peer_info_t *peer)
+{
+    return EspNowSim::instance().hasPeer(peer->peer_addr) ? ESP_OK : ESP_ERR_ESPNOW_NOT_FOUND;
+}
+esp_err_t esp_now_send(const uint8_t *mac, const uint8_t *data, size_t len)
+{
+    return EspNowSim::instance().send(mac, data, len);
+}
+
+esp_err_t esp_wifi_set_promiscuous(bool) { return ESP_OK; }
+esp_err_t esp_wifi_set_promiscuous_rx_cb(wifi_promiscuous_cb_t) { return ESP_OK; }
+esp_err_t esp_wifi_set_promiscuous_filter(const wifi_promiscuous_filter_t *) { return ESP_OK; }
+esp_err_t esp_wifi_set_channel(uint8_t primary, wifi_second_chan_t)
+{
+    if (primary < 1 || primary > 14)
+        return ESP_ERR_INVALID_ARG;
+    EspNowSim::instance().setChannel(primary);
+    return ESP_OK;
+}
+esp_err_t esp_wifi_get_channel(uint8_t *primary, wifi_second_chan_t *second)
+{
+    *primary = EspNowSim::instance().channel();
+    *second = WIFI_SECOND_CHAN_NONE;
+    return ESP_OK;
+}
+esp_err_t esp_wifi_set_ps(wifi_ps_type_t) { return ESP_OK; }
+esp_err_t esp_wifi_stop() { return ESP_OK; }
+
+WiFiClass WiFi;
+
+uint8_t *WiFiClass::macAddress(uint8_t *mac)
+{
+    memcpy(mac, fake::mac(), 6);
+    return mac;
+}
+
+String WiFiClass::macAddress()
+{
+    const uint8_t *m = fake::mac();
+    char b[18];
+    snprintf(b, sizeof(b), "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+    return String(b);
+}
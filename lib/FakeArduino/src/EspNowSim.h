@@ -0,0 +1,157 @@
+#pragma once
+#include <stdint.h>
+#include <functional>
+#include <queue>
+#include <vector>
+#include "esp_now.h"
+
+/*
+  EspNowSim - several boards' firmware in one process over a virtual ESP-NOW medium
+  --------------------------------------------------------------------------------
+  - Each node is a setup() / loop() pair (e.g. the same sketch compiled into two
+    namespaces) with its own MAC, pins and NVS (FakeHal.h nodes). The esp_now_*
+    calls of the firmware land here.
+  - Discrete events in virtual time: loop() passes, frame deliveries, send
+    callbacks and test actions (at()) run in time order, each in its node's
+    context. A loop() pass runs to completion, so a callback can observe an
+    earlier time than that node's last loop() reached (as if it interrupted a
+    delay()).
+  - Medium, per directed link: loss (per transmission, ACKs included), delay +
+    uniform jitter from the end of the frame to the receive callback (reorders
+    frames when jitter exceeds their spacing), and duplication (an extra,
+    later copy reaching the application). Unicast uses MAC-level ACK with
+    retries and backoff; a lost ACK causes a retransmission the receiver drops
+    (802.11 duplicate detection), broadcast is sent once. Only nodes on the
+    same channel hear each other; setChannelLoss() adds interference on one
+    channel (every transmission on it, whoever sends). No collisions (a node sends one frame at a
+    time; two nodes are rarely on air together).
+  - Airtime at the 1 Mbit/s default rate, long preamble (as test_group_scaling)
+  - Stats: frames, attempts, deliveries, duplicates, airtime, send -> receive
+    latency; printReport() shows delivery ratio and latency percentiles
+
+  Quick start:
+    EspNowSim &sim = EspNowSim::instance();
+    sim.reset(seed);
+    uint8_t a = sim.addNode(macA, devA::setup, devA::loop);
+    uint8_t b = sim.addNode(macB, devB::setup, devB::loop);
+    sim.setLinks(EspNowSim::Link{0.2, 500, 2000, 0.05});   // 20 % loss, 0.5..2.5 ms, 5 % dups
+    sim.start();
+    sim.at(1000000, a, [] { fake::setPinInput(33, LOW); }); // press A's button at t = 1 s
+    sim.runUntil(5000000);
+    sim.printReport("lossy");
+*/
+
+class EspNowSim
+{
+public:
+    struct Link
+    {
+        double loss = 0;       // per transmission (data and ACK), 0..1
+        uint32_t delayUs = 300; // end of frame -> receive callback
+        uint32_t jitterUs = 0;  // + uniform 0..jitterUs
+        double duplicate = 0;   // extra copy delivered to the application, 0..1
+    };
+
+    struct Stats
+    {
+        uint32_t sends = 0;       // esp_now_send() calls accepted
+        uint32_t attempts = 0;    // transmissions on air, retries included
+        uint32_t delivered = 0;   // receive callbacks, duplicates excluded (unicast: per frame, broadcast: per receiver)
+        uint32_t duplicates = 0;  // extra receive callbacks
+        uint32_t acked = 0;       // send callbacks with SUCCESS (unicast)
+        uint32_t failed = 0;      // ... with FAIL
+        uint32_t expected = 0;    // receptions that should have happened (unicast 1, broadcast: listeners)
+        uint64_t airUs = 0;       // data frames + ACKs
+        std::vector<uint32_t> latencyUs; // esp_now_send() -> first receive callback
+    };
+
+    static const uint8_t MAX_RETRIES = 7; // MAC retransmissions per unicast frame
+
+    static EspNowSim &instance();
+
+    void reset(uint32_t seed = 1);
+    uint8_t addNode(const uint8_t mac[6], void (*setup)(), void (*loop)());
+    void setLink(uint8_t from, uint8_t to, const Link &l);
+    void setLinks(const Link &l); // every directed link
+    void setChannelLoss(uint8_t ch, double loss); // on top of the link's, 0..1
+    void setLoopUs(uint32_t us) { _loopUs = us; } // minimum virtual time per loop() pass
+
+    void start(); // setup() of every node, at the current time
+    void at(uint64_t us, uint8_t node, std::function<void()> fn);
+    void runUntil(uint64_t us);
+    uint64_t now() const { return _now; }
+
+    const Stats &stats() const { return _stats; }
+    void clearStats() { _stats = Stats(); }
+    void printReport(const char *label) const;
+    static uint32_t percentile(std::vector<uint32_t> v, uint8_t pct);
+
+    // ---- driver side (esp_now_* / esp_wifi_* of the current node) ----
+    esp_err_t init();
+    esp_err_t deinit();
+    esp_err_t setRecvCb(esp_now_recv_cb_t cb);
+    esp_err_t setSendCb(esp_now_send_cb_t cb);
+    esp_err_t addPeer(const esp_now_peer_info_t *p);
+    esp_err_t delPeer(const uint8_t *mac);
+    bool hasPeer(const uint8_t *mac) const;
+    esp_err_t send(const uint8_t *mac, const uint8_t *data, size_t len);
+    void setChannel(uint8_t ch);
+    uint8_t channel() const;
+
+private:
+    struct Frame
+    {
+        uint8_t dst[6];
+        std::vector<uint8_t> data;
+        uint64_t queuedUs;
+    };
+
+    struct Node
+    {
+        uint8_t mac[6];
+        void (*setup)() = nullptr;
+        void (*loop)() = nullptr;
+        bool inited = false;
+        esp_now_recv_cb_t recv = nullptr;
+        esp_now_send_cb_t sent = nullptr;
+        std::vector<std::vector<uint8_t>> peers;
+        uint8_t channel = 1;
+        uint64_t nextLoopUs = 0;
+        uint64_t radioFreeUs = 0;
+        std::vector<Frame> txq; // driver queue, head on air
+        bool txBusy = false;
+    };
+
+    struct Ev
+    {
+        uint64_t at;
+        uint64_t seq;
+        uint8_t node;
+        std::function<void()> fn;
+        bool operator>(const Ev &o) const { return at != o.at ? at > o.at : seq > o.seq; }
+    };
+
+    Node &_cur();
+    const Node &_cur() const;
+    int _find(const uint8_t *mac) const;
+    void _kick(uint8_t node, uint64_t t);
+    void _transmit(uint8_t node, uint64_t t);
+    void _deliver(uint8_t from, uint8_t to, const Frame &f, uint64_t endUs, bool first);
+    void _run(uint8_t node, uint64_t t, const std::function<void()> &fn);
+    double _uniform();
+    bool _lost(uint8_t from, uint8_t to)
+    {
+        const double jam = _chanLoss[_nodes[from].channel % 15];
+        return _uniform() < _links[from][to].loss || (jam > 0 && _uniform() < jam);
+    }
+
+    std::vector<Node> _nodes;
+    Link _links[4][4];
+    double _chanLoss[15] = {0}; // by channel 1..14
+    std::priority_queue<Ev, std::vector<Ev>, std::greater<Ev>> _q;
+    uint64_t _seq = 0;
+    uint64_t _now = 0;
+    uint32_t _loopUs = 100;
+    uint32_t _rng = 1;
+    Stats _stats;
+};
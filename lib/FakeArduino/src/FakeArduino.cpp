@@ -0,0 +1,263 @@
+#include "Arduino.h"
+#include "FakeHal.h"
+#include "esp_timer.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace
+{
+    const int PINS = 40;
+    const int CHANNELS = 16;
+
+    struct Node
+    {
+        fake::Counters n;
+        int8_t level[PINS];
+        int8_t input[PINS];
+        void (*isr[PINS])();
+        int isrMode[PINS];
+        uint32_t duty[CHANNELS];
+        double freq[CHANNELS];
+        bool record = false;
+        std::vector<fake::Event> log;
+        uint8_t mac[6];
+
+        Node() { clear(0); }
+        void clear(uint8_t index)
+        {
+            n = fake::Counters();
+            for (int i = 0; i < PINS; i++)
+            {
+                level[i] = input[i] = -1;
+                isr[i] = nullptr;
+                isrMode[i] = 0;
+            }
+            for (int i = 0; i < CHANNELS; i++)
+            {
+                duty[i] = 0;
+                freq[i] = 0;
+            }
+            record = false;
+            log.clear();
+            const uint8_t m[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, (uint8_t)(index + 1)};
+            memcpy(mac, m, 6);
+        }
+    };
+
+    struct State
+    {
+        uint64_t nowUs = 0;
+        uint8_t cur = 0;
+        Node nodes[fake::MAX_NODES];
+        uint32_t rng = 1;
+    };
+
+    State &st()
+    {
+        static State s;
+        return s;
+    }
+
+    Node &nd() { return st().nodes[st().cur]; }
+
+    void logEvent(fake::Op op, uint8_t pin, uint32_t value)
+    {
+        Node &n = nd();
+        if (n.record)
+            n.log.push_back(fake::Event{(uint32_t)st().nowUs, op, pin, value});
+    }
+
+    void setLevel(uint8_t pin, uint8_t val)
+    {
+        if (pin < PINS)
+            nd().level[pin] = val ? 1 : 0;
+    }
+}
+
+// ---- Arduino API ----
+uint32_t millis() { return (uint32_t)(st().nowUs / 1000u); }
+uint32_t micros() { return (uint32_t)st().nowUs; }
+int64_t esp_timer_get_time() { return (int64_t)st().nowUs; }
+
+void delay(uint32_t ms)
+{
+    st().nowUs += (uint64_t)ms * 1000u;
+    nd().n.delayUs += (uint64_t)ms * 1000u;
+}
+
+void delayMicroseconds(uint32_t us)
+{
+    st().nowUs += us;
+    nd().n.delayUs += us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    Node &n = nd();
+    n.n.pinModes++;
+    if (mode == INPUT_PULLUP && pin < PINS && n.level[pin] < 0)
+        n.level[pin] = 1; // an open input with pull-up reads HIGH
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    Node &n = nd();
+    n.n.digitalWrites++;
+    n.n.gpioWrites++;
+    setLevel(pin, val);
+    logEvent(fake::Op::Write, pin, val ? 1 : 0);
+}
+
+void fake::regWrite(uint32_t reg, uint32_t value)
+{
+    if (reg != GPIO_OUT_W1TS_REG && reg != GPIO_OUT_W1TC_REG)
+        return;
+    Node &n = nd();
+    n.n.regWrites++;
+    n.n.gpioWrites++;
+    const uint8_t level = reg == GPIO_OUT_W1TS_REG ? 1 : 0;
+    for (uint32_t m = value; m; m &= m - 1)
+    {
+        const uint8_t pin = (uint8_t)__builtin_ctz(m);
+        setLevel(pin, level);
+        logEvent(fake::Op::Write, pin, level);
+    }
+}
+
+int digitalRead(uint8_t pin)
+{
+    Node &n = nd();
+    n.n.digitalReads++;
+    if (pin >= PINS)
+        return LOW;
+    return n.input[pin] >= 0 ? n.input[pin] : (n.level[pin] > 0 ? HIGH : LOW);
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder, uint8_t val)
+{
+    Node &n = nd();
+    n.n.shiftOuts++;
+    n.n.gpioWrites += 8 * 3; // per bit: data, clock high, clock low
+    for (uint8_t i = 0; i < 8; i++)
+        setLevel(dataPin, bitOrder == LSBFIRST ? (val >> i) & 1 : (val >> (7 - i)) & 1);
+    setLevel(clockPin, LOW);
+    logEvent(fake::Op::Shift, dataPin, val);
+}
+
+void attachInterrupt(uint8_t pin, void (*fn)(), int mode)
+{
+    if (pin < PINS)
+    {
+        nd().isr[pin] = fn;
+        nd().isrMode[pin] = mode;
+    }
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < PINS)
+        nd().isr[pin] = nullptr;
+}
+
+double ledcSetup(uint8_t chan, double freq, uint8_t)
+{
+    if (chan < CHANNELS)
+        nd().freq[chan] = freq;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t, uint8_t) {}
+
+void ledcWrite(uint8_t chan, uint32_t duty)
+{
+    Node &n = nd();
+    n.n.ledcWrites++;
+    if (chan < CHANNELS)
+        n.duty[chan] = duty;
+    logEvent(fake::Op::Duty, chan, duty);
+}
+
+double ledcWriteTone(uint8_t chan, double freq)
+{
+    Node &n = nd();
+    n.n.ledcTones++;
+    if (chan < CHANNELS)
+        n.freq[chan] = freq;
+    logEvent(fake::Op::Tone, chan, (uint32_t)freq);
+    return freq;
+}
+
+uint32_t esp_random()
+{
+    uint32_t &x = st().rng; // xorshift32: deterministic across runs
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+long random(long max) { return max > 0 ? (long)(esp_random() % (uint32_t)max) : 0; }
+long random(long min, long max) { return max > min ? min + random(max - min) : min; }
+
+void EspClass::restart()
+{
+    printf("[node %u] ESP.restart() ignored on the host\n", st().cur);
+}
+
+// ---- Test control ----
+namespace fake
+{
+    void clearNvs(); // Preferences.cpp
+
+    void reset(uint32_t startUs)
+    {
+        State &s = st();
+        for (uint8_t i = 0; i < MAX_NODES; i++)
+            s.nodes[i].clear(i);
+        s.cur = 0;
+        s.nowUs = startUs;
+        s.rng = 1;
+        clearNvs();
+    }
+
+    void advanceUs(uint32_t us) { st().nowUs += us; }
+    void setTime(uint64_t us) { st().nowUs = us; }
+    uint64_t now() { return st().nowUs; }
+
+    void setNode(uint8_t node) { st().cur = node < MAX_NODES ? node : 0; }
+    uint8_t node() { return st().cur; }
+    void setMac(const uint8_t mac[6]) { memcpy(nd().mac, mac, 6); }
+    const uint8_t *mac() { return nd().mac; }
+
+    const Counters &counters() { return nd().n; }
+    void clearCounters() { nd().n = Counters(); }
+
+    int pinLevel(uint8_t pin) { return pin < PINS ? nd().level[pin] : -1; }
+    uint32_t ledcDuty(uint8_t chan) { return chan < CHANNELS ? nd().duty[chan] : 0; }
+    double ledcFreq(uint8_t chan) { return chan < CHANNELS ? nd().freq[chan] : 0; }
+
+    void setPinInput(uint8_t pin, int level)
+    {
+        if (pin >= PINS)
+            return;
+        Node &n = nd();
+        const int before = n.input[pin] >= 0 ? n.input[pin] : (n.level[pin] > 0 ? HIGH : LOW);
+        n.input[pin] = level;
+        if (!n.isr[pin] || before == level)
+            return;
+        const int mode = n.isrMode[pin];
+        if (mode == CHANGE || (mode == FALLING && level == LOW) || (mode == RISING && level == HIGH))
+            n.isr[pin]();
+    }
+
+    void record(bool on)
+    {
+        nd().record = on;
+        nd().log.clear();
+    }
+
+    const std::vector<Event> &events() { return nd().log; }
+}
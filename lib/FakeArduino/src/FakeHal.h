@@ -0,0 +1,77 @@
+#pragma once
+#include <stdint.h>
+#include <vector>
+
+/*
+  FakeHal - test-side control of the FakeArduino HAL
+  --------------------------------------------------
+  - Virtual clock: advanceUs() / advanceMs(); delay*() from the code under
+    test advance it too (counted separately in Counters::delayUs)
+  - Counters of every HAL call since the last reset(); gpioWrites counts what
+    the pins see, so a shiftOut() is its 8 data + 16 clock writes as in the
+    Arduino-ESP32 implementation, and a GPIO_OUT_W1TS / W1TC store is one
+    write whatever the number of pins it changes
+  - Last state per pin / LEDC channel, and an optional event log
+  - Nodes: up to MAX_NODES boards in one process (EspNowSim). Pins, LEDC,
+    counters, log, interrupts, MAC and Preferences are per node; setNode()
+    picks the board whose code runs next. The clock is shared, but setTime()
+    may move it back: each board's code runs at its own point in time.
+*/
+
+namespace fake
+{
+    static const uint8_t MAX_NODES = 4;
+
+    struct Counters
+    {
+        uint32_t pinModes = 0;
+        uint32_t digitalWrites = 0; // direct digitalWrite() calls
+        uint32_t digitalReads = 0;
+        uint32_t shiftOuts = 0;
+        uint32_t gpioWrites = 0; // pin writes incl. the ones inside shiftOut() and register stores
+        uint32_t regWrites = 0;  // GPIO_OUT_W1TS / W1TC stores (REG_WRITE)
+        uint32_t ledcWrites = 0;
+        uint32_t ledcTones = 0;
+        uint64_t delayUs = 0;   // time spent in delay() / delayMicroseconds()
+    };
+
+    enum class Op : uint8_t
+    {
+        Write,   // pin, level
+        Shift,   // data pin, byte
+        Duty,    // channel, duty
+        Tone     // channel, Hz
+    };
+
+    struct Event
+    {
+        uint32_t atUs;
+        Op op;
+        uint8_t pin; // pin or channel
+        uint32_t value;
+    };
+
+    // Clears every node (counters, pin / channel state, log, interrupts, NVS) and the clock
+    void reset(uint32_t startUs = 0);
+    void advanceUs(uint32_t us);
+    inline void advanceMs(uint32_t ms) { advanceUs(ms * 1000u); }
+    void setTime(uint64_t us);
+    uint64_t now();
+
+    void setNode(uint8_t node);
+    uint8_t node();
+    void setMac(const uint8_t mac[6]); // current node (WiFi.macAddress())
+    const uint8_t *mac();
+
+    const Counters &counters();
+    void clearCounters();
+
+    int pinLevel(uint8_t pin);        // -1 = never written
+    uint32_t ledcDuty(uint8_t chan);
+    double ledcFreq(uint8_t chan);
+    // What digitalRead() returns; a change runs an attachInterrupt() handler
+    void setPinInput(uint8_t pin, int level);
+
+    void record(bool on); // event log off by default (benchmarks)
+    const std::vector<Event> &events();
+}
@@ -0,0 +1,73 @@
+#include "Preferences.h"
+#include "FakeHal.h"
+#include <map>
+#include <vector>
+
+namespace
+{
+    std::map<std::string, std::vector<uint8_t>> &nvs()
+    {
+        static std::map<std::string, std::vector<uint8_t>> m;
+        return m;
+    }
+}
+
+namespace fake
+{
+    void clearNvs() { nvs().clear(); } // from reset()
+}
+
+std::string Preferences::_key(const char *key) const
+{
+    return std::to_string(fake::node()) + "/" + _ns + "/" + key;
+}
+
+bool Preferences::begin(const char *name, bool readOnly, const char *)
+{
+    _ns = name;
+    _open = true;
+    _readOnly = readOnly;
+    return true;
+}
+
+void Preferences::end() { _open = false; }
+
+bool Preferences::clear()
+{
+    if (!_open || _readOnly)
+        return false;
+    const std::string prefix = _key("");
+    for (auto it = nvs().begin(); it != nvs().end();)
+        it = it->first.compare(0, prefix.size(), prefix) == 0 ? nvs().erase(it) : std::next(it);
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    return _open && !_readOnly && nvs().erase(_key(key)) > 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return _open && nvs().count(_key(key)) > 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+    if (!_open || _readOnly)
+        return 0;
+    const uint8_t *p = static_cast<const uint8_t *>(value);
+    nvs()[_key(key)] = std::vector<uint8_t>(p, p + len);
+    return len;
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    if (!_open)
+        return 0;
+    auto it = nvs().find(_key(key));
+    if (it == nvs().end() || it->second.size() > maxLen)
+        return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+
+// NVS in memory, one store per node (FakeHal.h setNode); survives until fake::reset()
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partition = nullptr);
+    void end();
+
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBool(const char *key, bool value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUChar(const char *key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char *key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBytes(const char *key, const void *value, size_t len);
+
+    bool getBool(const char *key, bool defaultValue = false) { return _get(key, defaultValue); }
+    uint8_t getUChar(const char *key, uint8_t defaultValue = 0) { return _get(key, defaultValue); }
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0) { return _get(key, defaultValue); }
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+private:
+    template <typename T>
+    T _get(const char *key, T def)
+    {
+        T v;
+        return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : def;
+    }
+    std::string _key(const char *key) const;
+
+    std::string _ns;
+    bool _open = false;
+    bool _readOnly = false;
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+
+// Station mode and the node's MAC (FakeHal.h setMac / EspNowSim::addNode)
+
+#define WIFI_OFF 0
+#define WIFI_STA 1
+#define WIFI_AP 2
+
+class WiFiClass
+{
+public:
+    bool mode(int m)
+    {
+        _mode = m;
+        return true;
+    }
+    int getMode() const { return _mode; }
+    uint8_t *macAddress(uint8_t *mac);
+    String macAddress();
+
+private:
+    int _mode = WIFI_OFF;
+};
+
+extern WiFiClass WiFi;
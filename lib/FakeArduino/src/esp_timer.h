@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+
+// The virtual clock (FakeHal.h), as esp_timer sees it
+int64_t esp_timer_get_time();
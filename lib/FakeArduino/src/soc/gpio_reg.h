@@ -0,0 +1,5 @@
+#pragma once
+
+// ESP32 addresses; a store sets / clears every GPIO 0..31 whose bit is 1 (fake::regWrite)
+#define GPIO_OUT_W1TS_REG 0x3FF44008u
+#define GPIO_OUT_W1TC_REG 0x3FF4400Cu
@@ -0,0 +1,10 @@
+#pragma once
+#include <stdint.h>
+
+// Register stores, as far as the drivers use them: GPIO set / clear (soc/gpio_reg.h)
+namespace fake
+{
+    void regWrite(uint32_t reg, uint32_t value);
+}
+
+#define REG_WRITE(reg, value) fake::regWrite((reg), (value))
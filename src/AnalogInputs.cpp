@@ -0,0 +1,177 @@
+#include "AnalogInputs.h"
+
+static const uint32_t SAMPLE_HZ = 20000; // lowest the ESP32 DMA ADC runs at; a frame takes 3.2 ms
+static const adc_atten_t ATTEN = ADC_ATTEN_DB_11; // ~0.15..3.1 V
+
+bool AnalogInputs::begin(uint8_t potPin, uint8_t battPin, uint16_t battRatioX100, uint16_t periodMs)
+{
+    const int8_t pot = digitalPinToAnalogChannel(potPin);
+    const int8_t batt = digitalPinToAnalogChannel(battPin);
+    if (pot < 0 || pot > 7 || batt < 0 || batt > 7)
+    {
+        Serial.println("analog: pot / battery must be ADC1 pins (GPIO 32..39)");
+        return false;
+    }
+    _potCh = pot;
+    _battCh = batt;
+    _battRatioX100 = battRatioX100;
+    _periodMs = periodMs;
+
+    adc_digi_init_config_t init{};
+    init.max_store_buf_size = FRAME_BYTES * 4;
+    init.conv_num_each_intr = FRAME_BYTES;
+    init.adc1_chan_mask = BIT(_potCh) | BIT(_battCh);
+    init.adc2_chan_mask = 0;
+    esp_err_t err = adc_digi_initialize(&init);
+    if (err != ESP_OK)
+    {
+        Serial.printf("analog: adc_digi_initialize failed: 0x%02X\n", err);
+        return false;
+    }
+
+    adc_digi_pattern_config_t pattern[2]{};
+    const uint8_t ch[2] = {_potCh, _battCh};
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        pattern[i].atten = ATTEN;
+        pattern[i].channel = ch[i];
+        pattern[i].unit = 0; // ADC1
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+    adc_digi_configuration_t cfg{};
+    cfg.conv_limit_en = 1; // required on the ESP32
+    cfg.conv_limit_num = 250;
+    cfg.pattern_num = 2;
+    cfg.adc_pattern = pattern;
+    cfg.sample_freq_hz = SAMPLE_HZ;
+    cfg.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    cfg.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    err = adc_digi_controller_configure(&cfg);
+    if (err != ESP_OK)
+    {
+        Serial.printf("analog: adc_digi_controller_configure failed: 0x%02X\n", err);
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    esp_adc_cal_characterize(ADC_UNIT_1, ATTEN, ADC_WIDTH_BIT_12, 1100, &_cal);
+
+    // below loop(): a late burst only delays a knob reading
+    if (xTaskCreate(&AnalogInputs::_taskFn, "analog", 3072, this, tskIDLE_PRIORITY + 1, &_task) != pdPASS)
+    {
+        Serial.println("analog: task create failed");
+        adc_digi_deinitialize();
+        return false;
+    }
+    return true;
+}
+
+void AnalogInputs::_taskFn(void *arg)
+{
+    AnalogInputs *self = static_cast<AnalogInputs *>(arg);
+    for (;;)
+    {
+        self->_burst();
+        vTaskDelay(pdMS_TO_TICKS(self->_periodMs));
+    }
+}
+
+void AnalogInputs::_burst()
+{
+    uint32_t sum[2] = {0, 0};
+    uint16_t n[2] = {0, 0};
+    uint8_t buf[FRAME_BYTES];
+    uint32_t len = 0;
+    uint32_t overflows = 0;
+
+    adc_digi_start();
+    esp_err_t err = adc_digi_read_bytes(buf, sizeof(buf), &len, 20);
+    adc_digi_stop();
+    bool got = err == ESP_OK || err == ESP_ERR_INVALID_STATE;
+    while (got)
+    {
+        if (err == ESP_ERR_INVALID_STATE) // the pool overflowed; the data is still valid
+            overflows++;
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= len; i += SOC_ADC_DIGI_RESULT_BYTES)
+        {
+            const adc_digi_output_data_t *p = reinterpret_cast<const adc_digi_output_data_t *>(&buf[i]);
+            const uint8_t c = p->type1.channel == _potCh ? 0 : p->type1.channel == _battCh ? 1 : 2;
+            if (c < 2)
+            {
+                sum[c] += p->type1.data;
+                n[c]++;
+            }
+        }
+        // frames completed between the read and the stop
+        err = adc_digi_read_bytes(buf, sizeof(buf), &len, 0);
+        got = err == ESP_OK || err == ESP_ERR_INVALID_STATE;
+    }
+
+    if (!n[0] || !n[1])
+    {
+        portENTER_CRITICAL(&_mux);
+        _stats.bursts++;
+        _stats.timeouts++;
+        _stats.overflows += overflows;
+        portEXIT_CRITICAL(&_mux);
+        return;
+    }
+
+    // average first, calibrate once per channel
+    _potFilter.add(esp_adc_cal_raw_to_voltage(sum[0] / n[0], &_cal));
+    _battFilter.add(esp_adc_cal_raw_to_voltage(sum[1] / n[1], &_cal) * _battRatioX100 / 100u);
+    const bool potNew = _potHyst.update(_potFilter.value());
+    const bool battNew = _battHyst.update(_battFilter.value());
+
+    const uint16_t mv = _potHyst.value();
+    const uint16_t clamped = mv < POT_MIN_MV ? POT_MIN_MV : mv > POT_MAX_MV ? POT_MAX_MV : mv;
+    const uint8_t pct = (uint8_t)((uint32_t)(clamped - POT_MIN_MV) * 100u / (POT_MAX_MV - POT_MIN_MV));
+
+    portENTER_CRITICAL(&_mux);
+    _potMv = mv;
+    _potNew |= potNew && (pct != _potPct || !_ready);
+    _potPct = pct;
+    _battMv = _battHyst.value();
+    _battNew |= battNew;
+    _ready = true;
+    _stats.bursts++;
+    _stats.samples += n[0] + n[1];
+    _stats.overflows += overflows;
+    portEXIT_CRITICAL(&_mux);
+}
+
+bool AnalogInputs::potChanged(uint8_t &pct)
+{
+    portENTER_CRITICAL(&_mux);
+    const bool changed = _potNew;
+    _potNew = false;
+    pct = _potPct;
+    portEXIT_CRITICAL(&_mux);
+    return changed;
+}
+
+bool AnalogInputs::batteryChanged(uint16_t &mv)
+{
+    portENTER_CRITICAL(&_mux);
+    const bool changed = _battNew;
+    _battNew = false;
+    mv = _battMv;
+    portEXIT_CRITICAL(&_mux);
+    return changed;
+}
+
+AnalogInputs::Stats AnalogInputs::stats() const
+{
+    portENTER_CRITICAL(&_mux);
+    Stats s = _stats;
+    portEXIT_CRITICAL(&_mux);
+    return s;
+}
+
+void AnalogInputs::printStats(Print &out) const
+{
+    const Stats s = stats();
+    out.printf("analog: pot=%u%% (%u mV) battery=%u mV (~%u%%) bursts=%lu samples=%lu overflows=%lu timeouts=%lu\n",
+               _potPct, _potMv, _battMv, batteryPct(), (unsigned long)s.bursts, (unsigned long)s.samples,
+               (unsigned long)s.overflows, (unsigned long)s.timeouts);
+}
@@ -0,0 +1,115 @@
+#include "Button.h"
+#include "Trace.h"
+#include <esp_sleep.h>
+
+bool Button::begin(uint8_t pin, const GestureCore::Config &cfg, WakeFn wake)
+{
+    _pin = pin;
+    _wake = wake;
+    pinMode(pin, INPUT_PULLUP);
+    const bool down = digitalRead(pin) == LOW;
+    _core.begin(cfg, down);
+
+    esp_timer_create_args_t a{};
+    a.callback = &Button::_onTimer;
+    a.arg = this;
+    a.name = "button";
+    if (esp_timer_create(&a, &_timer) != ESP_OK)
+    {
+        Serial.println("button: esp_timer_create failed");
+        return false;
+    }
+
+    // level interrupt on the level we wait for next; doubles as light-sleep wake source
+    esp_err_t err = gpio_install_isr_service(0);
+    if (err != ESP_OK && err != ESP_ERR_INVALID_STATE) // already installed (attachInterrupt)
+    {
+        Serial.printf("button: gpio_install_isr_service failed: 0x%02X\n", err);
+        return false;
+    }
+    gpio_wakeup_enable((gpio_num_t)pin, down ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+    gpio_isr_handler_add((gpio_num_t)pin, &Button::_isr, this);
+    esp_sleep_enable_gpio_wakeup();
+    return true;
+}
+
+void IRAM_ATTR Button::_isr(void *arg)
+{
+    Button *self = static_cast<Button *>(arg);
+    const bool down = gpio_get_level((gpio_num_t)self->_pin) == 0;
+    // wait for the other level next: one interrupt per edge, bounce included
+    gpio_wakeup_enable((gpio_num_t)self->_pin, down ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+
+    const uint32_t now = micros();
+    TRACE(Button, down, 0);
+    portENTER_CRITICAL_ISR(&self->_mux);
+    if (!self->_injected)
+        self->_core.onEdge(down, now);
+    portEXIT_CRITICAL_ISR(&self->_mux);
+    self->_arm(now);
+    if (self->_wake)
+        self->_wake(true);
+}
+
+void Button::_onTimer(void *arg)
+{
+    Button *self = static_cast<Button *>(arg);
+    const uint32_t now = micros();
+    portENTER_CRITICAL(&self->_mux);
+    const bool down = self->_injected || gpio_get_level((gpio_num_t)self->_pin) == 0;
+    self->_core.onTimer(now, down);
+    portEXIT_CRITICAL(&self->_mux);
+    self->_arm(now);
+    if (self->_wake)
+        self->_wake(false);
+}
+
+// (Re)arm the timer for the core's next deadline
+void Button::_arm(uint32_t nowUs)
+{
+    uint32_t due;
+    portENTER_CRITICAL_SAFE(&_mux);
+    bool have = _core.nextDeadline(due);
+    portEXIT_CRITICAL_SAFE(&_mux);
+    esp_timer_stop(_timer);
+    if (!have)
+        return;
+    int32_t wait = (int32_t)(due - nowUs);
+    esp_timer_start_once(_timer, wait > 0 ? (uint64_t)wait : 1);
+}
+
+bool Button::poll(GestureEvent &e)
+{
+    portENTER_CRITICAL(&_mux);
+    bool have = _core.pop(e);
+    portEXIT_CRITICAL(&_mux);
+    return have;
+}
+
+void Button::setLongMs(uint16_t ms)
+{
+    portENTER_CRITICAL(&_mux);
+    _core.setLongMs(ms);
+    portEXIT_CRITICAL(&_mux);
+    _arm(micros());
+}
+
+void Button::inject(bool down)
+{
+    const uint32_t now = micros();
+    portENTER_CRITICAL(&_mux);
+    _injected = down;
+    _core.onEdge(down, now);
+    portEXIT_CRITICAL(&_mux);
+    _arm(now);
+    if (_wake)
+        _wake(false);
+}
+
+GestureCore::Stats Button::stats() const
+{
+    portENTER_CRITICAL(&_mux);
+    GestureCore::Stats s = _core.stats();
+    portEXIT_CRITICAL(&_mux);
+    return s;
+}
@@ -1,4 +1,5 @@
 #include "Buzzer.h"
+#include "Trace.h"
 
 static const Note MEL_SCALE_UP[] = {
     {262, 200},
@@ -70,14 +71,6 @@ static const Note BOOT[] = {
     {523, 240},
 };
 
-static void copyMelody(std::vector<Note> &dst, const Note *src, size_t n)
-{
-    dst.clear();
-    dst.reserve(n);
-    for (size_t i = 0; i < n; i++)
-        dst.push_back(src[i]);
-}
-
 void Buzzer::init(uint8_t pin, uint8_t channel, uint8_t timer, uint8_t resolutionBits)
 {
     _pin = pin;
@@ -114,45 +107,52 @@ void Buzzer::setTempoFactor(float factor)
 
 void Buzzer::play(BuiltInMelody m, bool repeat)
 {
+    // played in place from flash: nothing copied, nothing allocated
     switch (m)
     {
     case BuiltInMelody::SCALE_UP:
-        copyMelody(_seq, MEL_SCALE_UP, sizeof(MEL_SCALE_UP) / sizeof(Note));
+        _set(MEL_SCALE_UP, sizeof(MEL_SCALE_UP) / sizeof(Note));
         break;
     case BuiltInMelody::SCALE_DOWN:
-        copyMelody(_seq, MEL_SCALE_DOWN, sizeof(MEL_SCALE_DOWN) / sizeof(Note));
+        _set(MEL_SCALE_DOWN, sizeof(MEL_SCALE_DOWN) / sizeof(Note));
         break;
     case BuiltInMelody::TWINKLE:
-        copyMelody(_seq, MEL_TWINKLE, sizeof(MEL_TWINKLE) / sizeof(Note));
+        _set(MEL_TWINKLE, sizeof(MEL_TWINKLE) / sizeof(Note));
         break;
     case BuiltInMelody::BEEP_BEEP:
-        copyMelody(_seq, MEL_BEEP_BEEP, sizeof(MEL_BEEP_BEEP) / sizeof(Note));
+        _set(MEL_BEEP_BEEP, sizeof(MEL_BEEP_BEEP) / sizeof(Note));
         break;
     case BuiltInMelody::BOOT:
-        copyMelody(_seq, BOOT, sizeof(BOOT) / sizeof(Note));
+        _set(BOOT, sizeof(BOOT) / sizeof(Note));
         break;
     }
-    _repeat = repeat;
-    _idx = 0;
-    _paused = false;
-    _playing = true;
-    _startIfNeeded();
+    _start(repeat);
 }
 
 void Buzzer::play(const std::vector<Note> &seq, bool repeat)
 {
     _seq = seq; // copy
-    _repeat = repeat;
-    _idx = 0;
-    _paused = false;
-    _playing = true;
-    _startIfNeeded();
+    _set(_seq.data(), _seq.size());
+    _start(repeat);
 }
 
 void Buzzer::beep(uint16_t freqHz, uint16_t durMs)
 {
-    _seq = {{freqHz, durMs}};
-    _repeat = false;
+    _beep = Note{freqHz, durMs};
+    _notes = &_beep;
+    _len = 1;
+    _start(false);
+}
+
+void Buzzer::_set(const Note *notes, size_t n)
+{
+    _notes = notes;
+    _len = (_maxNotes && n > _maxNotes) ? _maxNotes : n;
+}
+
+void Buzzer::_start(bool repeat)
+{
+    _repeat = repeat;
     _idx = 0;
     _paused = false;
     _playing = true;
@@ -164,7 +164,7 @@ void Buzzer::stop()
     _playing = false;
     _paused = false;
     _idx = 0;
-    _seq.clear();
+    _len = 0;
     _silence();
 }
 
@@ -189,12 +189,12 @@ void Buzzer::resume()
 
 void Buzzer::_startIfNeeded()
 {
-    if (!_playing || _paused || _seq.empty() || _idx >= _seq.size())
+    if (!_playing || _paused || !_len || _idx >= _len)
     {
         _silence();
         return;
     }
-    const Note &n = _seq[_idx];
+    const Note &n = _notes[_idx];
     _applyNote(n);
     _noteStartMs = millis();
     _curNoteDurMs = (uint32_t)(n.durMs * _tempo);
@@ -204,7 +204,7 @@ void Buzzer::_startIfNeeded()
 
 void Buzzer::update()
 {
-    if (!_playing || _paused || _seq.empty())
+    if (!_playing || _paused || !_len)
         return;
 
     uint32_t now = millis();
@@ -212,7 +212,7 @@ void Buzzer::update()
     {
         // advance to next note
         _idx++;
-        if (_idx >= _seq.size())
+        if (_idx >= _len)
         {
             if (_repeat)
             {
@@ -230,6 +230,7 @@ void Buzzer::update()
 
 void Buzzer::_applyNote(const Note &n)
 {
+    TRACE(Note, n.freq != 0, n.freq);
     if (n.freq == 0)
     {
         _silence();
@@ -238,6 +239,8 @@ void Buzzer::_applyNote(const Note &n)
     // Set frequency and duty
     ledcWriteTone(_channel, (double)n.freq);
     ledcWrite(_channel, _duty);
+    _toneUs = micros();
+    _tones++;
 }
 
 void Buzzer::_silence()
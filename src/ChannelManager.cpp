@@ -0,0 +1,418 @@
+#include "ChannelManager.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <esp_now.h>
+#include <Preferences.h>
+
+ChannelManager *ChannelManager::_self = nullptr;
+
+uint8_t ChannelManager::begin(ReliableLink &radio, const uint8_t peerMac[6], uint8_t rendezvousCh)
+{
+    _radio = &radio;
+    _rendezvousCh = rendezvousCh;
+
+    uint8_t ch = 0;
+    if (peerMac)
+    {
+        _setPeer(peerMac);
+        Preferences prefs;
+        prefs.begin("pair", true);
+        ch = prefs.getUChar("chan", 0);
+        prefs.end();
+    }
+
+    _cached = (ch >= 1 && ch <= NUM_CH);
+    if (!_cached)
+        ch = rendezvousCh;
+    _apply(ch);
+    _prevCh = ch;
+
+    Serial.printf("Channel %u (%s)\n", ch, _cached ? "cached" : "rendezvous");
+    return ch;
+}
+
+void ChannelManager::newPeer(const uint8_t peerMac[6])
+{
+    _stopSurvey();
+    _setPeer(peerMac);
+    _cached = false;
+    _state = State::Idle;
+    _nextSweepAt = millis();
+    _okCount = 0;
+
+    Preferences prefs;
+    prefs.begin("pair", false);
+    prefs.remove("chan");
+    prefs.end();
+
+    _apply(_rendezvousCh);
+}
+
+void ChannelManager::rendezvous()
+{
+    _stopSurvey();
+    _hasPeer = false;
+    _state = State::Idle;
+    _apply(_rendezvousCh);
+}
+
+void ChannelManager::_setPeer(const uint8_t peerMac[6])
+{
+    memcpy(_peer, peerMac, 6);
+    _hasPeer = true;
+
+    uint8_t me[6];
+    WiFi.macAddress(me);
+    _initiator = memcmp(me, _peer, 6) < 0;
+}
+
+void ChannelManager::onSent(bool ok)
+{
+    _history = (_history << 1) | (ok ? 1u : 0u);
+    if (_samples < 32)
+        _samples++;
+    if (ok)
+    {
+        _okCount++;
+        _failRun = 0;
+    }
+    else if (_failRun < 255)
+    {
+        _failRun++;
+    }
+}
+
+void ChannelManager::onPropose(uint8_t ch)
+{
+    if (ch >= 1 && ch <= NUM_CH)
+        _proposedCh = ch;
+}
+
+uint8_t ChannelManager::ackPercent() const
+{
+    uint8_t n = _samples;
+    if (n == 0)
+        return 100;
+    uint32_t mask = (n >= 32) ? 0xFFFFFFFFu : ((1u << n) - 1u);
+    return (uint8_t)(__builtin_popcount(_history & mask) * 100u / n);
+}
+
+void ChannelManager::update(uint32_t now)
+{
+    if (!_hasPeer)
+        return;
+
+    // Peer asked us to move (we already ACKed on the old channel)
+    uint8_t proposed = _proposedCh;
+    if (proposed)
+    {
+        _stopSurvey();
+        _proposedCh = 0;
+        _pendingCh = proposed;
+        _state = State::Switching;
+        _stateAt = now;
+    }
+
+    switch (_state)
+    {
+    case State::Idle:
+    {
+        // wrap-safe; a passed hold-off follows now, so it never ages into the other half
+        const bool due = (int32_t)(now - _nextSweepAt) >= 0;
+        if (due)
+            _nextSweepAt = now;
+        if (!_cached && _initiator && _okCount > 0 && due)
+        {
+            LOG_I("Channel: first pairing, surveying\n");
+            migrate();
+        }
+        else if (_failRun >= LOST_AFTER_FAILS && due)
+        {
+            LOG_I("Channel: peer lost, sweeping\n");
+            _prevCh = _ch;
+            _sweepIdx = 0;
+            _probes = 0;
+            _state = State::Sweeping;
+            _stateAt = now - 2 * PROBE_GAP_MS; // probe the first candidate right away
+        }
+        else if (_samples >= 32 && ackPercent() < _minAckPct && due)
+        {
+            LOG_I("Channel %u degraded (%u%% acked), migrating\n", _ch, ackPercent());
+            migrate();
+        }
+        break;
+    }
+
+    case State::Surveying:
+        if (now - _stateAt >= _dwellMs)
+            _surveyNext(now);
+        break;
+
+    case State::Proposing:
+    {
+        if (_radio->stats().sent != _proposeSent)
+        {
+            // superseded by application traffic: try again later
+            _state = State::Idle;
+            _nextSweepAt = now + 2000;
+            break;
+        }
+        ReliableLink::Result r = _radio->result();
+        if (r == ReliableLink::Result::Pending)
+            break;
+        // Failed may just mean our ACK got lost and the peer has moved: follow and verify
+        _prevCh = _ch;
+        _apply(_pendingCh);
+        _probes = 0;
+        _okAtStart = _okCount;
+        _state = State::Verifying;
+        _stateAt = now;
+        break;
+    }
+
+    case State::Switching:
+        // give the ACK (and ACKs for retransmitted proposals) time to leave on the old channel
+        if (now - _stateAt >= 30)
+        {
+            LOG_I("Channel: peer moved us %u -> %u\n", _ch, _pendingCh);
+            _prevCh = _ch;
+            _apply(_pendingCh);
+            _probes = 0;
+            _state = State::Confirming;
+            _stateAt = now;
+        }
+        break;
+
+    case State::Confirming:
+        // saved only once our own frames get through here: the proposer may still
+        // fail its verification and go back, and NVS must not keep us apart
+        if (now - _stateAt < (_probes ? PROBE_GAP_MS : CONFIRM_DELAY_MS))
+            break;
+        _stateAt = now;
+        if (_probes < VERIFY_PROBES)
+        {
+            if (!_probes)
+                _okAtStart = _okCount;
+            _sendProbe();
+            _probes++;
+            break;
+        }
+        if (_okCount - _okAtStart >= VERIFY_MIN_OK)
+        {
+            LOG_I("Channel %u confirmed (%lu/%u acked)\n", _ch, (unsigned long)(_okCount - _okAtStart), VERIFY_PROBES);
+            _save(_ch);
+            _history = 0; // fresh window for the degradation check
+            _samples = 0;
+        }
+        else
+        {
+            LOG_I("Channel %u not confirmed (%lu/%u acked), back to %u\n", _ch,
+                  (unsigned long)(_okCount - _okAtStart), VERIFY_PROBES, _prevCh);
+            _apply(_prevCh);
+        }
+        _state = State::Idle;
+        break;
+
+    case State::Verifying:
+        if (now - _stateAt < PROBE_GAP_MS)
+            break;
+        _stateAt = now;
+        if (_probes < VERIFY_PROBES)
+        {
+            _sendProbe();
+            _probes++;
+            break;
+        }
+        if (_okCount - _okAtStart >= VERIFY_MIN_OK)
+        {
+            LOG_I("Channel %u verified (%lu/%u acked)\n", _ch,
+                   (unsigned long)(_okCount - _okAtStart), VERIFY_PROBES);
+            _save(_ch);
+            _history = 0; // fresh window for the degradation check
+            _samples = 0;
+            _state = State::Idle;
+        }
+        else
+        {
+            // the peer is still where it answered before: propose the next candidate from there
+            LOG_I("Channel %u failed verification (%lu/%u acked), back to %u\n", _ch,
+                  (unsigned long)(_okCount - _okAtStart), VERIFY_PROBES, _prevCh);
+            _apply(_prevCh);
+            if (!_startNextCandidate())
+            {
+                LOG_I("Channel: no candidate verified, staying on %u\n", _ch);
+                _state = State::Idle;
+                _nextSweepAt = now + 5000;
+            }
+        }
+        break;
+
+    case State::Sweeping:
+        if (now - _stateAt < 2 * PROBE_GAP_MS)
+            break;
+        _stateAt = now;
+        if (_probes > 0 && _okCount != _okAtStart)
+        {
+            LOG_I("Channel: found peer on %u\n", _ch);
+            _save(_ch);
+            _state = State::Idle;
+            break;
+        }
+        if (_sweepIdx >= NUM_CH)
+        {
+            // not found: back to where we were, try again later (randomised to desync two sweepers)
+            _apply(_prevCh);
+            _state = State::Idle;
+            _nextSweepAt = now + 2000 + (esp_random() % 3000);
+            break;
+        }
+        _apply(++_sweepIdx);
+        _okAtStart = _okCount;
+        _sendProbe();
+        _probes = 1;
+        break;
+    }
+}
+
+void ChannelManager::migrate()
+{
+    _self = this;
+    wifi_promiscuous_filter_t filt{};
+    filt.filter_mask = WIFI_PROMIS_FILTER_MASK_ALL;
+    esp_wifi_set_promiscuous_filter(&filt);
+    esp_wifi_set_promiscuous_rx_cb(&ChannelManager::_sniff);
+    esp_wifi_set_promiscuous(true);
+
+    _surveyCh = 0;
+    _state = State::Surveying;
+    _surveyNext(millis());
+}
+
+bool ChannelManager::_startNextCandidate()
+{
+    if (_orderIdx >= _orderLen)
+        return false;
+    uint8_t c = _order[_orderIdx++];
+    _pendingCh = c;
+
+    if (c == _ch)
+    {
+        // best channel is the current one: just verify it
+        _prevCh = _ch;
+        _probes = 0;
+        _okAtStart = _okCount;
+        _state = State::Verifying;
+        _stateAt = millis();
+        return true;
+    }
+
+    LOG_I("Channel: proposing %u -> %u\n", _ch, c);
+    _radio->send(CMD_CHANNEL, ChannelBody{c});
+    _proposeSent = _radio->stats().sent;
+    _state = State::Proposing;
+    return true;
+}
+
+void ChannelManager::_sendProbe()
+{
+    // unicast: the MAC-level ack reported to onSent() tells whether the peer is here
+    _radio->sendOnce(CMD_PROBE);
+}
+
+// Scores the channel just dwelt on and tunes to the next one; after the last,
+// orders the candidates and proposes the best
+void ChannelManager::_surveyNext(uint32_t now)
+{
+    if (_surveyCh)
+    {
+        // foreign frames per dwell + noise floor above -96 dBm (2 points per dB)
+        int32_t noise = _noiseN ? (int32_t)(_noiseSum / (int32_t)_noiseN) : -96;
+        int32_t s = (int32_t)_frames + 2 * max<int32_t>(0, noise + 96);
+        _score[_surveyCh] = (uint16_t)min<int32_t>(s, 0xFFFF);
+        LOG_I("  ch %2u: %lu frames, noise %ld dBm -> %u\n", _surveyCh, (unsigned long)_frames, (long)noise,
+              _score[_surveyCh]);
+    }
+
+    if (_surveyCh < NUM_CH)
+    {
+        esp_wifi_set_channel(++_surveyCh, WIFI_SECOND_CHAN_NONE);
+        _frames = 0;
+        _noiseSum = 0;
+        _noiseN = 0;
+        _stateAt = now;
+        return;
+    }
+
+    _stopSurvey();
+
+    // candidates best first (insertion sort, 13 entries)
+    _orderLen = 0;
+    for (uint8_t c = 1; c <= NUM_CH; c++)
+    {
+        uint8_t i = _orderLen++;
+        while (i > 0 && _score[_order[i - 1]] > _score[c])
+        {
+            _order[i] = _order[i - 1];
+            i--;
+        }
+        _order[i] = c;
+    }
+    _orderIdx = 0;
+    if (!_startNextCandidate())
+        _state = State::Idle;
+}
+
+void ChannelManager::_stopSurvey()
+{
+    if (_state != State::Surveying)
+        return;
+    esp_wifi_set_promiscuous(false);
+    esp_wifi_set_promiscuous_rx_cb(nullptr);
+    _self = nullptr;
+    _apply(_ch);
+    _state = State::Idle;
+}
+
+void ChannelManager::_sniff(void *buf, wifi_promiscuous_pkt_type_t)
+{
+    ChannelManager *self = _self;
+    if (!self || !buf)
+        return;
+    const wifi_promiscuous_pkt_t *pkt = (const wifi_promiscuous_pkt_t *)buf;
+    self->_frames++;
+    self->_noiseSum += pkt->rx_ctrl.noise_floor;
+    self->_noiseN++;
+}
+
+void ChannelManager::_apply(uint8_t ch)
+{
+    // Set Wi-Fi primary channel (both ends must match)
+    esp_wifi_set_promiscuous(true);
+    esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE);
+    esp_wifi_set_promiscuous(false);
+    _ch = ch;
+
+    if (_hasPeer && esp_now_is_peer_exist(_peer))
+    {
+        esp_now_peer_info_t p{};
+        memcpy(p.peer_addr, _peer, 6);
+        p.channel = ch; // must match Wi-Fi channel
+        p.encrypt = false;
+        esp_now_mod_peer(&p);
+    }
+
+    // link statistics belong to the old channel
+    _history = 0;
+    _samples = 0;
+    _failRun = 0;
+}
+
+void ChannelManager::_save(uint8_t ch)
+{
+    _cached = true;
+    Preferences prefs;
+    prefs.begin("pair", false);
+    if (prefs.getUChar("chan", 0) != ch)
+        prefs.putUChar("chan", ch);
+    prefs.end();
+}
@@ -0,0 +1,227 @@
+#include "GroupLink.h"
+#include "Log.h"
+#include <WiFi.h>
+#include <esp_now.h>
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+static void ensurePeer(const uint8_t *mac)
+{
+    if (esp_now_is_peer_exist(mac))
+        return;
+    esp_now_peer_info_t p{};
+    memcpy(p.peer_addr, mac, 6);
+    p.channel = 0; // current channel
+    p.encrypt = false;
+    esp_now_add_peer(&p);
+}
+
+uint32_t GroupLink::_idFromMac(const uint8_t *mac)
+{
+    return ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5];
+}
+
+void GroupLink::init(TxQueue &tx, uint8_t groupId, bool wantAcks)
+{
+    _tx = &tx;
+    _group = groupId;
+    _wantAcks = wantAcks;
+    uint8_t me[6];
+    WiFi.macAddress(me);
+    _myId = _idFromMac(me);
+    _nextSeq = (uint16_t)esp_random();
+    _inFlight = false;
+    _ackPending = false;
+    _ackTail = _ackHead;
+    _relay = RelayCore<GroupMsg, 16, 4>();
+    _relay.setJitter(GroupPolicy::RELAY_JITTER_MS);
+    _relay.setSuppressAfter(GroupPolicy::RELAY_SUPPRESS);
+    _relay.setRetries(GroupPolicy::RELAY_RETRIES, GroupPolicy::RELAY_ECHO_MS);
+    if (_group)
+        ensurePeer(BROADCAST_MAC);
+}
+
+void GroupLink::setRelay(bool relay, uint8_t ttl)
+{
+    _relay.setEnabled(relay);
+    _ttl = ttl ? ttl : 1;
+}
+
+bool GroupLink::send(uint8_t inner, uint16_t leaseMs)
+{
+    if (!_group)
+        return false;
+
+    _msg = GroupMsg{_nextSeq++, (uint8_t)(_wantAcks ? MSG_FLAG_ACK_REQ : 0),
+                    GroupBody{_group, _myId, _ttl, inner, leaseMs}};
+    _acks.begin(_msg.seq);
+    _ackTail = _ackHead; // drop ACKs of older messages
+    _inFlight = true;
+    _attempts = 0;
+    _rtoMs = GroupPolicy::RTO_MS;
+    // nobody known yet (or no ACKs wanted): a few blind copies instead of ACK-driven retries
+    _maxAttempts = (_wantAcks && _acks.members() > 0) ? GroupPolicy::MAX_ATTEMPTS : GroupPolicy::BLIND_COPIES;
+    _firstTxUs = micros();
+    _stats.sent++;
+
+    _attempts++;
+    _nextTxMs = millis() + _rtoMs;
+    return _broadcast(_msg);
+}
+
+bool GroupLink::sendOnce(uint8_t inner, uint16_t leaseMs)
+{
+    if (!_group)
+        return false;
+    GroupMsg g{_nextSeq++, 0, GroupBody{_group, _myId, _ttl, inner, leaseMs}};
+    return _broadcast(g);
+}
+
+bool GroupLink::_broadcast(const GroupMsg &g)
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_GROUP, g.flags, g.seq, g.body);
+    _stats.frames++;
+    // our own messages supersede each other while queued; relayed ones never merge
+    uint16_t key = g.body.origin == _myId ? (uint16_t)CMD_GROUP : TxQueue::NO_COALESCE;
+    return _tx->send(BROADCAST_MAC, buf, (uint8_t)n, key);
+}
+
+void GroupLink::update()
+{
+    // jittered ACK for the last group message we received
+    if (_ackPending && (int32_t)(millis() - _ackAtMs) >= 0)
+    {
+        uint8_t buf[Proto::MAX_FRAME];
+        size_t n = Proto::encode(buf, CMD_GROUP_ACK, 0, _ackSeq, GroupAckBody{_group, _myId});
+        ensurePeer(_ackTo);
+        _ackConfirmed = false;
+        memcpy(_ackSentTo, _ackTo, 6);
+        _ackSentOrigin = _ackOrigin;
+        _ackSentSeq = _ackSeq;
+        _tx->send(_ackTo, buf, (uint8_t)n, CMD_GROUP_ACK);
+        _stats.acksTx++;
+        _ackPending = false;
+    }
+
+    // rebroadcasts for other senders whose jitter has elapsed
+    for (;;)
+    {
+        RelayCore<GroupMsg, 16, 4>::Out o;
+        if (!_relay.poll(millis(), o))
+            break;
+        o.frame.body.ttl = o.ttl;
+        o.frame.flags |= MSG_FLAG_RELAYED;
+        _stats.relayed++;
+        _broadcast(o.frame);
+    }
+
+    if (!_inFlight)
+        return;
+
+    while (_ackTail != _ackHead)
+    {
+        const AckIn &a = _ackQ[_ackTail];
+        if (_acks.ack(a.id, a.seq))
+        {
+            _stats.acksRx++;
+            _stats.lastLatencyUs = a.us - _firstTxUs;
+        }
+        _ackTail = (uint8_t)((_ackTail + 1) % ACK_Q);
+    }
+    if (_acks.complete())
+    {
+        _finish(true);
+        return;
+    }
+
+    if ((int32_t)(millis() - _nextTxMs) >= 0)
+    {
+        if (_attempts >= _maxAttempts)
+        {
+            _finish(!_wantAcks || _acks.complete());
+            return;
+        }
+        _attempts++;
+        uint32_t rto = (uint32_t)_rtoMs * 2u;
+        _rtoMs = (rto > GroupPolicy::RTO_MAX_MS) ? GroupPolicy::RTO_MAX_MS : (uint16_t)rto;
+        _nextTxMs = millis() + _rtoMs;
+        _broadcast(_msg);
+    }
+}
+
+void GroupLink::_finish(bool complete)
+{
+    _inFlight = false;
+    if (complete)
+        _stats.complete++;
+    else
+        _stats.incomplete++;
+    if (_wantAcks)
+        LOG_I("group seq %u: %u/%u members acked after %u tx\n",
+              _msg.seq, _acks.acked(), _acks.members(), _attempts);
+}
+
+bool GroupLink::onRecv(const uint8_t *srcMac, const Proto::Frame &f, GroupMsg &out)
+{
+    if (!_group)
+        return false;
+
+    if (const GroupAckBody *a = f.body<GroupAckBody>())
+    {
+        if (a->group != _group || a->member == _myId)
+            return false;
+        uint8_t next = (uint8_t)((_ackHead + 1) % ACK_Q);
+        if (next != _ackTail) // full: the sender just retransmits and the member re-ACKs
+        {
+            _ackQ[_ackHead] = AckIn{a->member, f.seq(), micros()};
+            _ackHead = next;
+        }
+        return false;
+    }
+
+    const GroupBody *b = f.body<GroupBody>();
+    if (!b || b->group != _group || b->origin == _myId)
+        return false;
+    GroupMsg g{f.seq(), f.flags(), *b};
+
+    bool fresh = _relay.onFrame(g.body.origin, g.seq, g.body.ttl, g, millis(), esp_random());
+
+    // a rebroadcast means somebody's ACK is missing; skip ours if the sender's radio confirmed it.
+    // Relayed copies are not ACKed: srcMac is the relay, not the origin.
+    bool confirmed = _ackConfirmed && _ackSentOrigin == g.body.origin && _ackSentSeq == g.seq;
+    if ((g.flags & MSG_FLAG_ACK_REQ) && !(g.flags & MSG_FLAG_RELAYED) && !_ackPending && !confirmed)
+    {
+        memcpy(_ackTo, srcMac, 6);
+        _ackOrigin = g.body.origin;
+        _ackSeq = g.seq;
+        _ackAtMs = millis() + (esp_random() % (GroupPolicy::ACK_JITTER_MS + 1));
+        _ackPending = true;
+    }
+    if (!fresh)
+    {
+        _stats.duplicates++;
+        return false;
+    }
+    out = g;
+    return true;
+}
+
+void GroupLink::onSent(const uint8_t *dstMac, bool ok)
+{
+    if (ok && memcmp(dstMac, _ackSentTo, 6) == 0)
+        _ackConfirmed = true;
+}
+
+void GroupLink::printStats(Print &out) const
+{
+    out.printf("group %u: id=%08lX members=%u sent=%lu frames=%lu complete=%lu incomplete=%lu\n",
+               _group, (unsigned long)_myId, _acks.members(), (unsigned long)_stats.sent,
+               (unsigned long)_stats.frames, (unsigned long)_stats.complete, (unsigned long)_stats.incomplete);
+    out.printf("group: acks rx=%lu tx=%lu dup=%lu last latency=%lu us\n",
+               (unsigned long)_stats.acksRx, (unsigned long)_stats.acksTx,
+               (unsigned long)_stats.duplicates, (unsigned long)_stats.lastLatencyUs);
+    if (isRelay())
+        out.printf("group: relay ttl=%u relayed=%lu suppressed=%lu\n", _ttl,
+                   (unsigned long)_stats.relayed, (unsigned long)_relay.stats().suppressed);
+}
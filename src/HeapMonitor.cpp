@@ -0,0 +1,123 @@
+#include "HeapMonitor.h"
+#include "Log.h"
+#include <new>
+
+void HeapMonitor::printHeap(Print &out)
+{
+    const uint32_t free = ESP.getFreeHeap();
+    const uint32_t largest = ESP.getMaxAllocHeap();
+    out.printf("heap: free %lu B, low-water %lu B, largest block %lu B (%lu%% fragmented)\n", (unsigned long)free,
+               (unsigned long)ESP.getMinFreeHeap(), (unsigned long)largest,
+               (unsigned long)(free ? 100 - (uint64_t)largest * 100 / free : 0));
+}
+
+#if HEAP_ACCOUNTING
+
+// Constant-initialized (no constructor runs): static constructors may allocate before it would
+HeapMonitor::Core HeapMonitor::_core;
+TaskHandle_t HeapMonitor::_loopTask = nullptr;
+
+void HeapMonitor::begin(uint32_t armAfterMs)
+{
+    _core.start();
+    _loopTask = xTaskGetCurrentTaskHandle(); // setup() runs in the loop task
+    _core.arm(millis() + armAfterMs);
+}
+
+void HeapMonitor::onAlloc(size_t size, void *caller)
+{
+    const bool loopTask = !_loopTask || xTaskGetCurrentTaskHandle() == _loopTask;
+    const uint8_t slot = loopTask ? _core.current() : (uint8_t)Core::TASKS;
+    if (_core.onAlloc(slot, size, (uintptr_t)caller, millis()) && _core.violations() <= Core::KEPT)
+        LOG_W("heap: %u B allocated in steady state (%s), caller %p\n", (unsigned)size, _core.name(slot), caller);
+}
+
+void HeapMonitor::printReport(Print &out)
+{
+    _core.disarm(); // the report's own printf() may allocate
+    printHeap(out);
+    out.printf("heap: %lu allocations, %lu frees since boot\n", (unsigned long)_core.totalAllocs(),
+               (unsigned long)_core.frees());
+    for (uint8_t i = 0; i < _core.slots(); i++)
+        if (_core.allocs(i))
+            out.printf("heap: %-10s %7lu allocs %9lu B\n", _core.name(i), (unsigned long)_core.allocs(i),
+                       (unsigned long)_core.bytes(i));
+    out.printf("heap: steady state from %lu ms: %lu allocations in loop()\n", (unsigned long)_core.armedAt(),
+               (unsigned long)_core.violations());
+    for (uint8_t i = 0; i < _core.keptViolations(); i++)
+    {
+        const Core::Violation &v = _core.violation(i);
+        out.printf("heap: #%u %lu B in %s, caller 0x%08lx at %lu ms\n", i + 1, (unsigned long)v.size,
+                   _core.name(v.slot), (unsigned long)v.caller, (unsigned long)v.ms);
+    }
+    _core.arm(millis());
+}
+
+// ---- Wrappers: -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc,--wrap=free ----
+extern "C"
+{
+    void *__real_malloc(size_t size);
+    void *__real_calloc(size_t n, size_t size);
+    void *__real_realloc(void *p, size_t size);
+    void __real_free(void *p);
+
+    void *__wrap_malloc(size_t size)
+    {
+        HeapMonitor::onAlloc(size, __builtin_return_address(0));
+        return __real_malloc(size);
+    }
+
+    void *__wrap_calloc(size_t n, size_t size)
+    {
+        HeapMonitor::onAlloc(n * size, __builtin_return_address(0));
+        return __real_calloc(n, size);
+    }
+
+    // Growing a String goes through here: counted as an allocation even when the block grows in place
+    void *__wrap_realloc(void *p, size_t size)
+    {
+        if (size)
+            HeapMonitor::onAlloc(size, __builtin_return_address(0));
+        else if (p)
+            HeapMonitor::onFree();
+        return __real_realloc(p, size);
+    }
+
+    void __wrap_free(void *p)
+    {
+        if (p)
+            HeapMonitor::onFree();
+        __real_free(p);
+    }
+}
+
+// ---- operator new / delete: same counters, the caller is the code that said new ----
+static void *heapNew(size_t size, void *caller)
+{
+    HeapMonitor::onAlloc(size, caller);
+    return __real_malloc(size ? size : 1);
+}
+
+void *operator new(size_t size)
+{
+    void *p = heapNew(size, __builtin_return_address(0));
+    if (!p)
+        std::__throw_bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t size)
+{
+    void *p = heapNew(size, __builtin_return_address(0));
+    if (!p)
+        std::__throw_bad_alloc();
+    return p;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return heapNew(size, __builtin_return_address(0)); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return heapNew(size, __builtin_return_address(0)); }
+
+void operator delete(void *p) noexcept { __wrap_free(p); }
+void operator delete[](void *p) noexcept { __wrap_free(p); }
+
+#endif
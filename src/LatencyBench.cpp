@@ -0,0 +1,284 @@
+#include "LatencyBench.h"
+
+static const char *const STAGE_NAMES[] = {"button->send", "send->sent", "button->rx", "rx->tone", "button->tone"};
+
+void LatencyBench::begin(TxQueue &tx, Buzzer &buzz)
+{
+    _tx = &tx;
+    _buzz = &buzz;
+    esp_timer_create_args_t a{};
+    a.callback = &LatencyBench::_onPressTimer;
+    a.arg = this;
+    a.name = "bench";
+    if (esp_timer_create(&a, &_timer) != ESP_OK)
+        Serial.println("bench: esp_timer_create failed");
+}
+
+void LatencyBench::setPeer(const uint8_t *peerMac)
+{
+    _hasPeer = peerMac != nullptr;
+    if (_hasPeer)
+        memcpy(_peer, peerMac, 6);
+    _sync.clear();
+}
+
+void LatencyBench::start(uint16_t presses, uint16_t holdMs)
+{
+    if (!_hasPeer || !_timer || !_press)
+    {
+        Serial.println("bench: needs a paired peer and a press function");
+        return;
+    }
+    for (uint8_t i = 0; i < (uint8_t)Stage::Count; i++)
+        _hist[i].clear();
+    _presses = _reports = _noReport = _noSent = _noTone = 0;
+    _pressesLeft = presses;
+    _holdMs = holdMs;
+    _syncLeft = SYNC_AT_START;
+    _sync.clear();
+    Serial.printf("bench: %u presses, %u ms each\n", presses, holdMs);
+    _sendSync();
+}
+
+void LatencyBench::stop()
+{
+    if (_timer)
+        esp_timer_stop(_timer);
+    if (_down)
+        _press(false);
+    _down = false;
+    _awaitTx = false;
+    _awaitSent = false;
+    _state = State::Idle;
+}
+
+void LatencyBench::_onPressTimer(void *arg)
+{
+    LatencyBench *self = static_cast<LatencyBench *>(arg);
+    self->_edgeUs = (uint32_t)esp_timer_get_time(); // same clock as micros()
+    self->_haveReport = false;
+    self->_awaitTx = true;
+    self->_down = true;
+    self->_press(true);
+}
+
+void LatencyBench::_send(const BenchBody &b)
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_BENCH, MSG_FLAG_NOACK, b.id, b);
+    _tx->send(_peer, buf, (uint8_t)n, CMD_BENCH);
+}
+
+void LatencyBench::_sendSync()
+{
+    BenchBody b{};
+    b.op = BENCH_SYNC;
+    b.id = ++_syncId;
+    b.us[0] = micros();
+    _send(b);
+    _state = State::Sync;
+    _stateAt = millis();
+}
+
+void LatencyBench::onTx(const uint8_t *data, uint8_t len)
+{
+    if (!_awaitTx)
+        return;
+    Proto::Frame f;
+    if (Proto::parse(data, len, f) != Proto::Status::Ok || f.type() != CMD_START)
+        return;
+    _txUs = micros();
+    _startSeq = f.seq();
+    _awaitTx = false;
+    _awaitSent = true; // one frame in flight per peer: the next completion is this one
+}
+
+void LatencyBench::onSent(const uint8_t *mac)
+{
+    if (_awaitSent && memcmp(mac, _peer, 6) == 0)
+    {
+        _sentUs = micros();
+        _awaitSent = false;
+    }
+}
+
+bool LatencyBench::onRecv(const uint8_t *srcMac, const Proto::Frame &f, uint32_t atUs)
+{
+    const BenchBody *b = f.body<BenchBody>();
+    if (!b)
+        return false;
+
+    switch (b->op)
+    {
+    case BENCH_SYNC: // receiver side
+    {
+        BenchBody r = *b;
+        r.op = BENCH_SYNC_ACK;
+        r.us[1] = atUs;
+        r.us[2] = micros();
+        if (!_hasPeer || memcmp(srcMac, _peer, 6) != 0)
+            return true;
+        _send(r);
+        _syncSeenAt = millis();
+        _responder = true;
+        break;
+    }
+    case BENCH_SYNC_ACK:
+        if (_state == State::Sync && b->id == _syncId)
+        {
+            _sync.add(b->us[0], b->us[1], b->us[2], atUs);
+            if (_syncLeft)
+                _syncLeft--;
+            if (_syncLeft)
+                _sendSync();
+            else
+            {
+                // random phase to loop(), so the edge is not aligned with the polling
+                esp_timer_start_once(_timer, 1000 + esp_random() % 10000);
+                _state = State::Armed;
+                _stateAt = millis();
+            }
+        }
+        break;
+    case BENCH_REPORT: // usually arrives while the button is still held
+        if ((_state == State::Held || _state == State::Wait) && !_awaitTx && b->id == _startSeq)
+        {
+            _report = *b;
+            _haveReport = true;
+        }
+        break;
+    }
+    return true;
+}
+
+void LatencyBench::onRxStart(uint16_t seq, uint32_t atUs)
+{
+    if (!_responder)
+        return;
+    _reportPending = true;
+    _rxSeq = seq;
+    _rxUs = atUs;
+    _rxAt = millis();
+    _tonesAtRx = _buzz->tones();
+}
+
+void LatencyBench::_record(Stage s, int32_t us)
+{
+    _hist[(uint8_t)s].add(us > 0 ? (uint32_t)us : 0); // a negative one-way time is offset error
+}
+
+void LatencyBench::_finishPress(const BenchBody *report)
+{
+    _presses++;
+    if (_awaitTx)
+    {
+        _noReport++; // START never left (no peer, lease already running...)
+    }
+    else
+    {
+        _record(Stage::ButtonToSend, (int32_t)(_txUs - _edgeUs));
+        if (_awaitSent)
+            _noSent++;
+        else
+            _record(Stage::SendToSent, (int32_t)(_sentUs - _txUs));
+        if (!report)
+        {
+            _noReport++;
+        }
+        else
+        {
+            _reports++;
+            int32_t off = _sync.offset();
+            _record(Stage::ButtonToRx, (int32_t)(report->us[0] - (uint32_t)off - _edgeUs));
+            if (!report->us[1])
+                _noTone++;
+            else
+            {
+                _record(Stage::RxToTone, (int32_t)(report->us[1] - report->us[0]));
+                _record(Stage::ButtonToTone, (int32_t)(report->us[1] - (uint32_t)off - _edgeUs));
+            }
+        }
+    }
+    _awaitTx = false;
+    _awaitSent = false;
+    _haveReport = false;
+    _state = State::Gap;
+    _stateAt = millis();
+}
+
+void LatencyBench::update(uint32_t now)
+{
+    // Receiver: report once the tone is out (or without one)
+    if (_responder && now - _syncSeenAt > RESPONDER_MS)
+        _responder = false;
+    if (_reportPending && (_buzz->tones() != _tonesAtRx || now - _rxAt > REPORT_TIMEOUT_MS / 2))
+    {
+        _reportPending = false;
+        BenchBody r{};
+        r.op = BENCH_REPORT;
+        r.id = _rxSeq;
+        r.us[0] = _rxUs;
+        r.us[1] = _buzz->tones() != _tonesAtRx ? _buzz->lastToneUs() : 0;
+        _send(r);
+    }
+
+    // Sender
+    switch (_state)
+    {
+    case State::Idle:
+        break;
+    case State::Sync:
+        if (now - _stateAt >= SYNC_TIMEOUT_MS)
+            _sendSync(); // lost, try again
+        break;
+    case State::Armed:
+        if (_down)
+        {
+            _state = State::Held;
+            _stateAt = now;
+        }
+        break;
+    case State::Held:
+        if (now - _stateAt >= _holdMs)
+        {
+            _down = false;
+            _press(false);
+            _state = State::Wait;
+            _stateAt = now;
+        }
+        break;
+    case State::Wait:
+        if (_haveReport)
+            _finishPress(&_report);
+        else if (now - _stateAt >= REPORT_TIMEOUT_MS)
+            _finishPress(nullptr);
+        break;
+    case State::Gap: // let the receiver's signal end before the next press
+        if (now - _stateAt < 300)
+            break;
+        if (!_pressesLeft || !--_pressesLeft)
+        {
+            _state = State::Idle;
+            printReport(Serial);
+            break;
+        }
+        _syncLeft = 1;
+        _sendSync();
+        break;
+    }
+}
+
+void LatencyBench::printReport(Print &out) const
+{
+    out.printf("bench: presses=%lu reported=%lu no-report=%lu no-sent=%lu no-tone=%lu, clock offset=%ld us (sync rtt %lu us)\n",
+               (unsigned long)_presses, (unsigned long)_reports, (unsigned long)_noReport, (unsigned long)_noSent,
+               (unsigned long)_noTone, (long)_sync.offset(), (unsigned long)_sync.rtt());
+    out.printf("bench: %-13s %6s %8s %8s %8s %8s (us)\n", "stage", "n", "min", "p50", "p99", "max");
+    for (uint8_t i = 0; i < (uint8_t)Stage::Count; i++)
+    {
+        const Hist &h = _hist[i];
+        out.printf("bench: %-13s %6lu %8lu %8lu %8lu %8lu\n", STAGE_NAMES[i], (unsigned long)h.count(),
+                   (unsigned long)h.min(), (unsigned long)h.percentile(50), (unsigned long)h.percentile(99),
+                   (unsigned long)h.max());
+    }
+}
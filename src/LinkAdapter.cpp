@@ -0,0 +1,130 @@
+#include "LinkAdapter.h"
+#include "Log.h"
+#include <Preferences.h>
+
+// cheapest first; 4 = stack default
+const LinkAdapter::Level LinkAdapter::LADDER[LinkAdapter::LEVELS] = {
+    {WIFI_PHY_RATE_24M, 8, "24M 2dBm"},
+    {WIFI_PHY_RATE_24M, 34, "24M 8.5dBm"},
+    {WIFI_PHY_RATE_12M, 52, "12M 13dBm"},
+    {WIFI_PHY_RATE_6M, 68, "6M 17dBm"},
+    {WIFI_PHY_RATE_1M_L, 78, "1M 19.5dBm"},
+    {WIFI_PHY_RATE_LORA_500K, 80, "LR500k 20dBm"},
+    {WIFI_PHY_RATE_LORA_250K, 80, "LR250k 20dBm"},
+};
+
+void LinkAdapter::begin(uint8_t targetPct)
+{
+    _targetPct = targetPct;
+    esp_err_t err = esp_wifi_set_protocol(WIFI_IF_STA, WIFI_PROTOCOL_11B | WIFI_PROTOCOL_11G |
+                                                           WIFI_PROTOCOL_11N | WIFI_PROTOCOL_LR);
+    if (err != ESP_OK)
+        Serial.printf("adapt: esp_wifi_set_protocol failed: 0x%02X\n", err);
+    AdaptCore<LEVELS>::Config cfg;
+    cfg.targetPct = _targetPct;
+    _core.begin(DEFAULT_LEVEL, cfg);
+    _apply(DEFAULT_LEVEL);
+}
+
+void LinkAdapter::_key(char out[14]) const
+{
+    snprintf(out, 14, "l%02x%02x%02x%02x%02x%02x", _peer[0], _peer[1], _peer[2], _peer[3], _peer[4], _peer[5]);
+}
+
+void LinkAdapter::setPeer(const uint8_t *peerMac)
+{
+    _hasPeer = peerMac != nullptr;
+    uint8_t level = DEFAULT_LEVEL;
+    _saved = 0xFF;
+    if (_hasPeer)
+    {
+        memcpy(_peer, peerMac, 6);
+        char key[14];
+        _key(key);
+        Preferences prefs;
+        prefs.begin("link", true);
+        _saved = prefs.getUChar(key, 0xFF);
+        prefs.end();
+        if (_saved < LEVELS)
+            level = _saved;
+    }
+    AdaptCore<LEVELS>::Config cfg;
+    cfg.targetPct = _targetPct;
+    _core.begin(level, cfg);
+    portENTER_CRITICAL(&_mux);
+    _nBits = 0;
+    portEXIT_CRITICAL(&_mux);
+    _apply(level);
+    _changedAt = millis();
+}
+
+void LinkAdapter::onSent(bool ok)
+{
+    portENTER_CRITICAL(&_mux);
+    if (_nBits < 32)
+    {
+        _bits = (_bits << 1) | (ok ? 1u : 0u);
+        _nBits++;
+    }
+    else
+        _dropped++;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void LinkAdapter::update(uint32_t now)
+{
+    portENTER_CRITICAL(&_mux);
+    uint32_t bits = _bits;
+    uint8_t n = _nBits;
+    _nBits = 0;
+    portEXIT_CRITICAL(&_mux);
+
+    bool changed = false;
+    for (int i = n - 1; i >= 0; i--) // oldest first
+    {
+        bool ok = (bits >> i) & 1u;
+        uint8_t l = _core.level();
+        ok ? _ok[l]++ : _fail[l]++;
+        changed |= _core.onResult(ok);
+    }
+    if (changed)
+    {
+        _apply(_core.level());
+        _changedAt = now;
+    }
+
+    // persist a level that held for a while (NVS writes wear the flash)
+    if (_hasPeer && _core.level() != _saved && !_core.isProbing() && now - _changedAt >= SAVE_AFTER_MS)
+    {
+        char key[14];
+        _key(key);
+        Preferences prefs;
+        prefs.begin("link", false);
+        prefs.putUChar(key, _core.level());
+        prefs.end();
+        _saved = _core.level();
+    }
+}
+
+void LinkAdapter::_apply(uint8_t level)
+{
+    const Level &l = LADDER[level];
+    esp_err_t err = esp_wifi_config_espnow_rate(WIFI_IF_STA, l.rate);
+    if (err != ESP_OK)
+        LOG_W("adapt: esp_wifi_config_espnow_rate failed: 0x%02X\n", err);
+    err = esp_wifi_set_max_tx_power(l.powerQdBm);
+    if (err != ESP_OK)
+        LOG_W("adapt: esp_wifi_set_max_tx_power failed: 0x%02X\n", err);
+}
+
+void LinkAdapter::printStats(Print &out) const
+{
+    out.printf("adapt: level %u/%u (%s)%s target=%u%% ups=%lu downs=%lu failed probes=%lu saved=%d\n",
+               _core.level(), LEVELS - 1, current().name, _core.isProbing() ? " probing" : "", _targetPct,
+               (unsigned long)_core.stats().ups, (unsigned long)_core.stats().downs,
+               (unsigned long)_core.stats().failedProbes, _saved < LEVELS ? _saved : -1);
+    for (uint8_t i = 0; i < LEVELS; i++)
+        if (_ok[i] || _fail[i])
+            out.printf("adapt:   %-13s ok=%lu fail=%lu (%lu%%)\n", LADDER[i].name, (unsigned long)_ok[i],
+                       (unsigned long)_fail[i], (unsigned long)(_ok[i] * 100u / (_ok[i] + _fail[i])));
+}
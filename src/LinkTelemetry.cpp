@@ -0,0 +1,188 @@
+#include "LinkTelemetry.h"
+
+void LinkTelemetry::begin(TxQueue &tx, uint16_t pingMs, uint16_t pingTimeoutMs)
+{
+    _tx = &tx;
+    _pingMs = pingMs;
+    _pingTimeoutMs = pingTimeoutMs;
+    _pingSeq = (uint16_t)esp_random();
+    _pingPending = false;
+}
+
+void LinkTelemetry::setPeer(const uint8_t *peerMac)
+{
+    _pingPending = false;
+    _window.clear();
+    _hasPeer = peerMac != nullptr;
+    if (_hasPeer)
+        memcpy(_peer, peerMac, 6);
+    portENTER_CRITICAL(&_mux);
+    _peers.pin(peerMac); // onSent() only counts peers already in the table; strangers never evict this one
+    portEXIT_CRITICAL(&_mux);
+    _nextPingAt = millis();
+}
+
+void LinkTelemetry::setPingPeriod(uint16_t ms)
+{
+    if (ms && !_pingMs)
+        _nextPingAt = millis();
+    _pingMs = ms;
+}
+
+void LinkTelemetry::onSent(const uint8_t *mac, bool ok)
+{
+    uint32_t now = millis();
+    portENTER_CRITICAL(&_mux);
+    if (PeerLink *p = _peers.find(mac))
+        p->onSent(ok, now);
+    portEXIT_CRITICAL(&_mux);
+}
+
+void LinkTelemetry::onRx(const uint8_t *mac, int8_t rssi)
+{
+    uint32_t now = millis();
+    portENTER_CRITICAL(&_mux);
+    _peers.find(mac, true)->onRx(rssi, now);
+    portEXIT_CRITICAL(&_mux);
+}
+
+bool LinkTelemetry::onRecv(const uint8_t *srcMac, const Proto::Frame &f, uint32_t atUs)
+{
+    const PingBody *b = f.body<PingBody>();
+    if (!b)
+        return false;
+
+    if (f.type() == CMD_PING)
+    {
+        PingBody pong{b->sentUs, 0};
+        portENTER_CRITICAL(&_mux);
+        if (const PeerLink *p = _peers.find(srcMac))
+            pong.rssi = p->rssi; // onRx() ran for this PING just before
+        portEXIT_CRITICAL(&_mux);
+        uint8_t buf[Proto::MAX_FRAME];
+        size_t n = Proto::encode(buf, CMD_PONG, MSG_FLAG_NOACK, f.seq(), pong);
+        _tx->send(srcMac, buf, (uint8_t)n, CMD_PONG);
+        return true;
+    }
+
+    // CMD_PONG
+    if (!_hasPeer || memcmp(srcMac, _peer, 6) != 0)
+        return true;
+    if (!_pingPending || f.seq() != _pingSeq)
+    {
+        _rtt.late++;
+        return true;
+    }
+    _pingPending = false;
+    uint32_t us = atUs - b->sentUs;
+    _window.add(us);
+    _rtt.pongs++;
+    if (us > _rtt.maxUs)
+        _rtt.maxUs = us;
+    _rtt.peerRssi = b->rssi;
+    return true;
+}
+
+void LinkTelemetry::_sendPing(uint32_t now)
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_PING, MSG_FLAG_NOACK, ++_pingSeq, PingBody{micros(), 0});
+    if (!_tx->send(_peer, buf, (uint8_t)n, CMD_PING))
+        return;
+    _pingPending = true;
+    _pingAt = now;
+    _rtt.pings++;
+}
+
+void LinkTelemetry::update(uint32_t now)
+{
+    if (_pingPending && now - _pingAt >= _pingTimeoutMs)
+    {
+        _pingPending = false;
+        _rtt.lost++;
+    }
+    if (!_tx || !_hasPeer || !_pingMs || _pingPending || (int32_t)(now - _nextPingAt) < 0)
+        return;
+    _nextPingAt = now + _pingMs;
+    _sendPing(now);
+}
+
+LinkTelemetry::Rtt LinkTelemetry::rtt() const
+{
+    Rtt r = _rtt;
+    r.p50Us = _window.percentile(50);
+    r.p90Us = _window.percentile(90);
+    r.p99Us = _window.percentile(99);
+    return r;
+}
+
+bool LinkTelemetry::peer(const uint8_t *mac, PeerLink &out) const
+{
+    portENTER_CRITICAL(&_mux);
+    const PeerLink *p = _peers.find(mac);
+    if (p)
+        out = *p;
+    portEXIT_CRITICAL(&_mux);
+    return p != nullptr;
+}
+
+bool LinkTelemetry::render(SevenSegmentText &disp) const
+{
+    if (_view == View::Off)
+        return false;
+    PeerLink p;
+    bool known = _hasPeer && peer(_peer, p);
+    int v = -1;
+    switch (_view)
+    {
+    case View::Rssi:
+        if (known && p.rssiFrames)
+            v = -p.rssiAvg();
+        break;
+    case View::RttMs:
+        if (_window.count())
+            v = (int)(_window.percentile(50) / 1000u);
+        break;
+    case View::Loss:
+        if (known && p.samples)
+            v = p.lossPercent();
+        break;
+    case View::Off:
+    case View::Count:
+        break;
+    }
+    char s[3] = {'-', '-', 0};
+    if (v > 99)
+        s[0] = 'H', s[1] = 'I';
+    else if (v >= 0)
+        s[0] = v >= 10 ? (char)('0' + v / 10) : ' ', s[1] = (char)('0' + v % 10);
+    disp.setString(s);
+    return true;
+}
+
+void LinkTelemetry::printStats(Print &out) const
+{
+    Rtt r = rtt();
+    out.printf("telemetry: ping sent=%lu pong=%lu lost=%lu late=%lu, rtt us p50=%lu p90=%lu p99=%lu max=%lu\n",
+               (unsigned long)r.pings, (unsigned long)r.pongs, (unsigned long)r.lost, (unsigned long)r.late,
+               (unsigned long)r.p50Us, (unsigned long)r.p90Us, (unsigned long)r.p99Us, (unsigned long)r.maxUs);
+    for (size_t i = 0;; i++)
+    {
+        PeerLink p;
+        portENTER_CRITICAL(&_mux);
+        bool have = i < _peers.size();
+        if (have)
+            p = _peers[i];
+        portEXIT_CRITICAL(&_mux);
+        if (!have)
+            break;
+        out.printf("telemetry %02X:%02X:%02X:%02X:%02X:%02X: tx ok=%lu fail=%lu loss=%u%% retries=%lu burst=%u,"
+                   " rx=%lu rssi=%d avg=%d min=%d max=%d dBm%s\n",
+                   p.mac[0], p.mac[1], p.mac[2], p.mac[3], p.mac[4], p.mac[5],
+                   (unsigned long)p.txOk, (unsigned long)p.txFail, p.lossPercent(), (unsigned long)p.retries,
+                   p.maxFailRun, (unsigned long)p.rxFrames, p.rssi, p.rssiAvg(), p.rssiMin, p.rssiMax,
+                   (_hasPeer && memcmp(p.mac, _peer, 6) == 0) ? " (peer)" : "");
+    }
+    if (_rtt.pongs)
+        out.printf("telemetry: peer hears us at %d dBm\n", _rtt.peerRssi);
+}
@@ -0,0 +1,58 @@
+#include "Log.h"
+
+LogRing<Log::RECORDS> Log::_ring;
+Print *Log::_out = nullptr;
+TaskHandle_t Log::_task = nullptr;
+uint32_t Log::_dropped = 0;
+
+bool Log::begin(Print &out, UBaseType_t priority)
+{
+    _out = &out;
+    if (_task)
+        return true;
+    if (xTaskCreate(&Log::_taskFn, "log", 3072, nullptr, priority, &_task) != pdPASS)
+    {
+        _task = nullptr;
+        out.println("log: task create failed");
+        return false;
+    }
+    xTaskNotifyGive(_task); // records queued before begin()
+    return true;
+}
+
+void Log::_wake()
+{
+    if (!_task)
+        return;
+    if (xPortInIsrContext())
+    {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(_task, &woken);
+        if (woken)
+            portYIELD_FROM_ISR();
+    }
+    else
+        xTaskNotifyGive(_task);
+}
+
+void Log::_taskFn(void *)
+{
+    char line[160];
+    LogRecord r;
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        while (_ring.pop(r))
+        {
+            const uint32_t lost = _ring.takeDropped();
+            if (lost)
+            {
+                _dropped += lost;
+                _out->printf("log: %lu dropped\n", (unsigned long)lost);
+            }
+            const int n = logFormat(r, line, sizeof(line));
+            if (n > 0)
+                _out->write((const uint8_t *)line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+        }
+    }
+}
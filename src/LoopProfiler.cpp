@@ -0,0 +1,58 @@
+#include "LoopProfiler.h"
+
+#if LOOP_PROFILER
+
+LoopProfiler loopProfiler;
+
+void LoopProfiler::begin(uint32_t budgetUs)
+{
+    _core.setBudget(budgetUs * ESP.getCpuFreqMHz());
+
+    // cost of an empty PROF(): cheapest of a few tries (no cache misses, no interrupt)
+    const uint8_t probe = _core.section("(probe)");
+    _overhead = 0xFFFFFFFFu;
+    for (uint8_t i = 0; i < 16; i++)
+    {
+        const uint32_t t0 = cycles();
+        {
+            Scope s(probe);
+        }
+        const uint32_t c = cycles() - t0;
+        if (c < _overhead)
+            _overhead = c;
+    }
+    _core.clear(); // the probe section stays registered but empty (not reported)
+}
+
+void LoopProfiler::printReport(Print &out)
+{
+    const uint32_t mhz = ESP.getCpuFreqMHz();
+    const Log2Hist &l = _core.loop();
+    out.printf("prof: %lu passes at %lu MHz, budget %lu us, overhead %lu cycles per section\n",
+               (unsigned long)l.count(), (unsigned long)mhz, (unsigned long)(_core.budget() / mhz),
+               (unsigned long)_overhead);
+    out.printf("prof: %-10s %7s %8s %8s %8s %8s %6s (us)\n", "section", "n", "mean", "p50", "p99", "max", "block");
+    const uint8_t n = _core.sections();
+    for (uint8_t i = 0; i <= n + 1; i++)
+    {
+        const Log2Hist &h = i < n ? _core.hist(i) : i == n ? _core.other() : l;
+        if (!h.count())
+            continue;
+        const uint32_t block = i < n ? _core.overBudget(i) : i == n ? 0 : _core.loopOverBudget();
+        out.printf("prof: %-10s %7lu %8lu %8lu %8lu %8lu %6lu\n",
+                   i < n ? _core.name(i) : i == n ? "other" : "loop", (unsigned long)h.count(),
+                   (unsigned long)(h.mean() / mhz), (unsigned long)(h.percentile(50) / mhz),
+                   (unsigned long)(h.percentile(99) / mhz), (unsigned long)(h.max() / mhz), (unsigned long)block);
+    }
+    for (uint8_t i = 0; i < Core::worstSlots(); i++)
+    {
+        const Core::Offender &o = _core.worst(i);
+        if (!o.cycles)
+            break;
+        out.printf("prof: worst #%u %8lu us  %-10s <- %-10s at %lu ms\n", i + 1, (unsigned long)(o.cycles / mhz),
+                   _core.name(o.section), _core.name(o.tag), (unsigned long)o.atMs);
+    }
+    _core.clear();
+}
+
+#endif
@@ -0,0 +1,146 @@
+#include "Pairing.h"
+#include "Log.h"
+#include <esp_now.h>
+#include <Preferences.h>
+
+static const uint8_t BROADCAST_MAC[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+
+bool Pairing::begin(TxQueue &tx, uint8_t myCaps)
+{
+    _tx = &tx;
+    _myCaps = myCaps;
+
+    Preferences prefs;
+    prefs.begin("pair", true);
+    _paired = (prefs.getBytes("peer", &_rec, sizeof(_rec)) == sizeof(_rec));
+    prefs.end();
+
+    if (!_paired)
+        memset(&_rec, 0, sizeof(_rec));
+    return _paired;
+}
+
+void Pairing::start(uint32_t now, uint16_t windowMs, uint16_t beaconMs)
+{
+    if (!esp_now_is_peer_exist(BROADCAST_MAC))
+    {
+        esp_now_peer_info_t p{};
+        memcpy(p.peer_addr, BROADCAST_MAC, 6);
+        p.channel = 0; // current channel
+        p.encrypt = false;
+        esp_now_add_peer(&p);
+    }
+
+    _found = false;
+    _active = true;
+    _until = now + windowMs;
+    _beaconMs = beaconMs ? beaconMs : 1;
+    _nextBeacon = now;
+    LOG_I("Pairing: window open\n");
+}
+
+void Pairing::cancel()
+{
+    _active = false;
+    _found = false;
+}
+
+bool Pairing::onRecv(const uint8_t *srcMac, const Proto::Frame &f)
+{
+    const PairBody *pb = f.body<PairBody>();
+    if (!pb)
+        return false;
+    if (!_active)
+    {
+        // still beaconing at us after we paired: our confirming ACCEPT got lost
+        if (_paired && f.type() == CMD_PAIR_BEACON && memcmp(srcMac, _rec.mac, 6) == 0 &&
+            (int32_t)(millis() - _until) < 0)
+            _accept(srcMac);
+        return true;
+    }
+    if (_found)
+        return true; // already decided: swallow
+
+    // answer directly so the beaconing unit does not have to wait for our next beacon
+    _accept(srcMac);
+    if (f.type() == CMD_PAIR_BEACON)
+        return true; // it adopts us on this ACCEPT; we adopt it on its answer
+
+    // CMD_PAIR_ACCEPT: the sender heard us and chose us; our ACCEPT above confirms
+    memcpy(_candidate.mac, srcMac, 6);
+    _candidate.caps = pb->caps;
+    _found = true;
+    return true;
+}
+
+Pairing::Event Pairing::update(uint32_t now)
+{
+    if (!_active)
+        return Event::None;
+
+    if (_found)
+    {
+        _active = false;
+        _rec = _candidate;
+        _paired = true;
+        _save();
+        LOG_I("Pairing: paired with %02X:%02X:%02X:%02X:%02X:%02X (caps 0x%02X)\n",
+              _rec.mac[0], _rec.mac[1], _rec.mac[2], _rec.mac[3], _rec.mac[4], _rec.mac[5], _rec.caps);
+        return Event::Paired;
+    }
+
+    if ((int32_t)(now - _until) >= 0)
+    {
+        _active = false;
+        LOG_I("Pairing: window closed, nobody answered\n");
+        return Event::TimedOut;
+    }
+
+    if ((int32_t)(now - _nextBeacon) >= 0)
+    {
+        _nextBeacon = now + _beaconMs;
+        _beacon();
+    }
+    return Event::None;
+}
+
+void Pairing::forget()
+{
+    _paired = false;
+    memset(&_rec, 0, sizeof(_rec));
+    Preferences prefs;
+    prefs.begin("pair", false);
+    prefs.remove("peer");
+    prefs.end();
+}
+
+void Pairing::_beacon()
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_PAIR_BEACON, MSG_FLAG_NOACK, 0, PairBody{_myCaps});
+    _tx->send(BROADCAST_MAC, buf, (uint8_t)n, CMD_PAIR_BEACON);
+}
+
+void Pairing::_accept(const uint8_t *mac)
+{
+    if (!esp_now_is_peer_exist(mac))
+    {
+        esp_now_peer_info_t p{};
+        memcpy(p.peer_addr, mac, 6);
+        p.channel = 0;
+        p.encrypt = false;
+        esp_now_add_peer(&p);
+    }
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_PAIR_ACCEPT, MSG_FLAG_NOACK, 0, PairBody{_myCaps});
+    _tx->send(mac, buf, (uint8_t)n, CMD_PAIR_ACCEPT);
+}
+
+void Pairing::_save()
+{
+    Preferences prefs;
+    prefs.begin("pair", false);
+    prefs.putBytes("peer", &_rec, sizeof(_rec)); // one blob -> one read at boot
+    prefs.putBool("paired", true);
+    prefs.end();
+}
@@ -0,0 +1,107 @@
+#include "PowerManager.h"
+#include "Log.h"
+#include <esp_wifi.h>
+#include <esp_now.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+bool PowerManager::init(uint16_t maxMhz, uint16_t minMhz, bool lightSleep)
+{
+    _loopTask = xTaskGetCurrentTaskHandle();
+
+#if CONFIG_IDF_TARGET_ESP32
+    esp_pm_config_esp32_t cfg{};
+#else
+    esp_pm_config_t cfg{};
+#endif
+    cfg.max_freq_mhz = maxMhz;
+    cfg.min_freq_mhz = minMhz;
+    cfg.light_sleep_enable = lightSleep;
+
+    esp_err_t err = esp_pm_configure(&cfg);
+    if (err != ESP_OK)
+    {
+        // ESP_ERR_NOT_SUPPORTED: SDK built without CONFIG_PM_ENABLE -> stay at full clock
+        Serial.printf("esp_pm_configure failed: 0x%02X (power management off)\n", err);
+        _enabled = false;
+        return false;
+    }
+
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ui_cpu", &_lockCpu) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_APB_FREQ_MAX, 0, "pwm_apb", &_lockApb) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "ui_awake", &_lockAwakeUi) != ESP_OK ||
+        esp_pm_lock_create(ESP_PM_NO_LIGHT_SLEEP, 0, "pwm_awake", &_lockAwakePwm) != ESP_OK)
+    {
+        Serial.println("esp_pm_lock_create failed (power management off)");
+        _enabled = false;
+        return false;
+    }
+
+    _enabled = true;
+    return true;
+}
+
+void PowerManager::enableRadioPowerSave(uint16_t wakeIntervalMs, uint16_t wakeWindowMs)
+{
+    // Modem sleep: the RF part is powered down between wake windows
+    esp_err_t err = esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    if (err != ESP_OK)
+        LOG_W("esp_wifi_set_ps failed: 0x%02X\n", err);
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    // Without an AP there is no DTIM; ESP-NOW listens for wakeWindowMs every wakeIntervalMs.
+    esp_wifi_connectionless_module_set_wake_interval(wakeIntervalMs);
+    esp_now_set_wake_window(wakeWindowMs);
+#else
+    // Older SDKs keep the receiver on while not associated, so reception is unaffected
+    (void)wakeIntervalMs;
+    (void)wakeWindowMs;
+#endif
+}
+
+void PowerManager::wakeOnButton(uint8_t pin)
+{
+    gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+}
+
+void PowerManager::update(bool displayActive, bool pwmActive)
+{
+    _uiLocked = displayActive;
+    _pwmLocked = pwmActive;
+    if (!_enabled)
+        return;
+
+    _hold(_lockCpu, _cpuHeld, displayActive);
+    _hold(_lockAwakeUi, _awakeUiHeld, displayActive);
+    _hold(_lockApb, _apbHeld, pwmActive);
+    _hold(_lockAwakePwm, _awakePwmHeld, pwmActive);
+}
+
+void PowerManager::idle(uint32_t ms)
+{
+    // Blocking here lets the idle task run; with no locks held it enters light sleep
+    // until the next tick, a radio wake window or the button GPIO. wake() ends it early.
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+}
+
+void PowerManager::deepSleep(uint8_t wakePin)
+{
+    Serial.println("deep sleep");
+    Serial.flush();
+    esp_now_deinit();
+    esp_wifi_stop();
+    esp_sleep_enable_ext0_wakeup((gpio_num_t)wakePin, 0);
+    esp_deep_sleep_start();
+}
+
+void PowerManager::_hold(esp_pm_lock_handle_t h, bool &held, bool want)
+{
+    if (want == held)
+        return;
+    if (want)
+        esp_pm_lock_acquire(h);
+    else
+        esp_pm_lock_release(h);
+    held = want;
+}
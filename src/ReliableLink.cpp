@@ -0,0 +1,144 @@
+#include "ReliableLink.h"
+#include "Log.h"
+
+// TxQueue coalescing: a newer reliable message supersedes a queued one, and so does
+// a retransmit; keepalives, probes and ACKs coalesce by their type
+static const uint16_t KEY_DATA = 0x100;
+
+void ReliableLink::init(TxQueue &tx, const uint8_t peerMac[6], uint16_t rtoMs, uint16_t rtoMaxMs, uint8_t maxAttempts)
+{
+    _tx = &tx;
+    memcpy(_peer, peerMac, 6);
+    _rtoMs = rtoMs ? rtoMs : 1;
+    _rtoMaxMs = (rtoMaxMs < _rtoMs) ? _rtoMs : rtoMaxMs;
+    _maxAttempts = maxAttempts ? maxAttempts : 1;
+
+    // Random start so a rebooted sender is not mistaken for a duplicate by the peer
+    _nextSeq = (uint16_t)esp_random();
+    _inFlight = false;
+    _ackSeen = false;
+    _haveRxSeq = false;
+}
+
+bool ReliableLink::send(uint8_t cmd, const void *body, uint8_t len)
+{
+    if (_inFlight)
+        _stats.superseded++;
+
+    _seq = _nextSeq++;
+    _frameLen = (uint8_t)Proto::encode(_frame, cmd, 0, _seq, body, len);
+    _ackSeen = false;
+    _inFlight = true;
+    _result = Result::Pending;
+    _attempts = 0;
+    _curRtoMs = _rtoMs;
+    _firstTxUs = micros();
+    _stats.sent++;
+
+    return _transmit();
+}
+
+bool ReliableLink::sendOnce(uint8_t cmd, const void *body, uint8_t len)
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, cmd, MSG_FLAG_NOACK, _nextSeq++, body, len);
+    _stats.frames++;
+    return _tx->send(_peer, buf, (uint8_t)n, cmd);
+}
+
+bool ReliableLink::_transmit()
+{
+    _attempts++;
+    _stats.frames++;
+    _nextTxMs = millis() + _curRtoMs;
+
+    // next timeout doubles (exponential backoff), capped
+    uint32_t rto = (uint32_t)_curRtoMs * 2u;
+    _curRtoMs = (rto > _rtoMaxMs) ? _rtoMaxMs : (uint16_t)rto;
+
+    return _tx->send(_peer, _frame, _frameLen, KEY_DATA);
+}
+
+void ReliableLink::update()
+{
+    if (!_inFlight)
+        return;
+
+    if (_ackSeen && _ackSeq == _seq)
+    {
+        _finish(true, _ackAtUs);
+        return;
+    }
+
+    if ((int32_t)(millis() - _nextTxMs) >= 0)
+    {
+        if (_attempts >= _maxAttempts)
+        {
+            _finish(false, micros());
+            return;
+        }
+        _transmit();
+    }
+}
+
+void ReliableLink::_finish(bool acked, uint32_t nowUs)
+{
+    _inFlight = false;
+    _result = acked ? Result::Acked : Result::Failed;
+    _stats.lastAttempts = _attempts;
+
+    if (!acked)
+    {
+        _stats.failed++;
+        LOG_W("seq %u: no ACK after %u tx\n", _seq, _attempts);
+        return;
+    }
+
+    uint32_t lat = nowUs - _firstTxUs;
+    _stats.acked++;
+    _stats.lastLatencyUs = lat;
+    _stats.sumLatencyUs += lat;
+    if (lat < _stats.minLatencyUs)
+        _stats.minLatencyUs = lat;
+    if (lat > _stats.maxLatencyUs)
+        _stats.maxLatencyUs = lat;
+    LOG_I("seq %u: ACK in %lu us after %u tx\n", _seq, (unsigned long)lat, _attempts);
+}
+
+bool ReliableLink::onRecv(const uint8_t *srcMac, const Proto::Frame &f, uint32_t atUs)
+{
+    if (f.type() == CMD_ACK)
+    {
+        _ackSeq = f.seq();
+        _ackAtUs = atUs;
+        _ackSeen = true;
+        return false;
+    }
+
+    if (f.flags() & MSG_FLAG_NOACK)
+        return true;
+
+    // ACK every copy (our previous ACK may have been lost), deliver only the first
+    uint8_t ack[Proto::MAX_FRAME];
+    _tx->send(srcMac, ack, (uint8_t)Proto::encode(ack, CMD_ACK, 0, f.seq()), CMD_ACK);
+
+    if (_haveRxSeq && f.seq() == _lastRxSeq)
+    {
+        _stats.duplicates++;
+        return false;
+    }
+    _haveRxSeq = true;
+    _lastRxSeq = f.seq();
+    return true;
+}
+
+void ReliableLink::printStats(Print &out) const
+{
+    uint32_t avg = _stats.acked ? (uint32_t)(_stats.sumLatencyUs / _stats.acked) : 0;
+    out.printf("link: sent=%lu acked=%lu failed=%lu superseded=%lu frames=%lu dup=%lu\n",
+               (unsigned long)_stats.sent, (unsigned long)_stats.acked, (unsigned long)_stats.failed,
+               (unsigned long)_stats.superseded, (unsigned long)_stats.frames, (unsigned long)_stats.duplicates);
+    out.printf("link: latency us min=%lu avg=%lu max=%lu last=%lu (%u tx)\n",
+               (unsigned long)(_stats.acked ? _stats.minLatencyUs : 0), (unsigned long)avg,
+               (unsigned long)_stats.maxLatencyUs, (unsigned long)_stats.lastLatencyUs, _stats.lastAttempts);
+}
@@ -0,0 +1,120 @@
+#include "ScenePlayer.h"
+#include "Trace.h"
+
+void ScenePlayer::begin(const SceneDesc *table, uint8_t count, SevenSegmentText &disp, TriLeds &leds, Buzzer &buzz)
+{
+    _table = table;
+    _count = count;
+    _disp = &disp;
+    _leds = &leds;
+    _buzz = &buzz;
+    _id = _held = 0;
+}
+
+bool ScenePlayer::play(uint8_t id, uint32_t now, const SceneParams &p)
+{
+    if (!id || id >= _count)
+        return false;
+    SceneDesc s = _table[id];
+    if (p.durationMs >= 0)
+        s.durationMs = (uint16_t)p.durationMs;
+    if (p.repeat)
+        s.flags |= SCENE_REPEAT;
+    if (p.text)
+    {
+        s.text[0] = p.text[0];
+        s.text[1] = p.text[0] ? p.text[1] : 0;
+    }
+    if (_id)
+    {
+        if (s.priority < _cur.priority)
+            return false;
+        if (!_cur.durationMs && s.priority > _cur.priority)
+        {
+            _held = _id; // comes back when s is over
+            _heldDesc = _cur;
+        }
+        _end(s.flags); // s overwrites the outputs both use
+    }
+    _start(id, s, now);
+    return true;
+}
+
+void ScenePlayer::stop(uint8_t id, uint32_t now)
+{
+    if (id && id == _held)
+        _held = 0;
+    else if (id && id == _id)
+        _finish(now);
+}
+
+void ScenePlayer::update(uint32_t now)
+{
+    if (!_id)
+        return;
+    const uint16_t d = _cur.durationMs;
+    if (d && now - _startMs >= d)
+        _finish(now);
+}
+
+void ScenePlayer::_start(uint8_t id, const SceneDesc &s, uint32_t now)
+{
+    _id = id;
+    _cur = s;
+    _startMs = now;
+    TRACE(Scene, id, 1);
+
+    if (s.flags & SCENE_LEDS)
+    {
+        _leds->playLEDAnim(s.leds, s.ledPeriodMs);
+        _leds->restartAt(now);
+    }
+    if (s.flags & SCENE_SOUND)
+    {
+        if ((s.flags & SCENE_COSMETIC) && !_cosmetic)
+            _buzz->stop();
+        else
+        {
+            _buzz->play(s.melody, s.flags & SCENE_REPEAT);
+            _buzz->restartAt(now);
+        }
+    }
+    if (s.flags & SCENE_TEXT)
+    {
+        if (s.blinkMs)
+            _disp->setBlinkingText(s.text, s.blinkMs);
+        else
+        {
+            _disp->stopBlinking();
+            _disp->setString(s.text);
+        }
+        _disp->restartAt(now);
+    }
+}
+
+void ScenePlayer::_end(uint8_t keepOutputs)
+{
+    const uint8_t reset = _cur.flags & SCENE_OUTPUTS & ~keepOutputs;
+    TRACE(Scene, _id, 0);
+    if (reset & SCENE_LEDS)
+        _leds->off();
+    if (reset & SCENE_SOUND)
+        _buzz->stop();
+    if (reset & SCENE_TEXT)
+    {
+        _disp->stopBlinking();
+        _disp->setString("  ");
+    }
+}
+
+void ScenePlayer::_finish(uint32_t now)
+{
+    _end(0);
+    _id = 0;
+    if (_held)
+    {
+        const uint8_t id = _held;
+        _held = 0;
+        _start(id, _heldDesc, now);
+    }
+}
@@ -26,7 +26,7 @@ void SevenSegmentDisplay::init(uint8_t PIN_DATA, uint8_t PIN_CLOCK, uint8_t PIN_
     clearDisplay();
 }
 
-void SevenSegmentDisplay::setString(const char *s)
+void SevenSegmentText::setString(const char *s)
 {
     if (!s || s[0] == '\0')
     {
@@ -38,11 +38,10 @@ void SevenSegmentDisplay::setString(const char *s)
     setPair(l, r);
 }
 
-void SevenSegmentDisplay::refresh()
+void SevenSegmentText::visiblePair(char &l, char &r) const
 {
-    // Decide which characters to show
-    char lChar = _left;
-    char rChar = _right;
+    l = _left;
+    r = _right;
 
     if (_blinkActive)
     {
@@ -50,15 +49,22 @@ void SevenSegmentDisplay::refresh()
         // unless we are in the "off" phase where both are blanked.
         if (_blinkVisible)
         {
-            lChar = (_blinkBuffer.length() >= 1) ? _blinkBuffer[0] : ' ';
-            rChar = (_blinkBuffer.length() >= 2) ? _blinkBuffer[1] : ' ';
+            l = (_blinkBuffer.length() >= 1) ? _blinkBuffer[0] : ' ';
+            r = (_blinkBuffer.length() >= 2) ? _blinkBuffer[1] : ' ';
         }
         else
         {
-            lChar = ' ';
-            rChar = ' ';
+            l = ' ';
+            r = ' ';
         }
     }
+}
+
+void SevenSegmentDisplay::refresh()
+{
+    // Decide which characters to show
+    char lChar, rChar;
+    visiblePair(lChar, rChar);
 
     // LEFT digit slice
     _digitOff(_PIN_DIG1);
@@ -87,7 +93,7 @@ void SevenSegmentDisplay::clearDisplay()
     shift595(_segmentsActiveLow ? 0xFF : 0x00);
 }
 
-void SevenSegmentDisplay::setBlinkingText(const char *s, uint16_t periodMs)
+void SevenSegmentText::setBlinkingText(const char *s, uint16_t periodMs)
 {
     // Accept nullptr -> stop
     if (!s || s[0] == '\0')
@@ -102,6 +108,7 @@ void SevenSegmentDisplay::setBlinkingText(const char *s, uint16_t periodMs)
     {
         _blinkBuffer.remove(2); // keep only first two
     }
+    TRACE(Display, _blinkBuffer[0], _blinkBuffer[1]);
 
     // timebase: full on+off cycle
     _blinkPeriodMs = (periodMs == 0) ? 1 : periodMs;
@@ -110,7 +117,7 @@ void SevenSegmentDisplay::setBlinkingText(const char *s, uint16_t periodMs)
     _lastBlinkToggle = millis();
 }
 
-void SevenSegmentDisplay::stopBlinking()
+void SevenSegmentText::stopBlinking()
 {
     _blinkActive = false;
     _blinkVisible = true;
@@ -118,7 +125,7 @@ void SevenSegmentDisplay::stopBlinking()
     // no further action needed; refresh() will use normal _left/_right
 }
 
-void SevenSegmentDisplay::updateBlinking()
+void SevenSegmentText::updateBlinking()
 {
     if (!_blinkActive)
         return;
@@ -136,142 +143,6 @@ void SevenSegmentDisplay::updateBlinking()
     }
 }
 
-uint8_t SevenSegmentDisplay::getCharSegments(char c)
-{
-    switch (c)
-    {
-    // digits
-    case '0':
-        return (SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F);
-    case '1':
-        return (SEG_B | SEG_C);
-    case '2':
-        return (SEG_A | SEG_B | SEG_D | SEG_E | SEG_G);
-    case '3':
-        return (SEG_A | SEG_B | SEG_C | SEG_D | SEG_G);
-    case '4':
-        return (SEG_F | SEG_G | SEG_B | SEG_C);
-    case '5':
-        return (SEG_A | SEG_F | SEG_G | SEG_C | SEG_D);
-    case '6':
-        return (SEG_A | SEG_F | SEG_E | SEG_D | SEG_C | SEG_G);
-    case '7':
-        return (SEG_A | SEG_B | SEG_C);
-    case '8':
-        return (SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F | SEG_G);
-    case '9':
-        return (SEG_A | SEG_B | SEG_C | SEG_D | SEG_F | SEG_G);
-
-    // uppercase defaults
-    case 'A':
-        return (SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G);
-    case 'B':
-        return (SEG_C | SEG_D | SEG_E | SEG_F | SEG_G);
-    case 'C':
-        return (SEG_A | SEG_F | SEG_E | SEG_D);
-    case 'D':
-        return (SEG_B | SEG_C | SEG_D | SEG_E | SEG_G);
-    case 'E':
-        return (SEG_A | SEG_F | SEG_E | SEG_D | SEG_G);
-    case 'F':
-        return (SEG_A | SEG_F | SEG_E | SEG_G);
-    case 'G':
-        return (SEG_A | SEG_F | SEG_E | SEG_D | SEG_C | SEG_G);
-    case 'H':
-        return (SEG_B | SEG_C | SEG_E | SEG_F | SEG_G);
-    case 'I':
-        return (SEG_B | SEG_C);
-    case 'J':
-        return (SEG_B | SEG_C | SEG_D | SEG_E);
-    case 'L':
-        return (SEG_F | SEG_E | SEG_D);
-    case 'N':
-        return (SEG_C | SEG_E | SEG_G);
-    case 'O':
-        return (SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F);
-    case 'P':
-        return (SEG_A | SEG_B | SEG_E | SEG_F | SEG_G);
-    case 'Q':
-        return (SEG_A | SEG_B | SEG_C | SEG_F | SEG_G);
-    case 'R':
-        return (SEG_E | SEG_G);
-    case 'S':
-        return (SEG_A | SEG_F | SEG_G | SEG_C | SEG_D);
-    case 'T':
-        return (SEG_F | SEG_E | SEG_D | SEG_G);
-    case 'U':
-        return (SEG_B | SEG_C | SEG_D | SEG_E | SEG_F);
-    case 'V':
-        return (SEG_C | SEG_D | SEG_E);
-    case 'Y':
-        return (SEG_B | SEG_C | SEG_D | SEG_F | SEG_G);
-    case 'Z':
-        return (SEG_A | SEG_B | SEG_D | SEG_E | SEG_G);
-
-    // requested lowercase forms
-    case 'b':
-        return (SEG_C | SEG_D | SEG_E | SEG_F | SEG_G);
-    case 'c':
-        return (SEG_D | SEG_E | SEG_G);
-    case 'd':
-        return (SEG_B | SEG_C | SEG_D | SEG_E | SEG_G);
-    case 'h':
-        return (SEG_C | SEG_E | SEG_F | SEG_G);
-    case 'o':
-        return (SEG_C | SEG_D | SEG_E | SEG_G);
-    case 'u':
-        return (SEG_C | SEG_D | SEG_E);
-
-    // aliases: accept lowercase by mapping to uppercase
-    case 'a':
-        return (SEG_A | SEG_B | SEG_C | SEG_E | SEG_F | SEG_G);
-    case 'e':
-        return (SEG_A | SEG_F | SEG_E | SEG_D | SEG_G);
-    case 'f':
-        return (SEG_A | SEG_F | SEG_E | SEG_G);
-    case 'g':
-        return (SEG_A | SEG_F | SEG_E | SEG_D | SEG_C | SEG_G);
-    case 'i':
-        return (SEG_B | SEG_C);
-    case 'j':
-        return (SEG_B | SEG_C | SEG_D | SEG_E);
-    case 'l':
-        return (SEG_F | SEG_E | SEG_D);
-    case 'n':
-        return (SEG_C | SEG_E | SEG_G);
-    case 'p':
-        return (SEG_A | SEG_B | SEG_E | SEG_F | SEG_G);
-    case 'q':
-        return (SEG_A | SEG_B | SEG_C | SEG_F | SEG_G);
-    case 'r':
-        return (SEG_E | SEG_G);
-    case 's':
-        return (SEG_A | SEG_F | SEG_G | SEG_C | SEG_D);
-    case 't':
-        return (SEG_F | SEG_E | SEG_D | SEG_G);
-    case 'v':
-        return (SEG_C | SEG_D | SEG_E);
-    case 'y':
-        return (SEG_B | SEG_C | SEG_D | SEG_F | SEG_G);
-    case 'z':
-        return (SEG_A | SEG_B | SEG_D | SEG_E | SEG_G);
-
-    case '!':
-        return (SEG_B | SEG_DP);
-    case '-':
-        return SEG_G;
-    case '_':
-        return SEG_D;
-    case '.':
-        return SEG_DP;
-    case ' ':
-        return 0;
-
-    default:
-        return 0;
-    }
-}
-
 uint8_t SevenSegmentDisplay::buildRawFromLogical(uint8_t logicalMask)
 {
     // Convert logical segment ON bits to raw 595 byte based on polarity & mapping
@@ -301,7 +172,7 @@ void SevenSegmentDisplay::shift595(uint8_t data)
     digitalWrite(_PIN_LATCH, HIGH);
 }
 
-void SevenSegmentDisplay::setScrollingString(const char *s, uint16_t intervalMs)
+void SevenSegmentText::setScrollingString(const char *s, uint16_t intervalMs)
 {
     if (!s)
     {
@@ -321,7 +192,7 @@ void SevenSegmentDisplay::setScrollingString(const char *s, uint16_t intervalMs)
     }
 }
 
-void SevenSegmentDisplay::updateScrolling()
+void SevenSegmentText::updateScrolling()
 {
     if (!_scrollingActive)
         return;
@@ -0,0 +1,49 @@
+#include "SignalLease.h"
+
+SignalLease::Action SignalLease::poll(bool pressed, uint32_t now)
+{
+    if (pressed && !_held)
+    {
+        _held = true;
+        _lastBeat = now;
+        return Action::Start;
+    }
+    if (!pressed && _held)
+    {
+        _held = false;
+        return Action::Stop;
+    }
+    if (_held && now - _lastBeat >= _heartbeatMs)
+    {
+        _lastBeat = now;
+        return Action::Heartbeat;
+    }
+    return Action::None;
+}
+
+void SignalLease::extend(uint16_t leaseMs)
+{
+    if (leaseMs == 0)
+        leaseMs = _leaseMs;
+    uint32_t until = millis() + leaseMs;
+    _until = until ? until : 1; // 0 is reserved for "no lease"
+}
+
+SignalLease::Event SignalLease::update(uint32_t now)
+{
+    uint32_t until = _until;
+    bool live = until != 0 && (int32_t)(until - now) > 0;
+
+    if (live && !_active)
+    {
+        _active = true;
+        return Event::Started;
+    }
+    if (!live && _active)
+    {
+        _active = false;
+        _until = 0;
+        return Event::Ended;
+    }
+    return Event::None;
+}
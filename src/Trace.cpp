@@ -0,0 +1,45 @@
+#include "Trace.h"
+
+TraceRing<Trace::EVENTS> Trace::_ring[portNUM_PROCESSORS];
+
+void Trace::dump(Print &out, const uint8_t *mac)
+{
+    for (uint8_t c = 0; c < portNUM_PROCESSORS; c++)
+        _ring[c].pause();
+    delayMicroseconds(20); // let a put() that passed the pause check finish its slot
+
+    uint32_t held = 0, lost = 0;
+    for (uint8_t c = 0; c < portNUM_PROCESSORS; c++)
+    {
+        held += _ring[c].head() - _ring[c].first();
+        lost += _ring[c].overwritten();
+    }
+    // the anchor lets the host unwrap the 32-bit timestamps
+    out.printf("trace: dev %02X:%02X:%02X:%02X:%02X:%02X now %llu events %lu overwritten %lu\n", mac[0], mac[1],
+               mac[2], mac[3], mac[4], mac[5], (unsigned long long)esp_timer_get_time(), (unsigned long)held,
+               (unsigned long)lost);
+
+    // merge the cores, oldest first
+    uint32_t next[portNUM_PROCESSORS];
+    for (uint8_t c = 0; c < portNUM_PROCESSORS; c++)
+        next[c] = _ring[c].first();
+    for (;;)
+    {
+        int8_t pick = -1;
+        for (uint8_t c = 0; c < portNUM_PROCESSORS; c++)
+            if (next[c] != _ring[c].head() &&
+                (pick < 0 || (int32_t)(_ring[c].at(next[c]).us - _ring[pick].at(next[pick]).us) < 0))
+                pick = c;
+        if (pick < 0)
+            break;
+        const TraceEvent &e = _ring[pick].at(next[pick]++);
+        out.printf("trace: %lu %d %s %u %u\n", (unsigned long)e.us, pick, traceName((TraceType)e.type), e.a, e.b);
+    }
+    out.println("trace: end");
+
+    for (uint8_t c = 0; c < portNUM_PROCESSORS; c++)
+    {
+        _ring[c].clear();
+        _ring[c].resume();
+    }
+}
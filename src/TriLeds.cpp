@@ -1,4 +1,5 @@
 #include "TriLeds.h"
+#include "Trace.h"
 
 void TriLeds::init(uint8_t pinG, uint8_t pinY, uint8_t pinR,
                    bool activeHigh, bool usePwm,
@@ -35,6 +36,7 @@ void TriLeds::init(uint8_t pinG, uint8_t pinY, uint8_t pinR,
 
 void TriLeds::playLEDAnim(Anim a, uint16_t periodMs, uint16_t gMs, uint16_t yMs, uint16_t rMs)
 {
+    TRACE(LedAnim, a, periodMs);
     _anim = a;
     _period = periodMs;
     _gMs = gMs;
@@ -166,6 +168,8 @@ void TriLeds::update()
 // ---- IO ----
 void TriLeds::_digital(bool g, bool y, bool r)
 {
+    if (!_level)
+        g = y = r = false;
     auto w = [&](uint8_t pin, bool on)
     {
         digitalWrite(pin, (_activeHigh ? (on ? HIGH : LOW) : (on ? LOW : HIGH)));
@@ -183,7 +187,7 @@ void TriLeds::_pwm(uint8_t g, uint8_t y, uint8_t r)
         return;
     }
     auto mapd = [&](uint8_t v)
-    { return (uint16_t)v * _dutyMax / 255u; };
+    { return (uint16_t)((uint32_t)v * _level * _dutyMax / (255u * 255u)); };
     uint16_t dg = mapd(g), dy = mapd(y), dr = mapd(r);
     if (_activeHigh)
     {
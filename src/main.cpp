@@ -1,7 +1,26 @@
 #include <Arduino.h>
-#include "SevenSegmentDisplay.h"
+#include "SevenSegmentFixed.h"
 #include "Buzzer.h"
 #include "TriLeds.h"
+#include "ScenePlayer.h"
+#include "PowerManager.h"
+#include "ReliableLink.h"
+#include "SignalLease.h"
+#include "ChannelManager.h"
+#include "Pairing.h"
+#include "GroupLink.h"
+#include "RxRing.h"
+#include "TxQueue.h"
+#include "LinkTelemetry.h"
+#include "LatencyBench.h"
+#include "LinkAdapter.h"
+#include "Button.h"
+#include "AnalogInputs.h"
+#include "PowerGovernor.h"
+#include "LoopProfiler.h"
+#include "HeapMonitor.h"
+#include "Trace.h"
+#include "Log.h"
 #include <WiFi.h>
 #include <esp_now.h>
 #include <esp_wifi.h>
@@ -22,35 +41,106 @@ static const uint8_t PIN_LED_Y = 5;
 static const uint8_t PIN_LED_R = 19;
 // Button (to GND, needs internal pull-up)
 static const uint8_t PIN_BTN = 33;
-
-// ---- Peer MAC (receiver) ----
-static const uint8_t RECEIVER_MAC[6] = {0x8C, 0x4F, 0x00, 0x0F, 0xD8, 0x54};
-// If you want to send to the other one instead, swap to:
-// static const uint8_t RECEIVER_MAC[6] = {0xF8, 0xB3, 0xB7, 0x45, 0x35, 0x00};
+// Analog (ADC1 only: ADC2 is taken by Wi-Fi)
+static const uint8_t PIN_POT = 34;  // 10k pot wiper, ends to 3V3 / GND
+static const uint8_t PIN_BATT = 35; // cell through a 100k/100k divider
 
 // ---- App state ----
-SevenSegmentDisplay disp;
+// board wiring fixed at compile time: digit enabled = HIGH, segment ON = LOW, SegMapBoard
+// (SevenSegmentDisplay takes pins, polarity and map at run time, for prototyping other wiring)
+SevenSegmentFixed<PIN_DATA, PIN_CLOCK, PIN_LATCH, PIN_DIG_LEFT, PIN_DIG_RIGHT, true, true, SegMapBoard> disp;
 Buzzer buzz;
 TriLeds leds;
+PowerManager power;
+ReliableLink radio; // wire format: Protocol.h
+SignalLease lease;  // hold-to-signal: START / HEARTBEAT / STOP
+ChannelManager chan;
+Pairing pairing;    // peer MAC + capabilities, cached in NVS
+GroupLink group;    // optional 1:N broadcast mode
+RxRing<16> rx;      // receive callback -> loop()
+TxQueue tx;         // loop() -> driver, one frame in flight per peer
+LinkTelemetry telem; // RTT pings, per-peer loss / RSSI
+LatencyBench bench;  // serial 'b': automated button -> buzzer latency run
+LinkAdapter adapt;   // PHY rate / TX power / LR per peer, from ACK success
+Button button;       // interrupt-driven gestures, wakes loop()
+AnalogInputs analog; // pot + battery, DMA ADC in the background
+PowerGovernor governor; // battery -> tier: what the UI and the radio may spend
+ScenePlayer scenes;     // display + LEDs + buzzer reactions, by scene ID
+
+// ---- Hold-to-signal timing ----
+static const uint16_t HEARTBEAT_MS = 300; // keepalive period while the button is held
+static const uint16_t LEASE_MS = 1000;    // receiver stays on this long after the last frame
+static const uint16_t DEBOUNCE_MS = 15;
+
+// ---- Pairing ----
+static const uint8_t RENDEZVOUS_CH = 1;             // unpaired units meet here
+static const uint16_t LONG_PRESS_UNPAIRED_MS = 1500; // long press -> pairing window
+static const uint16_t LONG_PRESS_PAIRED_MS = 8000;   // longer when paired: holding also signals
+static const uint8_t MY_CAPS = CAP_DISPLAY | CAP_BUZZER | CAP_LEDS;
+
+// ---- Group mode ----
+static const uint8_t GROUP_ID = 0;     // 0 = 1:1 with the paired peer, else room-wide group
+static const bool GROUP_ACKS = true;   // members acknowledge; sender retries until all did
+static const bool GROUP_RELAY = false; // rebroadcast others' messages (range extension; use with GROUP_ACKS = false)
+
+// ---- Telemetry ----
+// RTT probe period to the paired peer in the Full tier, stretched like radioWakeMs
+// in the others; only while a view is shown (serial 'v' cycles them)
+static const uint16_t TELEMETRY_PING_MS = 2000;
+// RSSI on IDF 4.x from an undocumented driver buffer layout (see rxRssi()); IDF 5 reports it
+#ifndef RX_RSSI_IDF4
+#define RX_RSSI_IDF4 0
+#endif
+// idle display shows RSSI / RTT / loss; keeps the display (and the chip) awake
+static const LinkTelemetry::View TELEMETRY_VIEW = LinkTelemetry::View::Off;
+static const uint16_t TELEMETRY_VIEW_MS = 500;
+static const uint16_t BENCH_PRESSES = 2000;
 
-struct __attribute__((packed)) Msg
+// ---- Knob / battery ----
+static const uint16_t BATT_RATIO_X100 = 200;  // divider: cell = 2 x pin voltage
+static const uint16_t BRIGHT_MIN_US = 50;     // display ON time per digit at knob 0 %
+static const uint16_t BRIGHT_MAX_US = 500;    // ... and at 100 %
+static const uint16_t LOW_BATTERY_SLEEP_MS = 2000; // "Lo" on the display, then deep sleep
+static uint8_t knobPct = 100;
+static bool radioPowerSave = false;
+static uint32_t deepSleepAt = 0;
+
+// ---- Scenes ----
+// Also the wire IDs of CMD_SCENE (both units carry this table): append only
+enum SceneId : uint8_t
 {
-    uint8_t cmd;         // 1 = LED pulse
-    uint16_t durationMs; // how long the LED should stay ON on the receiver
+    SCENE_SIGNAL = 1, // remote signal, held while the peer holds its button (lease)
+    SCENE_PAIRING,
+    SCENE_PAIRED,
+    SCENE_PAIR_FAILED,
+    SCENE_LOW_BATTERY,
+    SCENE_URGENT, // requested by the peer (SCENE_REMOTE) ...
+    SCENE_ACKNOWLEDGE,
+    SCENE_MESSAGE, // ... its two characters come with the request
+    SCENE_COUNT
+};
+// only the outputs in flags are used; the other fields are placeholders
+static const SceneDesc SCENES[SCENE_COUNT] = {
+    {},
+    {SCENE_LEDS | SCENE_SOUND | SCENE_TEXT | SCENE_REPEAT, 1, 0, "HI", 300, TriLeds::Anim::ChaseGYR, 150,
+     BuiltInMelody::BEEP_BEEP},
+    {SCENE_TEXT, 2, 0, "PA", 400, TriLeds::Anim::Off, 0, BuiltInMelody::BEEP_BEEP},
+    {SCENE_SOUND | SCENE_TEXT | SCENE_COSMETIC, 2, 1500, "OK", 0, TriLeds::Anim::Off, 0, BuiltInMelody::SCALE_UP},
+    {SCENE_TEXT, 2, 1500, "--", 0, TriLeds::Anim::Off, 0, BuiltInMelody::BEEP_BEEP},
+    {SCENE_TEXT, 3, 0, "Lo", 400, TriLeds::Anim::Off, 0, BuiltInMelody::BEEP_BEEP}, // then deep sleep
+    {SCENE_LEDS | SCENE_SOUND | SCENE_TEXT | SCENE_REPEAT | SCENE_REMOTE, 2, 3000, "!!", 200, TriLeds::Anim::Kitt, 150,
+     BuiltInMelody::SCALE_UP},
+    {SCENE_LEDS | SCENE_REMOTE, 1, 1000, "  ", 0, TriLeds::Anim::PulseGreen, 1000, BuiltInMelody::BEEP_BEEP},
+    {SCENE_TEXT | SCENE_REMOTE, 1, 3000, "  ", 0, TriLeds::Anim::Off, 0, BuiltInMelody::BEEP_BEEP},
 };
 
-volatile bool recvPulse = false;
-static uint32_t recvLedOffAt = 0; // set to millis()+2000 when a packet arrives
+// ---- Link adaptation ----
+static const uint8_t ADAPT_TARGET_PCT = 90; // lowest power / fastest rate that keeps this ACK ratio
 
-// ---- Helpers ----
-static void forceChannel(int ch)
-{
-    // Set Wi-Fi primary channel (both ends must match)
-    esp_wifi_set_promiscuous(true);
-    esp_wifi_set_channel(ch, WIFI_SECOND_CHAN_NONE);
-    esp_wifi_set_promiscuous(false);
-}
+// ---- Heap ----
+static const uint32_t HEAP_STEADY_AFTER_MS = 10000; // -DHEAP_ACCOUNTING=1: loop() allocations after this are flagged
 
+// ---- Helpers ----
 static bool addPeer(const uint8_t *mac, uint8_t channel)
 {
     if (esp_now_is_peer_exist(mac))
@@ -62,42 +152,239 @@ static bool addPeer(const uint8_t *mac, uint8_t channel)
     esp_err_t err = esp_now_add_peer(&p);
     if (err != ESP_OK)
     {
-        Serial.printf("esp_now_add_peer failed: 0x%02X\n", err);
+        LOG_E("esp_now_add_peer failed: 0x%02X\n", err);
         return false;
     }
     return true;
 }
 
 // ---- ESPNOW Callbacks ----
-static void onRecv(const uint8_t *srcMac, const uint8_t *data, int len)
+static void applySignal(uint8_t cmd, uint16_t leaseMs)
+{
+    switch (cmd)
+    {
+    case CMD_START:
+    case CMD_HEARTBEAT: // also (re)starts the signal if the START was lost
+        lease.extend(leaseMs);
+        break;
+    case CMD_STOP:
+        lease.cancel();
+        break;
+    }
+}
+
+// CMD_SCENE: the peer picks one of our scenes and may adjust it; nothing else to decode
+static void playRemoteScene(const SceneBody &b, uint32_t now)
 {
-    if (len < (int)sizeof(Msg))
+    if (b.scene >= SCENE_COUNT || !(SCENES[b.scene].flags & SCENE_REMOTE))
         return;
-    Msg m{};
-    memcpy(&m, data, sizeof(Msg));
-    if (m.cmd == 1)
+    if (b.args & SCENE_ARG_STOP)
     {
-        recvPulse = true;
+        scenes.stop(b.scene, now);
+        return;
+    }
+    SceneParams p;
+    if (b.args & SCENE_ARG_DURATION)
+        p.durationMs = b.durationMs;
+    p.repeat = b.args & SCENE_ARG_REPEAT;
+    if (b.args & SCENE_ARG_TEXT)
+        p.text = b.text;
+    scenes.play(b.scene, now, p);
+}
+
+static volatile uint32_t rxRejected = 0; // frames Proto::parse() refused (foreign, corrupt, unknown)
+
+// Runs in loop() for every queued frame, oldest first
+static void handleFrame(const RxMsg &m)
+{
+    const uint8_t *srcMac = m.mac;
+    const Proto::Frame f = m.frame();
+    telem.onRx(srcMac, m.rssi);
+
+    GroupMsg g;
+    if (group.onRecv(srcMac, f, g))
+    {
+        applySignal(g.body.inner, g.body.leaseMs);
+        return;
+    }
+
+    if (!pairing.isPaired() || memcmp(srcMac, pairing.peerMac(), 6) != 0)
+    {
+        pairing.onRecv(srcMac, f); // strangers may only talk pairing
+        return;
     }
+    if (telem.onRecv(srcMac, f, m.atUs))
+        return; // PING / PONG
+    if (bench.onRecv(srcMac, f, m.atUs))
+        return;
+    if (!radio.onRecv(srcMac, f, m.atUs))
+        return; // ACK or duplicate
+    if (f.type() == CMD_START)
+        bench.onRxStart(f.seq(), m.atUs);
+    if (pairing.onRecv(srcMac, f))
+        return; // re-pairing with the same unit
+    if (const ChannelBody *c = f.body<ChannelBody>())
+        chan.onPropose(c->channel);
+    else if (const SceneBody *sc = f.body<SceneBody>())
+        playRemoteScene(*sc, millis());
+    else if (const SignalBody *sb = f.body<SignalBody>())
+        applySignal(f.type(), sb->leaseMs);
+    else
+        applySignal(f.type(), 0);
+}
+
+static void drainRx()
+{
+    while (const RxMsg *m = rx.front())
+    {
+        handleFrame(*m);
+        rx.pop();
+    }
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+// IDF 5 hands the receive callback the frame's RX metadata
+static int8_t rxRssi(const esp_now_recv_info_t *info) { return info->rx_ctrl ? (int8_t)info->rx_ctrl->rssi : 0; }
+#else
+// IDF 4.x passes only the payload, no RX metadata: RSSI unknown (0) unless
+// RX_RSSI_IDF4=1. That reads it from the driver's buffer, which holds the RX
+// metadata, the 802.11 header + vendor action element (39 bytes), then the
+// payload; an undocumented layout, so only header bytes are sanity-checked.
+static int8_t rxRssi(const uint8_t *srcMac, const uint8_t *data)
+{
+#if !RX_RSSI_IDF4
+    (void)srcMac;
+    (void)data;
+    return 0;
+#else
+    const uint8_t *hdr = data - 39;
+    if (hdr[0] != 0xD0 || memcmp(hdr + 10, srcMac, 6) != 0 || // action frame from srcMac
+        hdr[24] != 127 || hdr[32] != 0xDD)                   // vendor-specific category, vendor element
+        return 0;
+    const uint8_t *pkt = hdr - sizeof(wifi_pkt_rx_ctrl_t);
+    return (int8_t)reinterpret_cast<const wifi_promiscuous_pkt_t *>(pkt)->rx_ctrl.rssi;
+#endif
+}
+#endif
+
+// Wi-Fi task: validate, queue, wake loop(); no locks, no protocol work here
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+static void onRecv(const esp_now_recv_info_t *info, const uint8_t *data, int len)
+{
+    const uint8_t *srcMac = info->src_addr;
+    const int8_t rssi = rxRssi(info);
+#else
+static void onRecv(const uint8_t *srcMac, const uint8_t *data, int len)
+{
+    const int8_t rssi = rxRssi(srcMac, data);
+#endif
+    Proto::Frame f;
+    if (Proto::parse(data, len, f) != Proto::Status::Ok)
+    {
+        rxRejected++;
+        return;
+    }
+    TRACE(Recv, f.type(), f.seq());
+    rx.push(srcMac, data, len, rssi, micros()); // a full ring counts an overflow
+    power.wake();
+}
+
+static uint32_t nowUs() { return micros(); }
+
+// TX tracing: type and seq straight from the header (TxQueue only holds frames Proto::encode() built)
+static inline const Proto::Header &hdrOf(const uint8_t *data)
+{
+    return *reinterpret_cast<const Proto::Header *>(data);
+}
+
+static void onQueue(const uint8_t *data, uint8_t) { TRACE(Enqueue, hdrOf(data).type, hdrOf(data).seq); }
+
+static bool espNowTx(const uint8_t *mac, const uint8_t *data, uint8_t len)
+{
+    bench.onTx(data, len);
+    TRACE(Send, hdrOf(data).type, hdrOf(data).seq);
+    esp_err_t err = esp_now_send(mac, data, len);
+    if (err != ESP_OK)
+        LOG_W("esp_now_send error: 0x%02X\n", err);
+    return err == ESP_OK;
 }
 
 static void onSent(const uint8_t *dstMac, esp_now_send_status_t status)
 {
-    Serial.printf("Send to %02X:%02X:%02X:%02X:%02X:%02X -> %s\n",
-                  dstMac[0], dstMac[1], dstMac[2], dstMac[3], dstMac[4], dstMac[5],
-                  status == ESP_NOW_SEND_SUCCESS ? "OK" : "FAIL");
+    TRACE(Sent, status == ESP_NOW_SEND_SUCCESS, 0);
+    tx.onSent(dstMac, status == ESP_NOW_SEND_SUCCESS);
+    power.wake(); // let loop() start the peer's next frame
+    telem.onSent(dstMac, status == ESP_NOW_SEND_SUCCESS); // per-peer counters ('s' prints them)
+    bench.onSent(dstMac);
+    group.onSent(dstMac, status == ESP_NOW_SEND_SUCCESS);
+    if (pairing.isPaired() && memcmp(dstMac, pairing.peerMac(), 6) == 0)
+    {
+        chan.onSent(status == ESP_NOW_SEND_SUCCESS);
+        adapt.onSent(status == ESP_NOW_SEND_SUCCESS);
+    }
+}
+
+// ---- Power tiers ----
+// knob setting scaled by what the battery tier allows
+static void applyUi()
+{
+    const TierProfile &p = governor.profile();
+    buzz.setVolume((uint32_t)knobPct * p.volumePct / 100u);
+    buzz.setMaxNotes(p.melodies == MelodyPolicy::All ? 0 : p.maxNotes);
+    leds.setBrightness(p.ledPct);
+    const uint32_t us = BRIGHT_MIN_US + (uint32_t)(BRIGHT_MAX_US - BRIGHT_MIN_US) * knobPct / 100u;
+    disp.setBrightnessMicros(us * p.displayPct / 100u);
+    scenes.setCosmeticSound(p.melodies != MelodyPolicy::AlertOnly); // the remote signal itself always sounds
+}
+
+// each PING keeps both radios awake; nobody reads the RTT with the view off
+static void applyPing()
+{
+    const uint32_t ms = (uint32_t)TELEMETRY_PING_MS * governor.profile().radioWakeMs / 100u;
+    telem.setPingPeriod(telem.view() == LinkTelemetry::View::Off ? 0 : (uint16_t)ms);
+}
+
+// a press STARTs the peer: needs a peer, and the pairing window owns the button
+static bool buttonSignals() { return (pairing.isPaired() || group.isEnabled()) && !pairing.isActive(); }
+
+// serial 'v', or a double click while the button does not signal the peer
+static void nextView()
+{
+    const uint8_t n = (uint8_t)LinkTelemetry::View::Count;
+    telem.setView((LinkTelemetry::View)(((uint8_t)telem.view() + 1) % n));
+    applyPing();
+    if (telem.view() == LinkTelemetry::View::Off && !scenes.isActive())
+        disp.setString("  ");
+}
+
+static void applyTier()
+{
+    const TierProfile &p = governor.profile();
+    LOG_I("power: %s tier (battery %u mV)\n", PowerGovernor::name(governor.tier()), analog.batteryMv());
+    applyUi();
+    analog.setPeriod(p.adcPeriodMs);
+    applyPing();
+    if (radioPowerSave)
+        power.enableRadioPowerSave(p.radioWakeMs);
+}
+
+static void wakeLoop(bool isr)
+{
+    if (isr)
+        power.wakeFromISR();
+    else
+        power.wake();
 }
 
 // ---- Setup ----
 void setup()
 {
     Serial.begin(115200);
+    Log::begin(Serial); // callbacks and loop() log through a ring, a low-priority task prints
 
     // Peripherals
-    disp.init(PIN_DATA, PIN_CLOCK, PIN_LATCH, PIN_DIG_LEFT, PIN_DIG_RIGHT);
-    disp.setDigitActiveHigh(true);   // enabling digit = HIGH
-    disp.setSegmentsActiveLow(true); // segment ON = LOW
-    disp.setBrightnessMicros(250);
+    disp.init();
+    disp.setBrightnessMicros(250); // until the knob is read
 
     buzz.init(PIN_BUZZER);
     buzz.setVolume(95);
@@ -105,13 +392,32 @@ void setup()
     buzz.play(BuiltInMelody::BOOT, false);
 
     leds.init(PIN_LED_G, PIN_LED_Y, PIN_LED_R, true, true);
-
-    pinMode(PIN_BTN, INPUT_PULLUP);
+    scenes.begin(SCENES, SCENE_COUNT, disp, leds, buzz);
+    analog.begin(PIN_POT, PIN_BATT, BATT_RATIO_X100); // knob -> volume + brightness, from the first burst on
+    governor.begin();
 
     // Wi-Fi / ESP-NOW
     WiFi.mode(WIFI_STA);
-    const uint8_t CHANNEL = 1; // <<< set this to the channel your receiver uses
-    forceChannel(CHANNEL);
+    adapt.begin(ADAPT_TARGET_PCT);
+    tx.begin(espNowTx, nowUs);
+    tx.setQueueHook(onQueue);
+    telem.begin(tx, TELEMETRY_PING_MS);
+    telem.setView(TELEMETRY_VIEW);
+    applyPing();
+    bench.begin(tx, buzz);
+    // peer from NVS (one read); cached channel, or rendezvous until the first pairing agrees one
+    const bool paired = pairing.begin(tx, MY_CAPS);
+    const uint8_t CHANNEL = chan.begin(radio, paired ? pairing.peerMac() : nullptr, RENDEZVOUS_CH);
+
+    // Power: DFS + automatic light sleep between events, button wakes us
+    power.init();
+
+    // Button: interrupt + timer debounce, also the light-sleep wake source
+    GestureCore::Config gc;
+    gc.debounceMs = DEBOUNCE_MS;
+    gc.longMs = paired ? LONG_PRESS_PAIRED_MS : LONG_PRESS_UNPAIRED_MS;
+    button.begin(PIN_BTN, gc, wakeLoop);
+    bench.setPressFn([](bool down) { button.inject(down); });
 
     if (esp_now_init() != ESP_OK)
     {
@@ -122,65 +428,292 @@ void setup()
     {
         esp_now_register_recv_cb(onRecv);
         esp_now_register_send_cb(onSent);
-        addPeer(RECEIVER_MAC, CHANNEL);
+        if (paired)
+        {
+            addPeer(pairing.peerMac(), CHANNEL);
+            radio.init(tx, pairing.peerMac());
+            telem.setPeer(pairing.peerMac());
+            bench.setPeer(pairing.peerMac());
+            adapt.setPeer(pairing.peerMac());
+        }
+        else
+        {
+            Serial.println("Not paired: long-press the button on both units");
+        }
+        group.init(tx, GROUP_ID, GROUP_ACKS);
+        group.setRelay(GROUP_RELAY);
+        if (!GROUP_RELAY) // a relay has to hear every frame, keep its radio awake
+        {
+            power.enableRadioPowerSave(governor.profile().radioWakeMs); // modem sleep, ESP-NOW keeps listening in wake windows
+            radioPowerSave = true;
+        }
     }
 
+    lease.setTiming(HEARTBEAT_MS, LEASE_MS);
+    PROF_BEGIN(); // serial 'p' (with -DLOOP_PROFILER=1)
+    HEAP_BEGIN(HEAP_STEADY_AFTER_MS); // serial 'h' (accounting with -DHEAP_ACCOUNTING=1)
+
     Serial.println("Setup done.");
 }
 
 // ---- Sending ----
-static void sendPulseOnce()
+static void sendSignal(SignalLease::Action a)
 {
-    Msg m{1, 2000};
-    esp_err_t err = esp_now_send(RECEIVER_MAC, reinterpret_cast<const uint8_t *>(&m), sizeof(m));
-    if (err != ESP_OK)
+    if (group.isEnabled())
+    {
+        // one broadcast reaches the whole room; START/STOP are ACKed per member
+        if (a == SignalLease::Action::Start)
+            group.send(CMD_START, LEASE_MS);
+        else if (a == SignalLease::Action::Heartbeat)
+            group.sendOnce(CMD_HEARTBEAT, LEASE_MS);
+        else if (a == SignalLease::Action::Stop)
+            group.send(CMD_STOP, 0);
+        return;
+    }
+
+    switch (a)
+    {
+    case SignalLease::Action::Start: // acknowledged, retransmitted until the ACK arrives
+        radio.send(CMD_START, SignalBody{LEASE_MS});
+        break;
+    case SignalLease::Action::Heartbeat: // cheap keepalive, a lost one is covered by the lease
+        radio.sendOnce(CMD_HEARTBEAT, SignalBody{LEASE_MS});
+        break;
+    case SignalLease::Action::Stop: // acknowledged; supersedes a pending START
+        radio.send(CMD_STOP);
+        break;
+    case SignalLease::Action::None:
+        break;
+    }
+}
+
+// Asks the peer to play one of its scenes: one acknowledged 13-byte frame.
+// Supersedes a START still waiting for its ACK (one message in flight).
+static void sendScene(uint8_t id, uint8_t args = 0, uint16_t durationMs = 0, const char *text = "  ")
+{
+    if (group.isEnabled() || !pairing.isPaired())
+    {
+        LOG_W("scene: needs a paired peer (1:1 mode)\n");
+        return;
+    }
+    radio.send(CMD_SCENE, SceneBody{id, args, durationMs, {text[0], text[1]}});
+}
+
+// re-pairing: the old peer leaves the ESP-NOW peer table once a new one is paired
+static uint8_t prevPeer[6];
+static bool hadPeer = false;
+
+static void startPairing(uint32_t now)
+{
+    hadPeer = pairing.isPaired();
+    if (hadPeer)
+        memcpy(prevPeer, pairing.peerMac(), 6);
+    sendSignal(lease.poll(false, now)); // release an active signal on the old peer first
+    chan.rendezvous();
+    pairing.start(now);
+    scenes.play(SCENE_PAIRING, now);
+}
+
+static void handlePairing(uint32_t now)
+{
+    switch (pairing.update(now))
     {
-        Serial.printf("esp_now_send error: 0x%02X\n", err);
+    case Pairing::Event::Paired:
+        if (hadPeer && memcmp(prevPeer, pairing.peerMac(), 6) != 0 && esp_now_is_peer_exist(prevPeer))
+            esp_now_del_peer(prevPeer);
+        hadPeer = false;
+        chan.newPeer(pairing.peerMac());
+        addPeer(pairing.peerMac(), chan.channel());
+        radio.init(tx, pairing.peerMac());
+        telem.setPeer(pairing.peerMac());
+        bench.setPeer(pairing.peerMac());
+        adapt.setPeer(pairing.peerMac());
+        button.setLongMs(LONG_PRESS_PAIRED_MS);
+        scenes.play(SCENE_PAIRED, now);
+        break;
+    case Pairing::Event::TimedOut:
+        chan.begin(radio, pairing.isPaired() ? pairing.peerMac() : nullptr, RENDEZVOUS_CH);
+        scenes.play(SCENE_PAIR_FAILED, now);
+        break;
+    case Pairing::Event::None:
+        break;
     }
 }
 
+// remote signal: on while the peer holds its button (lease), off on STOP / timeout
+static void playSignalScene(SignalLease::Event e, uint32_t now)
+{
+    if (e == SignalLease::Event::Started)
+        scenes.play(SCENE_SIGNAL, now);
+    else if (e == SignalLease::Event::Ended)
+        scenes.stop(SCENE_SIGNAL, now);
+}
+
 // ---- Loop ----
 void loop()
 {
+    PROF_LOOP_BEGIN();
+
     // housekeeping
-    disp.refresh();
-    disp.updateScrolling();
-    disp.updateBlinking();
-    buzz.update();
-    leds.update();
-
-    // handle received pulse -> play animation for 2 seconds
-    if (recvPulse)
-    {
-        recvPulse = false;
-        leds.playLEDAnim(TriLeds::Anim::ChaseGYR);
-        buzz.play(BuiltInMelody::BEEP_BEEP, false);
-        disp.setString("HI");
-        disp.setBlinkingText("HI", 300);
-        recvLedOffAt = millis() + 2000; // start 2s window NOW
-    }
-    if (recvLedOffAt && millis() >= recvLedOffAt)
-    {
-        recvLedOffAt = 0;
-        leds.playLEDAnim(TriLeds::Anim::Off);
-        leds.off();
-        buzz.stop();
-        disp.setString("  ");
-        disp.stopBlinking();
+    if (disp.isActive())
+        PROF("refresh", disp.refresh());
+    PROF("disp", disp.updateScrolling(); disp.updateBlinking());
+    PROF("buzz", buzz.update());
+    PROF("leds", leds.update());
+    PROF("rx", drainRx()); // every frame since the last pass, in arrival order
+    PROF("radio", radio.update());
+    PROF("group", group.update());
+    if (!pairing.isActive())
+        PROF("chan", chan.update(millis()));
+    PROF("telem", telem.update(millis()));
+    PROF("adapt", adapt.update(millis()));
+    PROF("tx", tx.update()); // retire completed frames, start the next one per peer
+
+    // knob: volume and display brightness (cached reads, the ADC runs in the background)
+    if (analog.potChanged(knobPct))
+        applyUi();
+
+    // battery: tier down (dimmer, shorter, sleepier radio) as the cell drains, deep sleep when empty
+    if (analog.isReady() && governor.update(analog.batteryMv(), millis()))
+    {
+        applyTier();
+        if (governor.tier() == PowerTier::Critical && !deepSleepAt)
+        {
+            sendSignal(lease.poll(false, millis())); // release an active signal on the peer
+            disp.setBrightnessMicros(BRIGHT_MIN_US);
+            scenes.play(SCENE_LOW_BATTERY, millis());
+            deepSleepAt = millis() + LOW_BATTERY_SLEEP_MS;
+        }
+    }
+    if (deepSleepAt && (int32_t)(millis() - deepSleepAt) >= 0)
+        power.deepSleep(PIN_BTN); // the button reboots us; still empty -> back here on the first reading
+
+    // serial console: 's' -> delivery / latency statistics, 'b' -> start / stop a latency benchmark,
+    // 'p' -> loop profile since the last 'p', 't' -> event trace (tools/trace_to_perfetto.py),
+    // 'h' -> heap and allocations, restarts the steady-state window,
+    // 'u' / 'a' -> urgent / acknowledge on the peer, 'm' + two characters -> show them on the peer,
+    // 'v' -> next telemetry view
+    const int key = Serial.available() ? Serial.read() : -1;
+    if (key == 'v')
+        nextView();
+    if (key == 'u')
+        sendScene(SCENE_URGENT);
+    if (key == 'a')
+        sendScene(SCENE_ACKNOWLEDGE);
+    if (key == 'm')
+    {
+        char text[2] = {' ', ' '};
+        for (uint8_t i = 0; i < 2 && Serial.available(); i++) // typed on the same line: already here
+            text[i] = (char)Serial.read();
+        sendScene(SCENE_MESSAGE, SCENE_ARG_TEXT, 0, text);
+    }
+    if (key == 'b')
+    {
+        if (bench.isRunning())
+        {
+            bench.stop();
+            bench.printReport(Serial);
+        }
+        else
+            bench.start(BENCH_PRESSES);
+    }
+    if (key == 'p')
+        PROF_REPORT(Serial);
+    if (key == 'h')
+        HEAP_REPORT(Serial);
+    if (key == 't')
+    {
+        uint8_t mac[6];
+        WiFi.macAddress(mac);
+        Trace::dump(Serial, mac);
+    }
+    if (key == 's')
+    {
+        radio.printStats(Serial);
+        group.printStats(Serial);
+        telem.printStats(Serial);
+        adapt.printStats(Serial);
+        analog.printStats(Serial);
+        Serial.printf("power: tier=%s changes=%lu\n", PowerGovernor::name(governor.tier()),
+                      (unsigned long)governor.changes());
+        Serial.printf("log: dropped=%lu\n", (unsigned long)Log::dropped());
+        Serial.printf("rx: queued=%lu overflow=%lu peak=%lu/%u rejected=%lu\n",
+                      (unsigned long)rx.stats().pushed, (unsigned long)rx.stats().overflow,
+                      (unsigned long)rx.stats().highWater, (unsigned)rx.capacity(), (unsigned long)rxRejected);
+        const TxQueue::Stats &t = tx.stats();
+        Serial.printf("tx: queued=%lu coalesced=%lu rejected=%lu errors=%lu timeouts=%lu (late %lu) depth=%u peak=%u/%u\n",
+                      (unsigned long)t.queued, (unsigned long)t.coalesced, (unsigned long)t.rejected,
+                      (unsigned long)t.errors, (unsigned long)t.timeouts, (unsigned long)t.late, t.depth, t.peakDepth,
+                      TxQueue::SLOTS);
+        Serial.printf("tx: completion us avg=%lu max=%lu last=%lu, delivered %lu/%lu\n",
+                      (unsigned long)(t.completed ? t.sumLatencyUs / t.completed : 0), (unsigned long)t.maxLatencyUs,
+                      (unsigned long)t.lastLatencyUs, (unsigned long)t.delivered, (unsigned long)t.completed);
+    }
+
+    PROF("scene", playSignalScene(lease.update(millis()), millis()); scenes.update(millis()));
+    PROF("bench", bench.update(millis())); // after the lease: the receiver reports the tone it just started
+
+    // pairing window / feedback
+    PROF("pairing", handlePairing(millis()));
+
+    // telemetry view while the display has nothing else to show
+    static uint32_t viewAt = 0;
+    if (!scenes.isActive() && millis() - viewAt >= TELEMETRY_VIEW_MS)
+    {
+        viewAt = millis();
+        PROF("render", telem.render(disp));
+    }
+
+    // button: press -> START, held -> HEARTBEAT, release -> STOP, long press -> pairing,
+    // double click -> next telemetry view, only while the button does not signal: every
+    // press of a double click would otherwise START (and sound) the peer for a local change.
+    // Holding START back until a double click is ruled out would add doubleMs to every alert.
+    const uint32_t now = millis();
+    static bool longFired = false;
+    bool pressed = false; // a click shorter than one loop pass still sends its START
+    GestureEvent e;
+    while (button.poll(e))
+    {
+        switch (e.type)
+        {
+        case Gesture::Press:
+            pressed = true;
+            longFired = false;
+            break;
+        case Gesture::LongPress:
+            if (!pairing.isActive())
+            {
+                longFired = true;
+                startPairing(now);
+            }
+            break;
+        case Gesture::DoubleClick:
+            if (!buttonSignals())
+                nextView();
+            break;
+        case Gesture::Release:
+        case Gesture::HoldTick:
+            break;
+        }
     }
+    const bool down = button.isDown() || pressed;
 
-    // button press -> send pulse
-    static uint32_t lastPressMs = 0;
-    const bool pressed = (digitalRead(PIN_BTN) == LOW);
-    if (pressed && millis() - lastPressMs > 250)
-    { // simple debounce
-        lastPressMs = millis();
-        Serial.println("Button pressed -> sending pulse");
+    // signalling needs a peer; a long press owns the button until it is released
+    const bool signalling = buttonSignals() && !longFired;
+    SignalLease::Action a = lease.poll(down && signalling, now);
+    PROF("signal", sendSignal(a));
+    if (a == SignalLease::Action::Start)
+    {
+        LOG_I("Button pressed -> START\n");
         // local blink on RED
         digitalWrite(PIN_LED_R, HIGH);
         delay(60);
         digitalWrite(PIN_LED_R, LOW);
-
-        sendPulseOnce();
     }
+
+    // hold PM locks only while outputs are running; otherwise let the chip sleep
+    power.update(disp.isActive(), buzz.isPlaying() || leds.isActive());
+    PROF_LOOP_END(); // CCOUNT stops in light sleep: idle() is not work
+    if (!power.isBusy() && !radio.isBusy() && !group.isBusy() && !chan.isBusy() && !pairing.isActive())
+        power.idle();
 }
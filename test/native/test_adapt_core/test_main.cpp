@@ -0,0 +1,115 @@
+// Host-side tests for the link adaptation controller (AdaptCore.h) against
+// simulated links: convergence, fast fallback and probe backoff.
+//
+//   pio test -e native -f native/test_adapt_core -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <random>
+#include "AdaptCore.h"
+
+typedef AdaptCore<7> Core;
+
+// ACK probability per level on a simulated link
+struct Link
+{
+    double p[7];
+};
+
+// Runs `frames` results; returns the share of frames sent at each level
+static void run(Core &c, const Link &l, int frames, std::mt19937 &rng, double share[7])
+{
+    std::uniform_real_distribution<double> u(0, 1);
+    for (int i = 0; i < 7; i++)
+        share[i] = 0;
+    for (int i = 0; i < frames; i++)
+    {
+        share[c.level()] += 1.0 / frames;
+        c.onResult(u(rng) < l.p[c.level()]);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_short_link_goes_cheapest()
+{
+    std::mt19937 rng(1);
+    Core c;
+    c.begin(4);
+    const Link near = {{0.99, 0.99, 1, 1, 1, 1, 1}};
+    double share[7];
+    run(c, near, 2000, rng, share);
+    TEST_ASSERT_EQUAL_UINT8(0, c.level());
+    TEST_ASSERT_TRUE(share[0] > 0.8);
+}
+
+void test_settles_at_cheapest_level_meeting_target()
+{
+    std::mt19937 rng(2);
+    Core c;
+    c.begin(0);
+    // levels 0..2 lose too much, 3 is fine
+    const Link mid = {{0.2, 0.5, 0.8, 0.97, 0.99, 1, 1}};
+    double share[7];
+    run(c, mid, 4000, rng, share);
+    run(c, mid, 20000, rng, share); // steady state
+    printf("\nsteady state share: ");
+    for (int i = 0; i < 7; i++)
+        printf("L%d=%.3f ", i, share[i]);
+    printf(" failed probes=%lu\n", (unsigned long)c.stats().failedProbes);
+    TEST_ASSERT_TRUE(share[3] > 0.9);                         // settled
+    TEST_ASSERT_TRUE(share[2] < 0.05);                        // probes back off
+    TEST_ASSERT_TRUE(share[4] + share[5] + share[6] < 0.05);  // no needless climbing
+}
+
+void test_fast_fallback_when_link_breaks()
+{
+    Core c;
+    c.begin(0);
+    TEST_ASSERT_FALSE(c.onResult(false));
+    TEST_ASSERT_FALSE(c.onResult(false));
+    TEST_ASSERT_TRUE(c.onResult(false)); // failFast = 3: no need to wait for the window
+    TEST_ASSERT_EQUAL_UINT8(1, c.level());
+
+    // a dead link climbs to the most robust level and stays there
+    for (int i = 0; i < 100; i++)
+        c.onResult(false);
+    TEST_ASSERT_EQUAL_UINT8(6, c.level());
+}
+
+void test_failed_probe_doubles_hold()
+{
+    Core::Config cfg;
+    cfg.window = 10;
+    cfg.probeAfter = 2;
+    Core c;
+    c.begin(3, cfg);
+    // two good windows -> probe level 2
+    for (int i = 0; i < 20; i++)
+        c.onResult(true);
+    TEST_ASSERT_EQUAL_UINT8(2, c.level());
+    TEST_ASSERT_TRUE(c.isProbing());
+    // level 2 fails -> back to 3
+    for (int i = 0; i < 3; i++)
+        c.onResult(false);
+    TEST_ASSERT_EQUAL_UINT8(3, c.level());
+    TEST_ASSERT_EQUAL_UINT32(1, c.stats().failedProbes);
+    // next probe needs 4 good windows, not 2
+    for (int i = 0; i < 30; i++)
+        c.onResult(true);
+    TEST_ASSERT_EQUAL_UINT8(3, c.level());
+    for (int i = 0; i < 10; i++)
+        c.onResult(true);
+    TEST_ASSERT_EQUAL_UINT8(2, c.level());
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_short_link_goes_cheapest);
+    RUN_TEST(test_settles_at_cheapest_level_meeting_target);
+    RUN_TEST(test_fast_fallback_when_link_breaks);
+    RUN_TEST(test_failed_probe_doubles_hold);
+    return UNITY_END();
+}
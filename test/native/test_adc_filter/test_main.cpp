@@ -0,0 +1,98 @@
+// Host-side tests for the ADC smoothing behind AnalogInputs (AdcFilter.h):
+// spike rejection, settling, noise vs. hysteresis events, battery curve.
+//
+//   pio test -e native -f native/test_adc_filter -v
+
+#include <unity.h>
+#include <random>
+#include "AdcFilter.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_first_sample_seeds_filter()
+{
+    AdcFilter<4> f;
+    TEST_ASSERT_FALSE(f.ready());
+    f.add(1850);
+    TEST_ASSERT_TRUE(f.ready());
+    TEST_ASSERT_EQUAL_UINT16(1850, f.value()); // no ramp from 0
+    f.add(1850);
+    TEST_ASSERT_EQUAL_UINT16(1850, f.value());
+}
+
+void test_median_rejects_single_spike()
+{
+    AdcFilter<2> f;
+    for (int i = 0; i < 10; i++)
+        f.add(1000);
+    f.add(3100); // one burst hit by a radio transient
+    TEST_ASSERT_EQUAL_UINT16(1000, f.value());
+    f.add(1000);
+    TEST_ASSERT_EQUAL_UINT16(1000, f.value());
+}
+
+void test_step_settles_exactly()
+{
+    AdcFilter<2> f;
+    f.add(500);
+    int n = 0;
+    while (f.value() != 2500 && n < 100)
+    {
+        f.add(2500);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT16(2500, f.value()); // fraction bits: no truncation offset
+    TEST_ASSERT_TRUE(n < 40);
+}
+
+void test_noise_does_not_chatter()
+{
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0, 15); // mV, per averaged burst
+    AdcFilter<2> f;
+    Hysteresis h(30);
+    int events = 0;
+    for (int i = 0; i < 5000; i++)
+    {
+        f.add((uint16_t)(1600 + noise(rng)));
+        events += h.update(f.value());
+    }
+    TEST_ASSERT_EQUAL_INT(1, events); // the initial value only
+
+    // a real move is reported, and settles within the band
+    for (int i = 0; i < 50; i++)
+    {
+        f.add((uint16_t)(1900 + noise(rng)));
+        events += h.update(f.value());
+    }
+    TEST_ASSERT_TRUE(events >= 2 && events <= 1 + 300 / 30); // at most one per band while it ramps
+    TEST_ASSERT_TRUE(h.value() > 1900 - 60 && h.value() < 1900 + 60);
+}
+
+void test_li_ion_percent()
+{
+    TEST_ASSERT_EQUAL_UINT8(0, liIonPercent(3000));
+    TEST_ASSERT_EQUAL_UINT8(0, liIonPercent(3300));
+    TEST_ASSERT_EQUAL_UINT8(40, liIonPercent(3800));
+    TEST_ASSERT_EQUAL_UINT8(50, liIonPercent(3850));
+    TEST_ASSERT_EQUAL_UINT8(100, liIonPercent(4200));
+    TEST_ASSERT_EQUAL_UINT8(100, liIonPercent(4350));
+    uint8_t last = 0;
+    for (uint16_t mv = 3000; mv <= 4300; mv += 5)
+    {
+        TEST_ASSERT_TRUE(liIonPercent(mv) >= last); // monotonic
+        last = liIonPercent(mv);
+    }
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_first_sample_seeds_filter);
+    RUN_TEST(test_median_rejects_single_spike);
+    RUN_TEST(test_step_settles_exactly);
+    RUN_TEST(test_noise_does_not_chatter);
+    RUN_TEST(test_li_ion_percent);
+    return UNITY_END();
+}
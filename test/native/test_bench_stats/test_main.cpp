@@ -0,0 +1,85 @@
+// Host-side tests for the latency benchmark math (BenchStats.h): histogram
+// percentiles and the NTP-style clock offset filter.
+//
+//   pio test -e native -f native/test_bench_stats -v
+
+#include <unity.h>
+#include "BenchStats.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_histogram_percentiles()
+{
+    LatencyHist<100, 100> h; // 0..10 ms
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(50));
+    // 1000 samples: 990 around 2 ms, 10 slow ones at 7.05 ms
+    for (int i = 0; i < 990; i++)
+        h.add(1950 + (i % 100));
+    for (int i = 0; i < 10; i++)
+        h.add(7050);
+    TEST_ASSERT_EQUAL_UINT32(1000, h.count());
+    TEST_ASSERT_EQUAL_UINT32(1950, h.min());
+    TEST_ASSERT_EQUAL_UINT32(7050, h.max());
+    TEST_ASSERT_EQUAL_UINT32(2000, h.percentile(50)); // upper edge of the 1.9..2.0 ms bin (500 samples)
+    TEST_ASSERT_EQUAL_UINT32(2100, h.percentile(99));
+    TEST_ASSERT_EQUAL_UINT32(7050, h.percentile(100)); // capped at the exact max
+
+    // beyond the last bin: counted, reported as max
+    h.add(50000);
+    TEST_ASSERT_EQUAL_UINT32(1, h.overflow());
+    TEST_ASSERT_EQUAL_UINT32(50000, h.percentile(100));
+
+    h.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, h.count());
+    TEST_ASSERT_EQUAL_UINT32(0, h.max());
+}
+
+// Remote clock = local + offset; exchange with the given one-way delays
+template <size_t N>
+static void exchange(ClockSync<N> &s, uint32_t local, int32_t offset, uint32_t up, uint32_t turn, uint32_t down)
+{
+    uint32_t t1 = local;
+    uint32_t t2 = t1 + up + (uint32_t)offset;
+    uint32_t t3 = t2 + turn;
+    uint32_t t4 = t1 + up + turn + down;
+    s.add(t1, t2, t3, t4);
+}
+
+void test_clock_offset_prefers_symmetric_exchange()
+{
+    ClockSync<8> s;
+    TEST_ASSERT_FALSE(s.valid());
+    const int32_t OFF = -123456789;
+    // queued exchanges (asymmetric) would be off by milliseconds
+    exchange(s, 1000, OFF, 9000, 300, 900);
+    exchange(s, 50000, OFF, 800, 300, 6000);
+    exchange(s, 90000, OFF, 700, 300, 720); // nearly symmetric, shortest
+    exchange(s, 130000, OFF, 4000, 300, 800);
+    TEST_ASSERT_TRUE(s.valid());
+    TEST_ASSERT_EQUAL_UINT32(1420, s.rtt());
+    TEST_ASSERT_TRUE(s.offset() - OFF >= -10 && s.offset() - OFF <= 10);
+}
+
+void test_clock_offset_across_wrap_and_drift()
+{
+    ClockSync<4> s;
+    // local micros() about to wrap, remote far ahead
+    exchange(s, 0xFFFFF000u, 0x40000000, 600, 200, 600);
+    TEST_ASSERT_EQUAL_UINT32(1200, s.rtt());
+    TEST_ASSERT_EQUAL(0x40000000, s.offset());
+
+    // the remote clock drifts by +50 us; once the old best leaves the window, so does the estimate
+    for (uint32_t i = 0; i < 4; i++)
+        exchange(s, 0x1000 + i * 1000, 0x40000000 + 50, 600, 200, 620);
+    TEST_ASSERT_TRUE(s.offset() - (0x40000000 + 50) >= -10 && s.offset() - (0x40000000 + 50) <= 10);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_histogram_percentiles);
+    RUN_TEST(test_clock_offset_prefers_symmetric_exchange);
+    RUN_TEST(test_clock_offset_across_wrap_and_drift);
+    return UNITY_END();
+}
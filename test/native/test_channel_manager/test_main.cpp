@@ -0,0 +1,199 @@
+// Channel migration (ChannelManager over ReliableLink / TxQueue) between two
+// boards on the EspNowSim medium, virtual time:
+//  - a peer that acknowledges every CMD_CHANNEL but never moves: each candidate
+//    fails verification, so the proposer must go back to the channel the peer
+//    answered on before proposing the next one, and end there. The survey must
+//    not hold up loop().
+//  - a peer that moves: both end on the first candidate and save it.
+//  - a peer that moves to a jammed candidate: the proposer's verification fails,
+//    and the peer must not keep (or save) the channel it was moved to.
+//
+//   pio test -e native -f native/test_channel_manager -v
+
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <Preferences.h>
+#include "FakeHal.h"
+#include "EspNowSim.h"
+#include "TxQueue.h"
+#include "ReliableLink.h"
+#include "ChannelManager.h"
+
+static const uint8_t MAC_A[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01}; // lower MAC: runs the survey
+static const uint8_t MAC_B[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+static const uint8_t HOME_CH = 13; // last in the (all equal) survey order: every other one is tried first
+
+static bool espNowTx(const uint8_t *mac, const uint8_t *data, uint8_t len)
+{
+    return esp_now_send(mac, data, len) == ESP_OK;
+}
+
+// One board: the sketch's channel handling; a stubborn one acknowledges
+// CMD_CHANNEL but stays on HOME_CH
+struct Unit
+{
+    const uint8_t *peer = nullptr;
+    bool moves = true;
+    TxQueue tx;
+    ReliableLink radio;
+    ChannelManager chan;
+    std::vector<uint8_t> proposals; // CMD_CHANNEL heard
+    uint32_t surveyPasses = 0;      // loop() passes while the survey runs
+};
+
+static Unit *units[2];
+static Unit &me() { return *units[fake::node()]; }
+
+static void onSent(const uint8_t *mac, esp_now_send_status_t s)
+{
+    me().tx.onSent(mac, s == ESP_NOW_SEND_SUCCESS);
+    if (me().moves)
+        me().chan.onSent(s == ESP_NOW_SEND_SUCCESS);
+}
+
+static void onRecv(const uint8_t *mac, const uint8_t *data, int len)
+{
+    Proto::Frame f;
+    if (Proto::parse(data, len, f) != Proto::Status::Ok || !me().radio.onRecv(mac, f, micros()))
+        return;
+    if (const ChannelBody *c = f.body<ChannelBody>())
+    {
+        me().proposals.push_back(c->channel);
+        if (me().moves)
+            me().chan.onPropose(c->channel);
+    }
+}
+
+static void setup()
+{
+    Unit &u = me();
+    esp_now_init();
+    esp_now_register_send_cb(onSent);
+    esp_now_register_recv_cb(onRecv);
+    esp_now_peer_info_t p{};
+    memcpy(p.peer_addr, u.peer, 6);
+    esp_now_add_peer(&p);
+    u.tx.begin(espNowTx, micros);
+    u.radio.init(u.tx, u.peer);
+    if (u.moves)
+        u.chan.begin(u.radio, u.peer, HOME_CH);
+    else
+        esp_wifi_set_channel(HOME_CH, WIFI_SECOND_CHAN_NONE);
+}
+
+static void loop()
+{
+    Unit &u = me();
+    u.tx.update();
+    u.radio.update();
+    if (!u.moves)
+        return;
+    u.chan.update(millis());
+    if (u.chan.state() == ChannelManager::State::Surveying)
+        u.surveyPasses++;
+}
+
+// A and B on HOME_CH; A's first acknowledged frame starts the survey
+static void run(bool bMoves, uint8_t jammedCh = 0)
+{
+    units[0]->peer = MAC_B;
+    units[1]->peer = MAC_A;
+    units[1]->moves = bMoves;
+    EspNowSim &sim = EspNowSim::instance();
+    sim.reset(1);
+    const uint8_t a = sim.addNode(MAC_A, setup, loop);
+    sim.addNode(MAC_B, setup, loop);
+    if (jammedCh)
+        sim.setChannelLoss(jammedCh, 1.0);
+    sim.start();
+    sim.at(1000, a, [] { me().radio.sendOnce(CMD_PROBE); });
+    sim.runUntil(10000000);
+}
+
+// where node n is tuned, and what it saved
+static uint8_t tunedCh(uint8_t n)
+{
+    fake::setNode(n);
+    return EspNowSim::instance().channel();
+}
+
+static uint8_t savedCh(uint8_t n)
+{
+    fake::setNode(n);
+    Preferences prefs;
+    prefs.begin("pair", true);
+    const uint8_t ch = prefs.getUChar("chan", 0);
+    prefs.end();
+    return ch;
+}
+
+void setUp()
+{
+    units[0] = new Unit;
+    units[1] = new Unit;
+}
+
+void tearDown()
+{
+    delete units[0];
+    delete units[1];
+}
+
+void test_failed_candidates_fall_back()
+{
+    run(false);
+    Unit &a = *units[0], &b = *units[1];
+
+    // every proposal was made from HOME_CH, where B heard and acknowledged it
+    TEST_ASSERT_EQUAL_UINT32(HOME_CH - 1, b.proposals.size());
+    for (uint8_t i = 0; i < b.proposals.size(); i++)
+        TEST_ASSERT_EQUAL_UINT8(i + 1, b.proposals[i]);
+
+    // ... and A ends where B is: HOME_CH, verified
+    TEST_ASSERT_EQUAL_UINT8(HOME_CH, a.chan.channel());
+    TEST_ASSERT_EQUAL_UINT8(HOME_CH, tunedCh(0));
+    TEST_ASSERT_TRUE(a.chan.state() == ChannelManager::State::Idle);
+
+    // 13 dwells of 100 ms ran across loop() passes, not inside one
+    TEST_ASSERT_TRUE(a.surveyPasses > 1000);
+}
+
+void test_both_move_and_save()
+{
+    run(true);
+    Unit &a = *units[0], &b = *units[1];
+    TEST_ASSERT_EQUAL_UINT32(1, b.proposals.size());
+    TEST_ASSERT_EQUAL_UINT8(1, tunedCh(0));
+    TEST_ASSERT_EQUAL_UINT8(1, tunedCh(1));
+    TEST_ASSERT_EQUAL_UINT8(1, savedCh(0));
+    TEST_ASSERT_EQUAL_UINT8(1, savedCh(1));
+    TEST_ASSERT_TRUE(a.chan.state() == ChannelManager::State::Idle);
+    TEST_ASSERT_TRUE(b.chan.state() == ChannelManager::State::Idle);
+}
+
+void test_moved_peer_goes_back_after_failed_verification()
+{
+    run(true, 1); // B follows the proposal to channel 1, where nothing gets through
+    Unit &b = *units[1];
+    TEST_ASSERT_EQUAL_UINT8(1, b.proposals.at(0));
+    TEST_ASSERT_TRUE(b.proposals.size() > 1); // proposed again after going back
+
+    // together on a later candidate, and NVS agrees (a reboot does not split them)
+    const uint8_t ch = tunedCh(0);
+    TEST_ASSERT_TRUE(ch != 1);
+    TEST_ASSERT_EQUAL_UINT8(ch, tunedCh(1));
+    TEST_ASSERT_EQUAL_UINT8(ch, savedCh(0));
+    TEST_ASSERT_EQUAL_UINT8(ch, savedCh(1));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_failed_candidates_fall_back);
+    RUN_TEST(test_both_move_and_save);
+    RUN_TEST(test_moved_peer_goes_back_after_failed_verification);
+    return UNITY_END();
+}
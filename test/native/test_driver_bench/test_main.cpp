@@ -0,0 +1,254 @@
+// Host-side benchmark of the output drivers (SevenSegmentDisplay and its
+// compile-time twin SevenSegmentFixed, Buzzer, TriLeds) on the FakeArduino HAL: ns of CPU per refresh() / update() and the
+// GPIO / LEDC operations each call issues. Virtual time: delayMicroseconds()
+// in refresh() costs no wall time, so the ns are the driver's own work.
+// The op counts are exact and asserted (a regression fails CI); the timings
+// are printed only.
+//
+//   pio test -e native -f native/test_driver_bench -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <Arduino.h>
+#include "FakeHal.h"
+#include "SevenSegmentDisplay.h"
+#include "SevenSegmentFixed.h"
+#include "Buzzer.h"
+#include "TriLeds.h"
+
+static const int ITERS = 200000;
+
+struct Result
+{
+    double ns;          // wall time per call
+    double gpio;        // pin writes per call (shiftOut bits included)
+    double ledc;        // ledcWrite + ledcWriteTone per call
+    double virtualUs;   // busy-wait (delay*) per call
+};
+
+// Calls fn ITERS times, advancing the virtual clock by stepUs before each call
+template <typename F>
+static Result bench(const char *name, uint32_t stepUs, F fn)
+{
+    fake::clearCounters();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERS; i++)
+    {
+        fake::advanceUs(stepUs);
+        fn();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    const fake::Counters &c = fake::counters();
+    Result r;
+    r.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITERS;
+    r.gpio = (double)c.gpioWrites / ITERS;
+    r.ledc = (double)(c.ledcWrites + c.ledcTones) / ITERS;
+    r.virtualUs = (double)c.delayUs / ITERS;
+    printf("%-34s %9.1f ns %8.2f gpio %6.3f ledc %8.1f us busy-wait\n", name, r.ns, r.gpio, r.ledc, r.virtualUs);
+    return r;
+}
+
+void setUp() { fake::reset(1000000); }
+void tearDown() {}
+
+void test_display_refresh()
+{
+    SevenSegmentDisplay disp;
+    disp.init(23, 21, 22, 25, 26);
+    disp.setBrightnessMicros(250);
+    disp.setPair('H', 'I');
+
+    printf("\n");
+    // per digit: 2 enables off / on, latch low + 24 shift writes + latch high
+    Result r = bench("display refresh()", 0, [&] { disp.refresh(); });
+    TEST_ASSERT_EQUAL_INT(58, (int)r.gpio);
+    TEST_ASSERT_EQUAL_INT(2 * (2 + 250), (int)r.virtualUs);
+
+    disp.setBlinkingText("PA", 400);
+    r = bench("display refresh() blinking", 0, [&] { disp.refresh(); });
+    TEST_ASSERT_EQUAL_INT(58, (int)r.gpio);
+    r = bench("display updateBlinking()", 50, [&] { disp.updateBlinking(); });
+    TEST_ASSERT_EQUAL_INT(0, (int)r.gpio);
+    disp.stopBlinking();
+
+    disp.setScrollingString("HELLO WORLD", 400);
+    r = bench("display updateScrolling()", 50, [&] { disp.updateScrolling(); });
+    TEST_ASSERT_EQUAL_INT(0, (int)r.gpio);
+}
+
+typedef SevenSegmentFixed<23, 21, 22, 25, 26, true, true, SegMapBoard> FixedDisplay;
+
+// The fake charges a register store like a digitalWrite(), so the ns here are not the chip's:
+// on the ESP32 a store is a few cycles, a digitalWrite() a function call into the HAL.
+// What is asserted is that refresh() no longer goes through the HAL at all.
+void test_fixed_display_refresh()
+{
+    FixedDisplay disp;
+    disp.init();
+    disp.setBrightnessMicros(250);
+    disp.setPair('H', 'I');
+
+    printf("\n");
+    // one store turns both digits off; per digit: latch low + 24 shift stores + latch high, on, off
+    Result r = bench("display refresh() fixed", 0, [&] { disp.refresh(); });
+    TEST_ASSERT_EQUAL_INT(1 + 2 * (1 + 24 + 1 + 2), (int)r.gpio);
+    TEST_ASSERT_EQUAL_INT(2 * (2 + 250), (int)r.virtualUs);
+    TEST_ASSERT_EQUAL_UINT32(0, fake::counters().digitalWrites);
+    TEST_ASSERT_EQUAL_UINT32(0, fake::counters().shiftOuts);
+}
+
+// Bytes the 74HC595 latched: shiftOut() calls as they are, or the data pin sampled on each
+// clock rising edge and taken on the latch rising edge
+static std::vector<uint8_t> latchedBytes(const std::vector<fake::Event> &ev, uint8_t data, uint8_t clock,
+                                         uint8_t latch)
+{
+    std::vector<uint8_t> out;
+    int d = 0;
+    uint8_t sr = 0;
+    bool bitBanged = false;
+    for (const fake::Event &e : ev)
+    {
+        if (e.op == fake::Op::Shift)
+            out.push_back((uint8_t)e.value);
+        else if (e.pin == data)
+            d = e.value;
+        else if (e.pin == clock && e.value)
+        {
+            sr = (uint8_t)(sr << 1 | d);
+            bitBanged = true;
+        }
+        else if (e.pin == latch && e.value && bitBanged)
+        {
+            out.push_back(sr);
+            bitBanged = false;
+        }
+    }
+    return out;
+}
+
+void test_fixed_display_matches_runtime()
+{
+    // every character, both polarities: same bytes on the 595, same digit pins at rest
+    for (int pol = 0; pol < 2; pol++)
+    {
+        SevenSegmentDisplay rt;
+        rt.init(23, 21, 22, 25, 26);
+        rt.setDigitActiveHigh(pol);
+        rt.setSegmentsActiveLow(pol);
+        SevenSegmentFixed<23, 21, 22, 25, 26, true, true> hi;
+        SevenSegmentFixed<23, 21, 22, 25, 26, false, false> lo;
+        if (pol)
+            hi.init();
+        else
+            lo.init();
+        for (int c = 0; c < 256; c++)
+        {
+            rt.setPair((char)c, (char)(255 - c));
+            fake::record(true);
+            rt.refresh();
+            const std::vector<uint8_t> want = latchedBytes(fake::events(), 23, 21, 22);
+            const int dig = fake::pinLevel(25);
+            fake::record(false);
+
+            fake::record(true);
+            if (pol)
+            {
+                hi.setPair((char)c, (char)(255 - c));
+                hi.refresh();
+            }
+            else
+            {
+                lo.setPair((char)c, (char)(255 - c));
+                lo.refresh();
+            }
+            const std::vector<uint8_t> got = latchedBytes(fake::events(), 23, 21, 22);
+            fake::record(false);
+            TEST_ASSERT_EQUAL_INT(2, (int)want.size());
+            TEST_ASSERT_EQUAL_INT(2, (int)got.size());
+            TEST_ASSERT_EQUAL_UINT8(want[0], got[0]);
+            TEST_ASSERT_EQUAL_UINT8(want[1], got[1]);
+            TEST_ASSERT_EQUAL_INT(dig, fake::pinLevel(25));
+            TEST_ASSERT_EQUAL_INT(pol ? LOW : HIGH, fake::pinLevel(26)); // off after the slice
+        }
+    }
+}
+
+void test_buzzer_update()
+{
+    Buzzer buzz;
+    buzz.init(17);
+
+    printf("\n");
+    Result r = bench("buzzer update() idle", 100, [&] { buzz.update(); });
+    TEST_ASSERT_EQUAL_INT(0, (int)(r.ledc * ITERS));
+
+    buzz.play(BuiltInMelody::BEEP_BEEP, true); // 80+120+80+200+80 ms = 5 notes per 560 ms
+    r = bench("buzzer update() playing, 1 ms", 1000, [&] { buzz.update(); });
+    // every note change: tone + duty (or duty 0 for a rest)
+    const double notesPerCall = 5.0 / 560.0;
+    TEST_ASSERT_TRUE(r.ledc > notesPerCall && r.ledc < 2.2 * notesPerCall);
+    TEST_ASSERT_EQUAL_INT(0, (int)r.gpio);
+}
+
+void test_leds_update()
+{
+    TriLeds leds;
+    leds.init(16, 5, 19, true, true);
+
+    printf("\n");
+    Result r = bench("leds update() off", 1000, [&] { leds.update(); });
+    TEST_ASSERT_EQUAL_INT(0, (int)(r.ledc * ITERS));
+
+    leds.playLEDAnim(TriLeds::Anim::Kitt);
+    r = bench("leds update() Kitt (PWM), 1 ms", 1000, [&] { leds.update(); });
+    TEST_ASSERT_TRUE(r.ledc <= 3.0); // one duty per LED at most
+
+    leds.playLEDAnim(TriLeds::Anim::ChaseGYR);
+    r = bench("leds update() ChaseGYR (PWM), 1 ms", 1000, [&] { leds.update(); });
+    TEST_ASSERT_TRUE(r.ledc <= 3.0);
+
+    TriLeds dig;
+    dig.init(16, 5, 19, true, false);
+    dig.playLEDAnim(TriLeds::Anim::BlinkAll);
+    r = bench("leds update() BlinkAll (GPIO), 1 ms", 1000, [&] { dig.update(); });
+    TEST_ASSERT_TRUE(r.gpio <= 3.0);
+}
+
+void test_fake_hal_records()
+{
+    // the recorders see what a driver did, not just how much
+    SevenSegmentDisplay disp;
+    disp.init(23, 21, 22, 25, 26);
+    disp.setPair('H', ' ');
+    fake::record(true);
+    disp.refresh();
+    const std::vector<fake::Event> &ev = fake::events();
+    int shifts = 0;
+    for (const fake::Event &e : ev)
+        shifts += e.op == fake::Op::Shift;
+    TEST_ASSERT_EQUAL_INT(2, shifts);
+    TEST_ASSERT_EQUAL_INT(LOW, fake::pinLevel(26)); // both digits off after the slice
+    fake::record(false);
+
+    Buzzer buzz;
+    buzz.init(17, 0);
+    buzz.beep(2000, 50);
+    TEST_ASSERT_EQUAL_INT(2000, (int)fake::ledcFreq(0));
+    TEST_ASSERT_TRUE(fake::ledcDuty(0) > 0);
+    fake::advanceMs(60);
+    buzz.update();
+    TEST_ASSERT_EQUAL_UINT32(0, fake::ledcDuty(0));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_display_refresh);
+    RUN_TEST(test_fixed_display_refresh);
+    RUN_TEST(test_fixed_display_matches_runtime);
+    RUN_TEST(test_buzzer_update);
+    RUN_TEST(test_leds_update);
+    RUN_TEST(test_fake_hal_records);
+    return UNITY_END();
+}
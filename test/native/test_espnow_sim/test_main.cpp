@@ -0,0 +1,194 @@
+// Both test sketch boards (test/test.cpp, role A and role B) in one process
+// over the EspNowSim medium: A's button is pressed every 4 s and B must light
+// its LED. Runs an ideal link, loss, loss + reordering jitter and duplicated
+// frames; prints delivery ratio, MAC retries, airtime and latency per
+// scenario and asserts every press lights the peer. Virtual time throughout.
+//
+//   pio test -e native -f native/test_espnow_sim -v
+
+#include <unity.h>
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <Preferences.h>
+#include "PairRecord.h"
+#include "Protocol.h"
+#include "TxQueue.h"
+#include "GestureCore.h"
+#include "FakeHal.h"
+#include "EspNowSim.h"
+
+// One copy of the sketch per board; headers above are already included (pragma once)
+#define SKETCH_REWIND                 \
+    btn = GestureCore();              \
+    tx = TxQueue();                   \
+    recvPulse = false;                \
+    recvLedOffAt = 0;                 \
+    pulseLen = 0;                     \
+    burstEndAt = nextBurstAt = 0;     \
+    prefs = Preferences();
+namespace devA
+{
+#include "../../test.cpp"
+    void rewind() { SKETCH_REWIND }
+}
+namespace devB
+{
+#include "../../test.cpp"
+    void rewind() { SKETCH_REWIND }
+}
+
+static const uint8_t BTN = 33, LED = 16, ROLE = 4;
+static const uint32_t PRESS_EVERY_US = 4000000;
+static const int PRESSES = 10;
+
+struct Outcome
+{
+    int lit = 0;                    // presses that lit B's LED
+    std::vector<uint32_t> pressUs;  // press -> B LED on
+};
+
+static Outcome runScenario(const char *label, const EspNowSim::Link &link, uint32_t seed)
+{
+    EspNowSim &sim = EspNowSim::instance();
+    sim.reset(seed);
+    devA::rewind();
+    devB::rewind();
+    const uint8_t a = sim.addNode(devA::macA, devA::setup, devA::loop);
+    fake::setPinInput(ROLE, LOW);
+    const uint8_t b = sim.addNode(devB::macB, devB::setup, devB::loop);
+    fake::setPinInput(ROLE, HIGH);
+    fake::record(true);
+    sim.setLinks(link);
+    sim.start();
+    sim.clearStats();
+
+    std::vector<uint64_t> presses;
+    for (int i = 0; i < PRESSES; i++)
+    {
+        const uint64_t t = 1000000 + (uint64_t)i * PRESS_EVERY_US;
+        presses.push_back(t);
+        sim.at(t, a, [] { fake::setPinInput(BTN, LOW); });
+        sim.at(t + 100000, a, [] { fake::setPinInput(BTN, HIGH); });
+    }
+    sim.runUntil(presses.back() + PRESS_EVERY_US);
+    sim.printReport(label);
+
+    // first rising edge of B's LED after each press (it stays lit for the 3 s lease)
+    fake::setNode(b);
+    Outcome o;
+    for (uint64_t p : presses)
+    {
+        for (const fake::Event &e : fake::events())
+        {
+            if (e.op == fake::Op::Write && e.pin == LED && e.value == HIGH && e.atUs >= p && e.atUs < p + 1000000)
+            {
+                o.lit++;
+                o.pressUs.push_back(e.atUs - (uint32_t)p);
+                break;
+            }
+        }
+    }
+    printf("%-22s presses lit %d/%d  press -> LED ms p50 %.2f max %.2f\n", label, o.lit, PRESSES,
+           EspNowSim::percentile(o.pressUs, 50) / 1000.0, EspNowSim::percentile(o.pressUs, 100) / 1000.0);
+    return o;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_ideal_link()
+{
+    Outcome o = runScenario("ideal", EspNowSim::Link(), 1);
+    const EspNowSim::Stats &s = EspNowSim::instance().stats();
+    TEST_ASSERT_EQUAL_INT(PRESSES, o.lit);
+    TEST_ASSERT_EQUAL_UINT32(s.expected, s.delivered);
+    TEST_ASSERT_EQUAL_UINT32(s.sends, s.attempts); // no retries
+    TEST_ASSERT_EQUAL_UINT32(0, s.failed);
+    // the pulse leaves after the 60 ms local feedback blink
+    TEST_ASSERT_TRUE(EspNowSim::percentile(o.pressUs, 100) < 70000);
+}
+
+static void test_lossy_link()
+{
+    EspNowSim::Link l;
+    l.loss = 0.2;
+    Outcome o = runScenario("loss 20%", l, 2);
+    const EspNowSim::Stats &s = EspNowSim::instance().stats();
+    TEST_ASSERT_EQUAL_INT(PRESSES, o.lit);
+    TEST_ASSERT_TRUE(s.attempts > s.sends); // MAC retries did the work
+}
+
+static void test_harsh_link()
+{
+    EspNowSim::Link l;
+    l.loss = 0.5;
+    l.jitterUs = 5000; // frames 25 ms apart: jitter delays, rarely reorders
+    Outcome o = runScenario("loss 50% + jitter", l, 3);
+    TEST_ASSERT_EQUAL_INT(PRESSES, o.lit); // 8 MAC attempts x burst copies
+    TEST_ASSERT_TRUE(EspNowSim::percentile(o.pressUs, 100) < 200000);
+}
+
+static void test_duplicates()
+{
+    EspNowSim::Link l;
+    l.loss = 0.05;
+    l.jitterUs = 1000;
+    l.duplicate = 0.2;
+    Outcome o = runScenario("5% loss + 20% dups", l, 4);
+    const EspNowSim::Stats &s = EspNowSim::instance().stats();
+    TEST_ASSERT_EQUAL_INT(PRESSES, o.lit);
+    TEST_ASSERT_TRUE(s.duplicates > 0); // repeated STARTs only extend the lease
+}
+
+static void test_driver_semantics()
+{
+    EspNowSim &sim = EspNowSim::instance();
+    sim.reset(5);
+    static uint8_t got = 0;
+    static esp_now_send_status_t last = ESP_NOW_SEND_SUCCESS;
+    static const uint8_t macX[6] = {2, 0, 0, 0, 0, 1}, macY[6] = {2, 0, 0, 0, 0, 2};
+    const uint8_t x = sim.addNode(macX, [] {
+        esp_now_init();
+        esp_now_register_send_cb([](const uint8_t *, esp_now_send_status_t s) { last = s; });
+    }, nullptr);
+    const uint8_t y = sim.addNode(macY, [] {
+        esp_now_init();
+        esp_now_register_recv_cb([](const uint8_t *, const uint8_t *, int len) { got += (uint8_t)len; });
+    }, nullptr);
+    sim.start();
+
+    const uint8_t data[4] = {1, 2, 3, 4};
+    fake::setNode(x);
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_ESPNOW_NOT_FOUND, esp_now_send(macY, data, 4)); // not a peer yet
+    esp_now_peer_info_t p{};
+    memcpy(p.peer_addr, macY, 6);
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_now_add_peer(&p));
+    TEST_ASSERT_EQUAL_INT(ESP_ERR_ESPNOW_EXIST, esp_now_add_peer(&p));
+    TEST_ASSERT_EQUAL_INT(ESP_OK, esp_now_send(macY, data, 4));
+    sim.runUntil(10000);
+    TEST_ASSERT_EQUAL_UINT8(4, got);
+    TEST_ASSERT_EQUAL_INT(ESP_NOW_SEND_SUCCESS, last);
+
+    // other channel: unreachable, every retry fails
+    fake::setNode(y);
+    esp_wifi_set_channel(6, WIFI_SECOND_CHAN_NONE);
+    fake::setNode(x);
+    esp_now_send(macY, data, 4);
+    sim.runUntil(50000);
+    TEST_ASSERT_EQUAL_UINT8(4, got);
+    TEST_ASSERT_EQUAL_INT(ESP_NOW_SEND_FAIL, last);
+    TEST_ASSERT_EQUAL_UINT32(2 + EspNowSim::MAX_RETRIES, sim.stats().attempts);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ideal_link);
+    RUN_TEST(test_lossy_link);
+    RUN_TEST(test_harsh_link);
+    RUN_TEST(test_duplicates);
+    RUN_TEST(test_driver_semantics);
+    return UNITY_END();
+}
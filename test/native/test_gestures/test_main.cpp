@@ -0,0 +1,190 @@
+// Host-side tests for the button debounce / gesture engine (GestureCore.h):
+// a synthesized bouncy click (fixed edge timings, not a recording) replayed with
+// the timer fired at nextDeadline().
+//
+//   pio test -e native -f native/test_gestures -v
+
+#include <unity.h>
+#include <vector>
+#include "GestureCore.h"
+
+struct Edge
+{
+    uint32_t atUs;
+    bool down;
+};
+
+// Replays raw edges and services deadlines like Button does, up to endUs
+struct Sim
+{
+    GestureCore g;
+    bool level = false;
+    std::vector<GestureEvent> events;
+
+    void runTo(uint32_t untilUs)
+    {
+        uint32_t due;
+        drain();
+        while (g.nextDeadline(due) && (int32_t)(untilUs - due) >= 0)
+        {
+            g.onTimer(due, level);
+            drain(); // the loop is woken after every timer event
+        }
+    }
+
+    void drain()
+    {
+        GestureEvent e;
+        while (g.pop(e))
+            events.push_back(e);
+    }
+
+    void play(const std::vector<Edge> &edges, uint32_t endUs)
+    {
+        for (const Edge &e : edges)
+        {
+            runTo(e.atUs - 1);
+            level = e.down;
+            g.onEdge(e.down, e.atUs);
+            runTo(e.atUs);
+        }
+        runTo(endUs);
+    }
+
+    int count(Gesture t) const
+    {
+        int n = 0;
+        for (const GestureEvent &e : events)
+            n += e.type == t;
+        return n;
+    }
+};
+
+// A contact that bounces for ~3 ms on press and ~2 ms on release
+static void bouncyClick(std::vector<Edge> &v, uint32_t atUs, uint32_t heldUs)
+{
+    const uint32_t press[] = {0, 180, 420, 900, 2900};
+    for (size_t i = 0; i < sizeof(press) / sizeof(press[0]); i++)
+        v.push_back(Edge{atUs + press[i], i % 2 == 0});
+    const uint32_t rel[] = {0, 300, 700, 1900, 2100};
+    for (size_t i = 0; i < sizeof(rel) / sizeof(rel[0]); i++)
+        v.push_back(Edge{atUs + heldUs + rel[i], i % 2 == 1});
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_bouncy_click_is_one_press_one_release()
+{
+    Sim s;
+    s.g.begin();
+    std::vector<Edge> v;
+    bouncyClick(v, 10000, 120000);
+    s.play(v, 1000000);
+
+    TEST_ASSERT_EQUAL_INT(2, (int)s.events.size());
+    TEST_ASSERT_TRUE(s.events[0].type == Gesture::Press);
+    TEST_ASSERT_EQUAL_UINT32(10000, s.events[0].atUs); // leading edge: no debounce latency
+    TEST_ASSERT_TRUE(s.events[1].type == Gesture::Release);
+    TEST_ASSERT_EQUAL_UINT32(120, s.events[1].heldMs);
+    TEST_ASSERT_EQUAL_UINT32(10, s.g.stats().edges);
+    TEST_ASSERT_EQUAL_UINT32(8, s.g.stats().bounces);
+    TEST_ASSERT_FALSE(s.g.isDown());
+}
+
+void test_hold_ticks_and_one_long_press()
+{
+    Sim s;
+    s.g.begin();
+    std::vector<Edge> v;
+    bouncyClick(v, 0, 2100000); // held 2.1 s
+    s.play(v, 3000000);
+
+    TEST_ASSERT_EQUAL_INT(8, s.count(Gesture::HoldTick)); // 250 ms .. 2000 ms
+    TEST_ASSERT_EQUAL_INT(1, s.count(Gesture::LongPress));
+    TEST_ASSERT_EQUAL_INT(0, s.count(Gesture::DoubleClick));
+    TEST_ASSERT_TRUE(s.events.back().type == Gesture::Release);
+}
+
+void test_double_click_but_not_triple_or_after_long()
+{
+    Sim s;
+    s.g.begin();
+    std::vector<Edge> v;
+    bouncyClick(v, 0, 80000);
+    bouncyClick(v, 200000, 80000);  // 120 ms after the first release: double
+    bouncyClick(v, 400000, 80000);  // third click does not make a second double
+    s.play(v, 1000000);
+    TEST_ASSERT_EQUAL_INT(3, s.count(Gesture::Press));
+    TEST_ASSERT_EQUAL_INT(1, s.count(Gesture::DoubleClick));
+
+    Sim l;
+    l.g.begin();
+    std::vector<Edge> w;
+    bouncyClick(w, 0, 1600000);      // long press ...
+    bouncyClick(w, 1700000, 80000);  // ... followed by a quick click
+    l.play(w, 2500000);
+    TEST_ASSERT_EQUAL_INT(1, l.count(Gesture::LongPress));
+    TEST_ASSERT_EQUAL_INT(0, l.count(Gesture::DoubleClick));
+}
+
+void test_spike_leading_vs_trailing()
+{
+    const std::vector<Edge> spike = {{5000, true}, {5400, false}}; // 0.4 ms glitch
+
+    Sim lead;
+    lead.g.begin();
+    lead.play(spike, 100000);
+    TEST_ASSERT_EQUAL_INT(1, lead.count(Gesture::Press));
+    TEST_ASSERT_EQUAL_INT(1, lead.count(Gesture::Release)); // caught when the lockout ends
+
+    GestureCore::Config cfg;
+    cfg.leadingEdge = false;
+    Sim trail;
+    trail.g.begin(cfg);
+    trail.play(spike, 100000);
+    TEST_ASSERT_EQUAL_INT(0, (int)trail.events.size());
+
+    // a real press in trailing mode is dated to its first edge
+    Sim t2;
+    t2.g.begin(cfg);
+    std::vector<Edge> v;
+    bouncyClick(v, 7000, 100000);
+    t2.play(v, 500000);
+    TEST_ASSERT_EQUAL_INT(2, (int)t2.events.size());
+    TEST_ASSERT_EQUAL_UINT32(7000, t2.events[0].atUs);
+}
+
+void test_queue_overflow_drops_oldest()
+{
+    GestureCore g;
+    g.begin();
+    uint32_t t = 0;
+    for (int i = 0; i < 6; i++) // 12 events, queue holds 8
+    {
+        g.onEdge(true, t);
+        g.onTimer(t + 20000, true);
+        g.onEdge(false, t + 40000);
+        g.onTimer(t + 60000, false);
+        t += 1000000;
+    }
+    TEST_ASSERT_EQUAL_UINT32(4, g.stats().dropped);
+    GestureEvent e = {};
+    int n = 0;
+    TEST_ASSERT_TRUE(g.pop(e));
+    TEST_ASSERT_EQUAL_UINT32(2000000, e.atUs); // the first two clicks are gone
+    for (n = 1; g.pop(e); n++)
+        ;
+    TEST_ASSERT_EQUAL_INT(8, n);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bouncy_click_is_one_press_one_release);
+    RUN_TEST(test_hold_ticks_and_one_long_press);
+    RUN_TEST(test_double_click_but_not_triple_or_after_long);
+    RUN_TEST(test_spike_leading_vs_trailing);
+    RUN_TEST(test_queue_overflow_drops_oldest);
+    return UNITY_END();
+}
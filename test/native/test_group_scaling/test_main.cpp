@@ -0,0 +1,314 @@
+// Host-side scaling benchmark for group mode (GroupLink).
+//
+// Compares, for growing group sizes, how long it takes until the LAST member has
+// the alert and how much airtime that costs:
+//   unicast   serial esp_now_send per member, one frame in flight (MAC ack + retries)
+//   burst     blind broadcast burst, 12 copies 25 ms apart (old test.cpp sendPulse)
+//   bcast     GroupLink without ACKs (BLIND_COPIES broadcasts)
+//   bcast+ack GroupLink with per-member ACK aggregation and backoff retransmit
+// Receivers run the real SeenCache, the sender aggregates with the real GroupAcks.
+//
+// Airtime model: ESP-NOW at the default 1 Mbit/s DSSS rate, long preamble.
+// Collisions between jittered ACKs are not modelled (CSMA mostly defers them).
+//
+//   pio test -e native -f native/test_group_scaling -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+#include "SeenCache.h"
+#include "GroupAcks.h"
+#include "Protocol.h"
+
+// ---- Medium model (microseconds) ----
+static const double PLCP_US = 192.0;       // long preamble + header @ 1 Mbit/s
+static const double US_PER_BYTE = 8.0;     // 1 Mbit/s
+static const double ESPNOW_OVERHEAD = 43;  // MAC header, action + vendor element, FCS
+static const double MAC_ACK_US = PLCP_US + 14 * US_PER_BYTE;
+static const double SIFS_US = 10.0, DIFS_US = 50.0, BACKOFF_US = 150.0; // CWmin/2 * 20 us slots
+static const double TX_TURNAROUND_US = 250.0; // esp_now_send -> onSent -> next send (driver + task)
+static const int MAC_RETRIES = 7;
+static const int GROUP_FRAME_BYTES = sizeof(Proto::Header) + sizeof(GroupBody);
+
+static double frameUs(int payload) { return PLCP_US + (ESPNOW_OVERHEAD + payload) * US_PER_BYTE; }
+
+struct Rng
+{
+    uint32_t s;
+    uint32_t next()
+    {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    double uniform() { return (next() & 0xFFFFFF) / double(0x1000000); }
+    bool lost(double p) { return uniform() < p; }
+};
+
+struct Run
+{
+    bool delivered = true; // every member got the alert
+    double lastUs = 0;     // when the last member had it
+    double memberUs = 0;   // mean time until a member has it
+    double airUs = 0;
+    int frames = 0;
+    int duplicates = 0; // dropped by receiver seen-caches
+};
+
+// One unicast with MAC-level ack/retry; returns success, accumulates airtime
+static bool unicast(Rng &rng, double loss, int payload, Run &r, double &t)
+{
+    for (int a = 0; a <= MAC_RETRIES; a++)
+    {
+        double slot = DIFS_US + BACKOFF_US + frameUs(payload);
+        r.frames++;
+        r.airUs += frameUs(payload);
+        t += slot;
+        if (rng.lost(loss))
+            continue;
+        r.airUs += MAC_ACK_US;
+        t += SIFS_US + MAC_ACK_US;
+        if (!rng.lost(loss))
+            return true;
+    }
+    return false;
+}
+
+static Run runUnicast(Rng &rng, int n, double loss)
+{
+    Run r;
+    double t = 0;
+    for (int m = 0; m < n; m++)
+    {
+        if (!unicast(rng, loss, sizeof(Proto::Header) + sizeof(SignalBody), r, t))
+            r.delivered = false;
+        r.lastUs = t;
+        r.memberUs += t / n;
+        t += TX_TURNAROUND_US;
+    }
+    return r;
+}
+
+static Run runBurst(Rng &rng, int n, double loss, int copies, double gapUs)
+{
+    Run r;
+    std::vector<double> got(n, -1);
+    std::vector<SeenCache<16>> seen(n);
+    for (int c = 0; c < copies; c++)
+    {
+        double t = c * gapUs + DIFS_US + BACKOFF_US + frameUs(GROUP_FRAME_BYTES);
+        r.frames++;
+        r.airUs += frameUs(GROUP_FRAME_BYTES);
+        for (int m = 0; m < n; m++)
+        {
+            if (rng.lost(loss))
+                continue;
+            if (seen[m].check(0xA1B2C3D4, 7))
+                got[m] = t;
+            else
+                r.duplicates++;
+        }
+    }
+    for (double g : got)
+    {
+        if (g < 0)
+            r.delivered = false;
+        r.lastUs = std::max(r.lastUs, g);
+        r.memberUs += g / n;
+    }
+    return r;
+}
+
+static Run runGroupAck(Rng &rng, int n, double loss)
+{
+    using namespace GroupPolicy;
+    Run r;
+    GroupAcks acks;
+    for (int m = 0; m < n; m++)
+        acks.learn(0x1000 + m); // warmed-up group: members already known
+    acks.begin(42);
+
+    std::vector<double> got(n, -1);
+    std::vector<SeenCache<16>> seen(n);
+    std::vector<bool> confirmed(n, false); // member's ACK got its MAC-level ack
+    struct PendingAck
+    {
+        double at;
+        int member;
+    };
+    std::vector<PendingAck> pending;
+
+    double t = 0, rto = RTO_MS * 1000.0;
+    for (int attempt = 0; attempt < MAX_ATTEMPTS && !acks.complete(); attempt++)
+    {
+        double txEnd = t + DIFS_US + BACKOFF_US + frameUs(GROUP_FRAME_BYTES);
+        r.frames++;
+        r.airUs += frameUs(GROUP_FRAME_BYTES);
+        pending.clear();
+        for (int m = 0; m < n; m++)
+        {
+            if (rng.lost(loss))
+                continue;
+            if (seen[m].check(0xA1B2C3D4, 42))
+                got[m] = txEnd;
+            else
+                r.duplicates++;
+            // ACK after a random jitter; a duplicate only if the last ACK was not confirmed
+            if (!confirmed[m])
+                pending.push_back({txEnd + rng.uniform() * ACK_JITTER_MS * 1000.0, m});
+        }
+        std::sort(pending.begin(), pending.end(), [](const PendingAck &a, const PendingAck &b)
+                  { return a.at < b.at; });
+        double deadline = t + rto;
+        for (const PendingAck &p : pending)
+        {
+            double at = p.at;
+            Run ackRun;
+            bool ok = unicast(rng, loss, sizeof(Proto::Header) + sizeof(GroupAckBody), ackRun, at);
+            r.airUs += ackRun.airUs;
+            r.frames += ackRun.frames;
+            confirmed[p.member] = ok;
+            if (ok && at <= deadline)
+                acks.ack(0x1000 + p.member, 42);
+        }
+        t = deadline;
+        rto = std::min(rto * 2, RTO_MAX_MS * 1000.0);
+    }
+    for (double g : got)
+    {
+        if (g < 0)
+            r.delivered = false;
+        r.lastUs = std::max(r.lastUs, g);
+        r.memberUs += g / n;
+    }
+    return r;
+}
+
+struct Summary
+{
+    double deliveredPct, p50Ms, p99Ms, memberMs, airMs, frames, dups;
+};
+
+template <typename F>
+static Summary bench(F run, int trials)
+{
+    std::vector<double> lat;
+    double air = 0, frames = 0, dups = 0, member = 0;
+    int ok = 0;
+    for (int i = 0; i < trials; i++)
+    {
+        Run r = run();
+        air += r.airUs;
+        frames += r.frames;
+        dups += r.duplicates;
+        if (r.delivered)
+        {
+            ok++;
+            lat.push_back(r.lastUs);
+            member += r.memberUs;
+        }
+    }
+    std::sort(lat.begin(), lat.end());
+    auto pct = [&](double q)
+    { return lat.empty() ? 0.0 : lat[std::min(lat.size() - 1, (size_t)(q * lat.size()))] / 1000.0; };
+    return Summary{100.0 * ok / trials, pct(0.50), pct(0.99), ok ? member / ok / 1000.0 : 0.0,
+                   air / trials / 1000.0, frames / trials, dups / trials};
+}
+
+static const int TRIALS = 2000;
+static const double LOSSES[] = {0.02, 0.10};
+static const int SIZES[] = {1, 2, 5, 10, 15};
+
+static void print(const char *name, int n, const Summary &s)
+{
+    printf("%-9s %3d %8.1f%% %8.2f %8.2f %8.2f %8.2f %7.1f %6.1f\n",
+           name, n, s.deliveredPct, s.p50Ms, s.p99Ms, s.memberMs, s.airMs, s.frames, s.dups);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_group_scaling()
+{
+    for (double loss : LOSSES)
+    {
+        printf("\nloss %.0f%% per frame, %d trials; p50/p99 = last member has it, member = mean over members\n",
+               loss * 100, TRIALS);
+        printf("%-9s %3s %9s %8s %8s %8s %8s %7s %6s\n",
+               "mode", "N", "deliv", "p50 ms", "p99 ms", "member", "air ms", "frames", "dups");
+
+        for (int n : SIZES)
+        {
+            Rng rng{0x12345u + (uint32_t)n};
+            Summary uni = bench([&]
+                                { return runUnicast(rng, n, loss); }, TRIALS);
+            Summary burst = bench([&]
+                                  { return runBurst(rng, n, loss, 12, 25000.0); }, TRIALS);
+            Summary blind = bench([&]
+                                  { return runBurst(rng, n, loss, GroupPolicy::BLIND_COPIES, GroupPolicy::RTO_MS * 1000.0); }, TRIALS);
+            Summary gack = bench([&]
+                                 { return runGroupAck(rng, n, loss); }, TRIALS);
+            print("unicast", n, uni);
+            print("burst", n, burst);
+            print("bcast", n, blind);
+            print("bcast+ack", n, gack);
+
+            // Acknowledged group mode is as reliable as the blind burst ...
+            TEST_ASSERT_TRUE(gack.deliveredPct >= 99.5);
+            // ... with fewer frames on air
+            TEST_ASSERT_TRUE(gack.frames < burst.frames || n > 5);
+            // Broadcast airtime does not grow with the group
+            TEST_ASSERT_TRUE(blind.airMs < 1.0 * GroupPolicy::BLIND_COPIES);
+            // Fan-out: a typical member hears the alert sooner than with serial unicast
+            if (n >= 5)
+                TEST_ASSERT_TRUE(gack.memberMs < uni.memberMs);
+        }
+    }
+}
+
+void test_seen_cache_evicts_oldest()
+{
+    SeenCache<4> c;
+    for (uint16_t s = 0; s < 4; s++)
+        TEST_ASSERT_TRUE(c.check(1, s));
+    TEST_ASSERT_FALSE(c.check(1, 0)); // refresh seq 0 -> seq 1 is now the oldest
+    TEST_ASSERT_TRUE(c.check(2, 0));  // evicts (1,1)
+    TEST_ASSERT_TRUE(c.contains(1, 0));
+    TEST_ASSERT_FALSE(c.contains(1, 1));
+}
+
+void test_group_acks_drop_silent_members()
+{
+    GroupAcks a;
+    a.begin(1);
+    a.ack(0x1000, 1);
+    a.ack(0x2000, 1);
+    TEST_ASSERT_TRUE(a.complete());
+
+    // 0x2000 left the room: its messages stay incomplete until it is dropped
+    for (uint16_t seq = 2; seq < 2 + GroupPolicy::MEMBER_MISSES; seq++)
+    {
+        a.begin(seq);
+        TEST_ASSERT_EQUAL_UINT8(2, a.members());
+        a.ack(0x1000, seq);
+        TEST_ASSERT_FALSE(a.complete());
+    }
+    a.begin(10);
+    TEST_ASSERT_EQUAL_UINT8(1, a.members());
+    a.ack(0x1000, 10);
+    TEST_ASSERT_TRUE(a.complete());
+
+    a.ack(0x2000, 10); // back in range: learned again
+    TEST_ASSERT_EQUAL_UINT8(2, a.members());
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_seen_cache_evicts_oldest);
+    RUN_TEST(test_group_acks_drop_silent_members);
+    RUN_TEST(test_group_scaling);
+    return UNITY_END();
+}
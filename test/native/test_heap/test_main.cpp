@@ -0,0 +1,126 @@
+// Host-side tests for the allocation accounting (HeapCore.h): counts per
+// tag and nested scopes, the steady-state window (loop task only, from the
+// arming time on, first violations kept), and counters shared by tasks.
+//
+//   pio test -e native -f native/test_heap -v
+
+#include <unity.h>
+#include <thread>
+#include "HeapCore.h"
+
+typedef HeapCore<4, 3> Heap;
+
+void setUp() {}
+void tearDown() {}
+
+void test_tags_and_scopes()
+{
+    Heap h;
+    TEST_ASSERT_EQUAL_UINT8(Heap::BOOT, h.current());
+    h.onAlloc(h.current(), 100, 0, 0); // static constructors, setup()
+    h.start();
+
+    static const char *const BUZZ = "buzz";
+    const uint8_t buzz = h.tag(BUZZ);
+    const uint8_t disp = h.tag("disp");
+    TEST_ASSERT_EQUAL_UINT8(buzz, h.tag(BUZZ));
+    TEST_ASSERT_TRUE(buzz != disp);
+    TEST_ASSERT_EQUAL_STRING("buzz", h.name(buzz));
+
+    h.onAlloc(h.current(), 8, 0, 0); // untagged loop code
+    const uint8_t outer = h.enter(buzz);
+    h.onAlloc(h.current(), 16, 0, 0);
+    const uint8_t inner = h.enter(disp);
+    h.onAlloc(h.current(), 32, 0, 0);
+    h.onAlloc(h.current(), 32, 0, 0);
+    h.leave(inner);
+    h.onAlloc(h.current(), 16, 0, 0);
+    h.leave(outer);
+    TEST_ASSERT_EQUAL_UINT8(Heap::LOOP, h.current());
+    h.onAlloc(Heap::TASKS, 1000, 0, 0);
+    h.onFree();
+
+    TEST_ASSERT_EQUAL_UINT32(1, h.allocs(Heap::BOOT));
+    TEST_ASSERT_EQUAL_UINT32(1, h.allocs(Heap::LOOP));
+    TEST_ASSERT_EQUAL_UINT32(2, h.allocs(buzz));
+    TEST_ASSERT_EQUAL_UINT32(32, h.bytes(buzz));
+    TEST_ASSERT_EQUAL_UINT32(64, h.bytes(disp));
+    TEST_ASSERT_EQUAL_UINT32(1000, h.bytes(Heap::TASKS));
+    TEST_ASSERT_EQUAL_UINT32(7, h.totalAllocs());
+    TEST_ASSERT_EQUAL_UINT32(1, h.frees());
+
+    // full: further tags fall back to "loop"
+    h.tag("a");
+    h.tag("b");
+    TEST_ASSERT_EQUAL_UINT8(Heap::LOOP, h.tag("c"));
+    TEST_ASSERT_EQUAL_UINT8(Heap::SLOTS, h.slots());
+}
+
+void test_steady_state_window()
+{
+    Heap h;
+    h.start();
+    const uint8_t buzz = h.tag("buzz");
+    h.arm(1000);
+    TEST_ASSERT_FALSE(h.onAlloc(buzz, 24, 0x400d1234, 999)); // still booting
+    TEST_ASSERT_FALSE(h.onAlloc(Heap::TASKS, 24, 0, 2000));  // Wi-Fi task: counted, not flagged
+    TEST_ASSERT_EQUAL_UINT32(0, h.violations());
+
+    TEST_ASSERT_TRUE(h.onAlloc(buzz, 24, 0x400d1234, 1000));
+    for (uint32_t i = 0; i < 4; i++)
+        TEST_ASSERT_TRUE(h.onAlloc(Heap::LOOP, 8 + i, 0x400d2000 + i, 1100 + i));
+    TEST_ASSERT_EQUAL_UINT32(5, h.violations());
+    TEST_ASSERT_EQUAL_UINT8(Heap::KEPT, h.keptViolations()); // the first ones are kept
+    TEST_ASSERT_EQUAL_UINT32(0x400d1234, h.violation(0).caller);
+    TEST_ASSERT_EQUAL_UINT8(buzz, h.violation(0).slot);
+    TEST_ASSERT_EQUAL_UINT32(24, h.violation(0).size);
+    TEST_ASSERT_EQUAL_UINT32(1101, h.violation(2).ms);
+
+    // report: a new window; disarmed while it prints
+    h.disarm();
+    TEST_ASSERT_FALSE(h.onAlloc(Heap::LOOP, 64, 0, 5000));
+    h.arm(5000);
+    TEST_ASSERT_EQUAL_UINT32(0, h.violations());
+    TEST_ASSERT_EQUAL_UINT8(0, h.keptViolations());
+    TEST_ASSERT_EQUAL_UINT32(5000, h.armedAt());
+    TEST_ASSERT_TRUE(h.onAlloc(Heap::LOOP, 64, 0, 5001));
+    TEST_ASSERT_EQUAL_UINT32(1, h.violations());
+    TEST_ASSERT_EQUAL_UINT32(6, h.allocs(Heap::LOOP)); // counts are since boot
+}
+
+// Wi-Fi task, timer task and loop() allocate at the same time: no count lost
+void test_concurrent_counts()
+{
+    static Heap h;
+    h.start();
+    const uint8_t tag = h.tag("rx");
+    h.arm(0);
+    const uint32_t N = 100000;
+    std::thread a([&] {
+        for (uint32_t i = 0; i < N; i++)
+            h.onAlloc(Heap::TASKS, 2, 0, 1);
+    });
+    std::thread b([&] {
+        for (uint32_t i = 0; i < N; i++)
+            h.onFree();
+    });
+    for (uint32_t i = 0; i < N; i++)
+        h.onAlloc(tag, 1, i, 1);
+    a.join();
+    b.join();
+    TEST_ASSERT_EQUAL_UINT32(N, h.allocs(Heap::TASKS));
+    TEST_ASSERT_EQUAL_UINT32(2 * N, h.bytes(Heap::TASKS));
+    TEST_ASSERT_EQUAL_UINT32(N, h.allocs(tag));
+    TEST_ASSERT_EQUAL_UINT32(N, h.frees());
+    TEST_ASSERT_EQUAL_UINT32(N, h.violations());
+    TEST_ASSERT_EQUAL_UINT32(0, h.violation(0).caller);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_tags_and_scopes);
+    RUN_TEST(test_steady_state_window);
+    RUN_TEST(test_concurrent_counts);
+    return UNITY_END();
+}
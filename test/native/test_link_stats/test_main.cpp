@@ -0,0 +1,126 @@
+// Host-side tests for the telemetry counters (LinkStats.h): RTT percentiles,
+// per-peer loss / retries / RSSI, and peer table replacement (pinned peer kept).
+//
+//   pio test -e native -f native/test_link_stats -v
+
+#include <unity.h>
+#include "LinkStats.h"
+
+static const uint8_t A[6] = {1, 1, 1, 1, 1, 1};
+static const uint8_t B[6] = {2, 2, 2, 2, 2, 2};
+static const uint8_t C[6] = {3, 3, 3, 3, 3, 3};
+
+void setUp() {}
+void tearDown() {}
+
+void test_rtt_percentiles()
+{
+    RttWindow<100> w;
+    TEST_ASSERT_EQUAL_UINT32(0, w.percentile(50));
+    // 1..100 ms in scrambled order
+    for (uint32_t i = 0; i < 100; i++)
+        w.add(((i * 37) % 100 + 1) * 1000);
+    TEST_ASSERT_EQUAL_UINT32(50000, w.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(90000, w.percentile(90));
+    TEST_ASSERT_EQUAL_UINT32(99000, w.percentile(99));
+    TEST_ASSERT_EQUAL_UINT32(100000, w.percentile(100));
+    TEST_ASSERT_EQUAL_UINT32(1000, w.percentile(0));
+
+    // one slow outlier in a small window shows up at p99, not at the median
+    RttWindow<8> s;
+    for (int i = 0; i < 20; i++) // wraps: only the last 8 count
+        s.add(i < 12 ? 900000 : 2000);
+    s.add(40000);
+    TEST_ASSERT_EQUAL(8, s.count());
+    TEST_ASSERT_EQUAL_UINT32(2000, s.percentile(50));
+    TEST_ASSERT_EQUAL_UINT32(40000, s.percentile(99));
+}
+
+void test_loss_and_retries()
+{
+    PeerLink p;
+    TEST_ASSERT_EQUAL_UINT8(0, p.lossPercent());
+    // ok, fail, fail, ok (2 recovered), fail x3 (not yet recovered)
+    const bool seq[] = {true, false, false, true, false, false, false};
+    for (bool ok : seq)
+        p.onSent(ok, 0);
+    TEST_ASSERT_EQUAL_UINT32(2, p.txOk);
+    TEST_ASSERT_EQUAL_UINT32(5, p.txFail);
+    TEST_ASSERT_EQUAL_UINT32(2, p.retries);
+    TEST_ASSERT_EQUAL_UINT8(3, p.maxFailRun);
+    TEST_ASSERT_EQUAL_UINT8(71, p.lossPercent()); // 5 / 7
+
+    // the window forgets: 32 good frames later the loss is 0
+    for (int i = 0; i < 32; i++)
+        p.onSent(true, 0);
+    TEST_ASSERT_EQUAL_UINT8(0, p.lossPercent());
+    TEST_ASSERT_EQUAL_UINT32(5, p.retries);
+    TEST_ASSERT_EQUAL_UINT8(3, p.maxFailRun);
+}
+
+void test_rssi()
+{
+    PeerLink p;
+    p.onRx(-60, 10);
+    TEST_ASSERT_EQUAL_INT8(-60, p.rssiAvg());
+    for (int i = 0; i < 40; i++) // converges on the new level
+        p.onRx(-80, 20);
+    p.onRx(-50, 30);
+    p.onRx(0, 30); // no RSSI for this frame: counted, not averaged
+    TEST_ASSERT_EQUAL_INT8(-50, p.rssi);
+    TEST_ASSERT_EQUAL_INT8(-80, p.rssiMin);
+    TEST_ASSERT_EQUAL_INT8(-50, p.rssiMax);
+    TEST_ASSERT_TRUE(p.rssiAvg() >= -78 && p.rssiAvg() <= -74); // one strong frame moves it by 1/8
+    TEST_ASSERT_EQUAL_UINT32(43, p.rxFrames);
+    TEST_ASSERT_EQUAL_UINT32(42, p.rssiFrames);
+    TEST_ASSERT_EQUAL_UINT32(30, p.lastRxMs);
+}
+
+void test_peer_table_replaces_least_recent()
+{
+    PeerTable<2> t;
+    TEST_ASSERT_NULL(t.find(A));
+    t.find(A, true)->onRx(-40, 100);
+    t.find(B, true)->onRx(-50, 200);
+    t.find(A)->onSent(true, 300); // A is the more recent now
+    TEST_ASSERT_EQUAL(2, t.size());
+
+    PeerLink *c = t.find(C, true); // replaces B
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_EQUAL_UINT32(0, c->rxFrames);
+    TEST_ASSERT_NULL(t.find(B));
+    TEST_ASSERT_NOT_NULL(t.find(A));
+    TEST_ASSERT_EQUAL_UINT32(1, t.find(A)->txOk);
+}
+
+// the paired peer keeps its counters while strangers come and go around it
+void test_pinned_peer_is_kept()
+{
+    PeerTable<2> t;
+    t.pin(A);
+    t.find(A)->onSent(false, 100); // then silence: the link is failing
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        const uint8_t stranger[6] = {9, 9, 9, 9, 9, i};
+        t.find(stranger, true)->onRx(-80, 200 + i); // pairing beacons, group members
+    }
+    TEST_ASSERT_NOT_NULL(t.find(A));
+    TEST_ASSERT_EQUAL_UINT32(1, t.find(A)->txFail);
+    TEST_ASSERT_EQUAL(2, t.size());
+
+    t.pin(B); // re-paired: A may go now
+    t.find(C, true);
+    TEST_ASSERT_NULL(t.find(A));
+    TEST_ASSERT_NOT_NULL(t.find(B));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rtt_percentiles);
+    RUN_TEST(test_loss_and_retries);
+    RUN_TEST(test_rssi);
+    RUN_TEST(test_peer_table_replaces_least_recent);
+    RUN_TEST(test_pinned_peer_is_kept);
+    return UNITY_END();
+}
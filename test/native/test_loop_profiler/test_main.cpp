@@ -0,0 +1,103 @@
+// Host-side tests for the loop profiler math (ProfileCore.h): log2 buckets and
+// percentiles, attribution of slow loop() passes to a section or to code
+// outside every section, the worst-offender list and the budget counters.
+//
+//   pio test -e native -f native/test_loop_profiler -v
+
+#include <unity.h>
+#include "ProfileCore.h"
+
+typedef ProfileCore<4, 4> Prof;
+typedef ProfileCore<2, 3> SmallProf;
+
+void setUp() {}
+void tearDown() {}
+
+void test_log2_buckets()
+{
+    TEST_ASSERT_EQUAL_UINT8(0, Log2Hist::bucketOf(0));
+    TEST_ASSERT_EQUAL_UINT8(0, Log2Hist::bucketOf(1));
+    TEST_ASSERT_EQUAL_UINT8(1, Log2Hist::bucketOf(3));
+    TEST_ASSERT_EQUAL_UINT8(10, Log2Hist::bucketOf(1024));
+    TEST_ASSERT_EQUAL_UINT8(10, Log2Hist::bucketOf(2047));
+    TEST_ASSERT_EQUAL_UINT8(31, Log2Hist::bucketOf(0xFFFFFFFFu));
+
+    Log2Hist h;
+    TEST_ASSERT_EQUAL_UINT32(0, h.percentile(50));
+    for (int i = 0; i < 99; i++)
+        h.add(1500); // bucket 10
+    h.add(100000);   // bucket 16
+    TEST_ASSERT_EQUAL_UINT32(100, h.count());
+    TEST_ASSERT_EQUAL_UINT32(99, h.bucket(10));
+    TEST_ASSERT_EQUAL_UINT32(2047, h.percentile(50)); // upper edge of the bucket
+    TEST_ASSERT_EQUAL_UINT32(2047, h.percentile(99));
+    TEST_ASSERT_EQUAL_UINT32(100000, h.percentile(100)); // capped by the exact max
+    TEST_ASSERT_EQUAL_UINT32((99 * 1500 + 100000) / 100, h.mean());
+}
+
+void test_slow_pass_tagged_with_section()
+{
+    Prof p;
+    const uint8_t refresh = p.section("refresh"), radio = p.section("radio");
+    TEST_ASSERT_EQUAL_UINT8(refresh, p.section("refresh"));
+
+    p.beginLoop();
+    p.record(refresh, 500, 1);
+    p.record(radio, 9000, 1);
+    p.endLoop(10000, 1); // 500 cycles outside the sections
+    TEST_ASSERT_EQUAL_UINT32(500, p.other().max());
+
+    const Prof::Offender &w = p.worst(0);
+    TEST_ASSERT_EQUAL_UINT32(10000, w.cycles);
+    TEST_ASSERT_EQUAL_UINT8(Prof::LOOP, w.section);
+    TEST_ASSERT_EQUAL_STRING("radio", p.name(w.tag));
+    TEST_ASSERT_EQUAL_UINT32(9000, p.worst(1).cycles); // the section sample itself
+}
+
+void test_slow_pass_outside_sections()
+{
+    Prof p;
+    const uint8_t refresh = p.section("refresh");
+    p.beginLoop();
+    p.record(refresh, 2000, 5);
+    p.endLoop(60000 * 240 / 1000, 5); // a delay(60) between the sections
+    TEST_ASSERT_EQUAL_STRING("other", p.name(p.worst(0).tag));
+    TEST_ASSERT_EQUAL_STRING("loop", p.name(p.worst(0).section));
+}
+
+void test_worst_list_and_budget()
+{
+    SmallProf p;
+    const uint8_t s = p.section("s");
+    p.setBudget(1000);
+    const uint32_t samples[] = {10, 5000, 20, 3000, 700, 8000, 1200};
+    for (uint32_t c : samples)
+        p.record(s, c, c);
+    TEST_ASSERT_EQUAL_UINT32(8000, p.worst(0).cycles);
+    TEST_ASSERT_EQUAL_UINT32(5000, p.worst(1).cycles);
+    TEST_ASSERT_EQUAL_UINT32(3000, p.worst(2).cycles);
+    TEST_ASSERT_EQUAL_UINT32(8000, p.worst(0).atMs);
+    TEST_ASSERT_EQUAL_UINT32(4, p.overBudget(s));
+
+    // full: further sections are ignored, not mixed up
+    TEST_ASSERT_EQUAL_UINT8(1, p.section("t"));
+    TEST_ASSERT_EQUAL_UINT8(SmallProf::FULL, p.section("u"));
+    p.record(SmallProf::FULL, 99999, 0);
+    TEST_ASSERT_EQUAL_UINT32(8000, p.worst(0).cycles);
+
+    p.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, p.worst(0).cycles);
+    TEST_ASSERT_EQUAL_UINT32(0, p.hist(s).count());
+    p.record(s, 50, 0);
+    TEST_ASSERT_EQUAL_UINT32(50, p.worst(0).cycles);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_log2_buckets);
+    RUN_TEST(test_slow_pass_tagged_with_section);
+    RUN_TEST(test_slow_pass_outside_sections);
+    RUN_TEST(test_worst_list_and_budget);
+    return UNITY_END();
+}
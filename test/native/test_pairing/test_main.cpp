@@ -0,0 +1,163 @@
+// Pairing (Pairing over TxQueue) between two boards on the EspNowSim medium,
+// virtual time: B opens its window while A beacons. While B -> A loses every
+// frame, B's ACCEPT never reaches A, and B must not adopt A on its own; once
+// the link is back, both end paired with each other and persisted. When A's
+// confirming ACCEPT is the frame lost, A answers B's next beacons again.
+//
+//   pio test -e native -f native/test_pairing -v
+
+#include <unity.h>
+#include <Arduino.h>
+#include <esp_now.h>
+#include <Preferences.h>
+#include "FakeHal.h"
+#include "EspNowSim.h"
+#include "TxQueue.h"
+#include "Pairing.h"
+
+static const uint8_t MAC_A[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x01};
+static const uint8_t MAC_B[6] = {0x24, 0x0A, 0xC4, 0x00, 0x00, 0x02};
+
+static bool espNowTx(const uint8_t *mac, const uint8_t *data, uint8_t len)
+{
+    return esp_now_send(mac, data, len) == ESP_OK;
+}
+
+struct Unit
+{
+    TxQueue tx;
+    Pairing pairing;
+    int paired = 0;   // Event::Paired seen
+    int timedOut = 0; // Event::TimedOut seen
+};
+
+static Unit *units[2];
+static Unit &me() { return *units[fake::node()]; }
+
+static void setLinkDead(uint8_t from, uint8_t to, bool dead)
+{
+    EspNowSim::Link l;
+    l.loss = dead ? 1.0 : 0;
+    EspNowSim::instance().setLink(from, to, l);
+}
+
+static void onSent(const uint8_t *mac, esp_now_send_status_t s) { me().tx.onSent(mac, s == ESP_NOW_SEND_SUCCESS); }
+
+static void onRecv(const uint8_t *mac, const uint8_t *data, int len)
+{
+    Proto::Frame f;
+    if (Proto::parse(data, len, f) == Proto::Status::Ok)
+        me().pairing.onRecv(mac, f);
+}
+
+static void setup()
+{
+    esp_now_init();
+    esp_now_register_send_cb(onSent);
+    esp_now_register_recv_cb(onRecv);
+    me().tx.begin(espNowTx, micros);
+    me().pairing.begin(me().tx, CAP_BUZZER);
+}
+
+static void loop()
+{
+    Unit &u = me();
+    u.tx.update();
+    switch (u.pairing.update(millis()))
+    {
+    case Pairing::Event::Paired:
+        u.paired++;
+        break;
+    case Pairing::Event::TimedOut:
+        u.timedOut++;
+        break;
+    case Pairing::Event::None:
+        break;
+    }
+}
+
+static bool savedPeer(uint8_t n, const uint8_t mac[6])
+{
+    fake::setNode(n);
+    Preferences prefs;
+    prefs.begin("pair", true);
+    PairRecord r{};
+    const bool ok = prefs.getBytes("peer", &r, sizeof(r)) == sizeof(r) && memcmp(r.mac, mac, 6) == 0;
+    prefs.end();
+    return ok;
+}
+
+void setUp()
+{
+    units[0] = new Unit;
+    units[1] = new Unit;
+}
+
+void tearDown()
+{
+    delete units[0];
+    delete units[1];
+}
+
+void test_lost_accept_does_not_pair_one_side()
+{
+    EspNowSim &sim = EspNowSim::instance();
+    sim.reset(1);
+    const uint8_t a = sim.addNode(MAC_A, setup, loop);
+    const uint8_t b = sim.addNode(MAC_B, setup, loop);
+    setLinkDead(b, a, true); // B's ACCEPTs (and beacons) never reach A
+    sim.start();
+    sim.at(0, a, [] { me().pairing.start(millis(), 5000); });
+    sim.at(100000, b, [] { me().pairing.start(millis(), 5000); });
+    sim.runUntil(2000000);
+
+    // B heard A's beacons and answered, but nothing confirmed that A got it
+    TEST_ASSERT_EQUAL_INT(0, units[b]->paired);
+    TEST_ASSERT_FALSE(units[b]->pairing.isPaired());
+    TEST_ASSERT_FALSE(units[a]->pairing.isPaired());
+
+    setLinkDead(b, a, false);
+    sim.runUntil(4000000);
+    TEST_ASSERT_EQUAL_INT(1, units[a]->paired);
+    TEST_ASSERT_EQUAL_INT(1, units[b]->paired);
+    TEST_ASSERT_EQUAL_INT(0, units[a]->timedOut + units[b]->timedOut);
+    TEST_ASSERT_EQUAL_MEMORY(MAC_B, units[a]->pairing.peerMac(), 6);
+    TEST_ASSERT_EQUAL_MEMORY(MAC_A, units[b]->pairing.peerMac(), 6);
+    TEST_ASSERT_TRUE(savedPeer(a, MAC_B));
+    TEST_ASSERT_TRUE(savedPeer(b, MAC_A));
+}
+
+void test_lost_confirmation_is_answered_again()
+{
+    EspNowSim &sim = EspNowSim::instance();
+    sim.reset(1);
+    const uint8_t a = sim.addNode(MAC_A, setup, loop);
+    const uint8_t b = sim.addNode(MAC_B, setup, loop);
+    setLinkDead(b, a, true);
+    sim.start();
+    sim.at(0, a, [] { me().pairing.start(millis(), 5000); });
+    sim.at(100000, b, [] { me().pairing.start(millis(), 5000); });
+    sim.runUntil(1000000);
+    // now the other way round: A hears B's ACCEPT, but its answer is lost
+    setLinkDead(b, a, false);
+    setLinkDead(a, b, true);
+    sim.runUntil(1900000);
+
+    // A adopted B on its ACCEPT; B is still waiting for A's
+    TEST_ASSERT_TRUE(units[a]->pairing.isPaired());
+    TEST_ASSERT_FALSE(units[b]->pairing.isPaired());
+
+    setLinkDead(a, b, false);
+    sim.runUntil(3000000); // A answers B's next beacon once more
+    TEST_ASSERT_EQUAL_INT(1, units[b]->paired);
+    TEST_ASSERT_EQUAL_MEMORY(MAC_A, units[b]->pairing.peerMac(), 6);
+    TEST_ASSERT_TRUE(savedPeer(b, MAC_A));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_lost_accept_does_not_pair_one_side);
+    RUN_TEST(test_lost_confirmation_is_answered_again);
+    return UNITY_END();
+}
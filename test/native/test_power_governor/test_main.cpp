@@ -0,0 +1,119 @@
+// Host-side tests for the battery power tiers (PowerGovernor.h): dwell against
+// load sags, hysteresis on the way back up, a full discharge, no cell sensed,
+// booting on a flat cell.
+//
+//   pio test -e native -f native/test_power_governor -v
+
+#include <unity.h>
+#include "PowerGovernor.h"
+
+// Feeds mv every 100 ms for ms; returns the number of tier changes
+static int feed(PowerGovernor &g, uint16_t mv, uint32_t &now, uint32_t ms)
+{
+    int changes = 0;
+    for (uint32_t end = now + ms; now < end; now += 100)
+        changes += g.update(mv, now);
+    return changes;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_starts_full_and_ignores_short_sags()
+{
+    PowerGovernor g;
+    g.begin();
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL_INT(0, feed(g, 4000, now, 5000));
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Full);
+    // buzzer + TX burst pulls the cell down for 3 s
+    TEST_ASSERT_EQUAL_INT(0, feed(g, 3350, now, 3000));
+    TEST_ASSERT_EQUAL_INT(0, feed(g, 4000, now, 1000));
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Full);
+}
+
+void test_discharge_walks_down_the_tiers()
+{
+    PowerGovernor g;
+    g.begin();
+    uint32_t now = 0;
+    feed(g, 4000, now, 1000);
+    feed(g, 3720, now, 9900);
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Full); // dwell not over yet
+    feed(g, 3720, now, 200);
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Eco);
+    feed(g, 3550, now, 11000);
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Low);
+    feed(g, 3300, now, 11000);
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Critical);
+    TEST_ASSERT_EQUAL_UINT32(3, g.changes());
+    TEST_ASSERT_EQUAL_UINT8(0, g.profile().volumePct);
+}
+
+void test_hysteresis_on_the_way_up()
+{
+    PowerGovernor g;
+    g.begin();
+    uint32_t now = 0;
+    feed(g, 3700, now, 11000);
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Eco);
+    // resting just above the threshold after the load goes away: stays Eco
+    TEST_ASSERT_EQUAL_INT(0, feed(g, 3790, now, 30000));
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Eco);
+    // charger plugged in
+    TEST_ASSERT_EQUAL_INT(1, feed(g, 4100, now, 11000));
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Full);
+}
+
+void test_no_cell_sensed_is_full()
+{
+    PowerGovernor g;
+    g.begin();
+    uint32_t now = 0;
+    TEST_ASSERT_EQUAL_INT(0, feed(g, 40, now, 60000)); // divider not fitted, USB powered
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Full);
+}
+
+void test_first_reading_sets_the_tier()
+{
+    PowerGovernor g;
+    g.begin();
+    uint32_t now = 0;
+    TEST_ASSERT_TRUE(g.update(3300, now)); // switched on with a flat cell: no dwell at Full
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Critical);
+    // from then on the dwell and the hysteresis apply
+    TEST_ASSERT_EQUAL_INT(0, feed(g, 3700, now, 5000));
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Critical);
+    TEST_ASSERT_EQUAL_INT(1, feed(g, 3700, now, 6000));
+    TEST_ASSERT_TRUE(g.tier() == PowerTier::Eco);
+
+    g.begin(); // a good cell leaves it at Full, no change reported
+    TEST_ASSERT_FALSE(g.update(4000, now));
+    TEST_ASSERT_EQUAL_UINT32(0, g.changes());
+}
+
+void test_profiles_spend_less_per_tier()
+{
+    for (uint8_t t = 1; t < 4; t++)
+    {
+        const TierProfile &hi = PowerGovernor::profile((PowerTier)(t - 1));
+        const TierProfile &lo = PowerGovernor::profile((PowerTier)t);
+        TEST_ASSERT_TRUE(lo.displayPct <= hi.displayPct);
+        TEST_ASSERT_TRUE(lo.ledPct <= hi.ledPct);
+        TEST_ASSERT_TRUE(lo.volumePct <= hi.volumePct);
+        TEST_ASSERT_TRUE(lo.radioWakeMs >= hi.radioWakeMs);
+        TEST_ASSERT_TRUE(lo.adcPeriodMs >= hi.adcPeriodMs);
+    }
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_starts_full_and_ignores_short_sags);
+    RUN_TEST(test_discharge_walks_down_the_tiers);
+    RUN_TEST(test_hysteresis_on_the_way_up);
+    RUN_TEST(test_no_cell_sensed_is_full);
+    RUN_TEST(test_first_reading_sets_the_tier);
+    RUN_TEST(test_profiles_spend_less_per_tier);
+    return UNITY_END();
+}
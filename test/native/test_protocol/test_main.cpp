@@ -0,0 +1,207 @@
+// Host-side tests and parse-throughput benchmark for the wire format (Protocol.h).
+//
+//   pio test -e native -f native/test_protocol -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "Protocol.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc8_check_value()
+{
+    const uint8_t s[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_UINT8(0xF4, Proto::crc8(s, sizeof(s))); // CRC-8/SMBUS check value
+}
+
+void test_roundtrip_typed_bodies()
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    Proto::Frame f;
+
+    size_t n = Proto::encode(buf, CMD_START, MSG_FLAG_NOACK, 0xBEEF, SignalBody{1234});
+    TEST_ASSERT_EQUAL(sizeof(Proto::Header) + 2, n);
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Ok);
+    TEST_ASSERT_EQUAL_UINT8(CMD_START, f.type());
+    TEST_ASSERT_EQUAL_UINT8(MSG_FLAG_NOACK, f.flags());
+    TEST_ASSERT_EQUAL_UINT16(0xBEEF, f.seq());
+    const SignalBody *s = f.body<SignalBody>();
+    TEST_ASSERT_NOT_NULL(s);
+    TEST_ASSERT_EQUAL_UINT16(1234, s->leaseMs);
+    TEST_ASSERT_TRUE((const uint8_t *)s == buf + sizeof(Proto::Header)); // in place, no copy
+    TEST_ASSERT_NULL(f.body<ChannelBody>());                           // wrong type
+
+    n = Proto::encode(buf, CMD_GROUP, MSG_FLAG_ACK_REQ, 7, GroupBody{3, 0xA1B2C3D4, 4, CMD_STOP, 0});
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Ok);
+    const GroupBody *g = f.body<GroupBody>();
+    TEST_ASSERT_NOT_NULL(g);
+    TEST_ASSERT_EQUAL_UINT32(0xA1B2C3D4, g->origin);
+    TEST_ASSERT_EQUAL_UINT8(4, g->ttl);
+    TEST_ASSERT_EQUAL_UINT8(CMD_STOP, g->inner);
+
+    n = Proto::encode(buf, CMD_ACK, 0, 42);
+    TEST_ASSERT_EQUAL(sizeof(Proto::Header), n);
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Ok);
+    TEST_ASSERT_EQUAL_UINT8(0, f.len);
+    TEST_ASSERT_NULL(f.body<SignalBody>());
+}
+
+void test_rejects_bad_frames()
+{
+    uint8_t buf[Proto::MAX_FRAME + 4];
+    Proto::Frame f;
+    size_t n = Proto::encode(buf, CMD_HEARTBEAT, 0, 1, SignalBody{1000});
+
+    // every truncation
+    for (size_t cut = 0; cut < n; cut++)
+        TEST_ASSERT_TRUE(Proto::parse(buf, (int)cut, f) == Proto::Status::Short);
+
+    // every single-bit flip is caught (by the CRC or an earlier check)
+    for (size_t bit = 0; bit < n * 8; bit++)
+    {
+        buf[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+        TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) != Proto::Status::Ok);
+        buf[bit / 8] ^= (uint8_t)(1u << (bit % 8));
+    }
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Ok);
+
+    // other protocol version
+    uint8_t v[Proto::MAX_FRAME];
+    memcpy(v, buf, n);
+    v[0] = (Proto::TAG & 0xF0) | (Proto::VERSION + 1);
+    TEST_ASSERT_TRUE(Proto::parse(v, (int)n, f) == Proto::Status::Version);
+
+    // body shorter than the type needs (consistent CRC)
+    n = Proto::encode(v, CMD_GROUP, 0, 1, SignalBody{1});
+    TEST_ASSERT_TRUE(Proto::parse(v, (int)n, f) == Proto::Status::Truncated);
+}
+
+void test_legacy_layouts_are_foreign()
+{
+    Proto::Frame f;
+    const uint8_t oldTest[] = {1, 3};                  // {cmd, seconds} (old test.cpp)
+    const uint8_t oldMain[] = {1, 0xE8, 0x03};         // {cmd, uint16 durationMs}
+    const uint8_t oldLink[] = {0x42, 0xE8, 0x03, 9, 0}; // {cmd|NOACK, durationMs, seq}
+    TEST_ASSERT_TRUE(Proto::parse(oldTest, sizeof(oldTest), f) == Proto::Status::Short);
+    TEST_ASSERT_TRUE(Proto::parse(oldMain, sizeof(oldMain), f) == Proto::Status::Short);
+    TEST_ASSERT_TRUE(Proto::parse(oldLink, sizeof(oldLink), f) == Proto::Status::Short);
+    const uint8_t oldGroup[] = {8, 1, 0xD4, 0xC3, 0xB2, 0xA1, 7, 0, 1, 0xE8, 0x03, 2, 4};
+    TEST_ASSERT_TRUE(Proto::parse(oldGroup, sizeof(oldGroup), f) == Proto::Status::Foreign);
+}
+
+void test_unknown_type_skipped_and_longer_body_accepted()
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    Proto::Frame f;
+    size_t n = Proto::encode(buf, 0x7E, 0, 1, GroupBody{});
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Unknown);
+    buf[n - 1] ^= 0xFF; // unknown types are rejected before the CRC is even computed
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Unknown);
+
+    // a later version appends a field to SignalBody: older firmware still reads leaseMs
+    struct __attribute__((packed)) SignalV2
+    {
+        uint16_t leaseMs;
+        uint8_t melody;
+    };
+    n = Proto::encode(buf, CMD_START, 0, 1, SignalV2{500, 3});
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Ok);
+    TEST_ASSERT_EQUAL_UINT16(500, f.body<SignalBody>()->leaseMs);
+}
+
+// a whole alert is one small frame: scene ID + optional params, read in place
+void test_scene_body()
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    Proto::Frame f;
+    size_t n = Proto::encode(buf, CMD_SCENE, 0, 9, SceneBody{6, SCENE_ARG_TEXT | SCENE_ARG_DURATION, 2500, {'O', 'K'}});
+    TEST_ASSERT_EQUAL(13, n);
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Ok);
+    const SceneBody *b = f.body<SceneBody>();
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT8(6, b->scene);
+    TEST_ASSERT_EQUAL_UINT16(2500, b->durationMs);
+    TEST_ASSERT_EQUAL_UINT8('K', b->text[1]);
+    TEST_ASSERT_NULL(f.body<SignalBody>());
+
+    n = Proto::encode(buf, CMD_SCENE, 0, 10, b, 2); // ID and args only
+    TEST_ASSERT_TRUE(Proto::parse(buf, (int)n, f) == Proto::Status::Truncated);
+}
+
+// ---- Throughput ----
+
+template <typename F>
+static double nsPerCall(F fn, int iters)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iters; i++)
+        fn(i);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iters;
+}
+
+void test_parse_throughput()
+{
+    static const int ITERS = 2000000;
+    const int K = 64; // distinct frames so the branch predictor cannot learn one
+    std::vector<std::vector<uint8_t>> ok(K), foreign(K), unknown(K);
+    for (int i = 0; i < K; i++)
+    {
+        uint8_t b[Proto::MAX_FRAME];
+        size_t n = Proto::encode(b, CMD_GROUP, 0, (uint16_t)i, GroupBody{1, (uint32_t)i * 2654435761u, 4, CMD_START, 1000});
+        ok[i].assign(b, b + n);
+        n = Proto::encode(b, (uint8_t)(0x40 + i), 0, (uint16_t)i, GroupBody{});
+        unknown[i].assign(b, b + n);
+        foreign[i] = ok[i];
+        foreign[i][0] = 0x08; // other ESP-NOW traffic
+    }
+
+    volatile uint32_t sink = 0;
+    auto run = [&](std::vector<std::vector<uint8_t>> &frames)
+    {
+        return nsPerCall([&](int i)
+                         {
+                             const std::vector<uint8_t> &b = frames[i & (K - 1)];
+                             Proto::Frame f;
+                             if (Proto::parse(b.data(), (int)b.size(), f) == Proto::Status::Ok)
+                                 sink += f.body<GroupBody>()->origin;
+                             else
+                                 sink++; },
+                         ITERS);
+    };
+    double tOk = run(ok), tForeign = run(foreign), tUnknown = run(unknown);
+    double tCrc = nsPerCall([&](int i)
+                            {
+                                const std::vector<uint8_t> &b = ok[i & (K - 1)];
+                                sink += Proto::crc8(b.data(), b.size()); },
+                            ITERS);
+    (void)sink;
+
+    size_t bytes = ok[0].size();
+    printf("\nparse, %d calls, %zu-byte group frames (host build)\n", ITERS, bytes);
+    printf("%-16s %8s %12s\n", "frame", "ns", "frames/s");
+    printf("%-16s %8.1f %12.0f  (%.0f MB/s)\n", "valid group", tOk, 1e9 / tOk, bytes * 1e3 / tOk);
+    printf("%-16s %8.1f %12.0f\n", "foreign", tForeign, 1e9 / tForeign);
+    printf("%-16s %8.1f %12.0f\n", "unknown type", tUnknown, 1e9 / tUnknown);
+    printf("%-16s %8.1f %12.0f\n", "crc8 only", tCrc, 1e9 / tCrc);
+
+    // rejecting foreign / unknown frames never pays for the CRC
+    TEST_ASSERT_TRUE(tForeign < tOk);
+    TEST_ASSERT_TRUE(tUnknown < tOk);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc8_check_value);
+    RUN_TEST(test_roundtrip_typed_bodies);
+    RUN_TEST(test_rejects_bad_frames);
+    RUN_TEST(test_legacy_layouts_are_foreign);
+    RUN_TEST(test_unknown_type_skipped_and_longer_body_accepted);
+    RUN_TEST(test_scene_body);
+    RUN_TEST(test_parse_throughput);
+    return UNITY_END();
+}
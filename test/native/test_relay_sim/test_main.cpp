@@ -0,0 +1,424 @@
+// Host-side simulator for relay mode (GroupLink range extension).
+//
+// An origin floods one group message (BLIND_COPIES broadcasts, no ACKs) through a
+// layout of units that all run the real RelayCore (seen-cache, TTL, jitter,
+// copy-count suppression). Reported per configuration:
+//   deliv     messages that reached every unit
+//   far p50/p99  time until the farthest unit has it
+//   per-hop   mean latency of the units N hops away (shortest path over good links)
+//   tx / redundant   frames on air per message / frames that gave nobody a new copy
+//   coll      receptions destroyed by overlapping frames
+//
+// Radio model: 1 Mbit/s frames (see test_group_scaling), range 1.0, loss grows
+// quadratically from `base` at half range to 100% at full range. CSMA/CA: a unit
+// defers while it senses a frame (same range) and then waits DIFS + a random
+// backoff; overlapping frames at a receiver destroy each other (hidden terminals),
+// and a unit cannot receive while it transmits.
+//
+//   pio test -e native -f native/test_relay_sim -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <queue>
+#include <vector>
+#include "RelayCore.h"
+#include "GroupAcks.h"
+#include "Protocol.h"
+
+static const double PLCP_US = 192.0, US_PER_BYTE = 8.0, ESPNOW_OVERHEAD = 43;
+static const double DIFS_US = 50.0, SLOT_US = 20.0;
+static const int CW_SLOTS = 16;
+static const double FRAME_US = PLCP_US + (ESPNOW_OVERHEAD + sizeof(Proto::Header) + sizeof(GroupBody)) * US_PER_BYTE;
+static const double BASE_LOSS = 0.02;
+
+struct Rng
+{
+    uint32_t s;
+    uint32_t next()
+    {
+        s ^= s << 13;
+        s ^= s >> 17;
+        s ^= s << 5;
+        return s;
+    }
+    double uniform() { return (next() & 0xFFFFFF) / double(0x1000000); }
+};
+
+struct Frame
+{
+    uint32_t origin;
+    uint16_t seq;
+    uint8_t ttl;
+};
+
+struct Config
+{
+    const char *name;
+    bool relay;
+    uint8_t ttl;
+    uint32_t jitterUs;
+    uint8_t suppress;
+    uint8_t retries;
+};
+
+struct Layout
+{
+    const char *name;
+    std::vector<double> x, y;
+};
+
+static Layout corridor(int n, double spacing)
+{
+    Layout l{"corridor", {}, {}};
+    for (int i = 0; i < n; i++)
+    {
+        l.x.push_back(i * spacing);
+        l.y.push_back(0);
+    }
+    return l;
+}
+
+static Layout grid(int side, double spacing)
+{
+    Layout l{"warehouse", {}, {}};
+    for (int r = 0; r < side; r++)
+        for (int c = 0; c < side; c++)
+        {
+            l.x.push_back(c * spacing);
+            l.y.push_back(r * spacing);
+        }
+    return l;
+}
+
+class Sim
+{
+public:
+    Sim(const Layout &l, const Config &c, uint32_t seed) : _l(l), _c(c), _rng{seed}, _n((int)l.x.size())
+    {
+        _nodes.resize(_n);
+        for (auto &r : _nodes)
+        {
+            r.setEnabled(c.relay);
+            r.setJitter(c.jitterUs);
+            r.setSuppressAfter(c.suppress);
+            r.setRetries(c.retries, GroupPolicy::RELAY_ECHO_MS * 1000u);
+        }
+        // hop distance over good links (< 75% of range)
+        _hops.assign(_n, -1);
+        _hops[0] = 0;
+        std::vector<int> q{0};
+        for (size_t i = 0; i < q.size(); i++)
+            for (int j = 0; j < _n; j++)
+                if (_hops[j] < 0 && dist(q[i], j) < 0.75)
+                {
+                    _hops[j] = _hops[q[i]] + 1;
+                    q.push_back(j);
+                }
+    }
+
+    double dist(int a, int b) const { return hypot(_l.x[a] - _l.x[b], _l.y[a] - _l.y[b]); }
+    int hops(int i) const { return _hops[i]; }
+    int far() const { return (int)(std::max_element(_hops.begin(), _hops.end()) - _hops.begin()); }
+
+    struct Result
+    {
+        std::vector<double> got; // first copy per unit (us), -1 = never
+        int tx = 0, redundant = 0, collisions = 0;
+    };
+
+    Result run(uint16_t seq)
+    {
+        Result res;
+        res.got.assign(_n, -1);
+        res.got[0] = 0;
+        _tx.clear();
+        _nodes[0].markSeen(ORIGIN, seq);
+
+        // origin: BLIND_COPIES broadcasts with the GroupLink backoff
+        double t = 0, rto = GroupPolicy::RTO_MS * 1000.0;
+        for (int c = 0; c < GroupPolicy::BLIND_COPIES; c++)
+        {
+            push({t, Ev::Attempt, 0, Frame{ORIGIN, seq, _c.ttl}, -1});
+            t += rto;
+            rto = std::min(rto * 2, GroupPolicy::RTO_MAX_MS * 1000.0);
+        }
+
+        while (!_q.empty())
+        {
+            Ev e = _q.top();
+            _q.pop();
+            if (e.kind == Ev::Attempt)
+                attempt(e);
+            else if (e.kind == Ev::Poll)
+                poll(e.node, e.t);
+            else
+                deliver(e, res);
+        }
+        return res;
+    }
+
+private:
+    static const uint32_t ORIGIN = 0xA1B2C3D4;
+
+    struct Ev
+    {
+        enum Kind
+        {
+            Attempt, // node wants to transmit `f`
+            End,     // transmission `tx` ends: evaluate receivers
+            Poll     // a relay's jitter may have elapsed
+        };
+        double t;
+        Kind kind;
+        int node;
+        Frame f;
+        int tx;
+        bool operator<(const Ev &o) const { return t > o.t; }
+    };
+
+    struct Tx
+    {
+        int node;
+        double start, end;
+        Frame f;
+    };
+
+    void push(const Ev &e) { _q.push(e); }
+
+    // CSMA/CA: transmit now if the medium has been idle for DIFS, else defer
+    void attempt(const Ev &e)
+    {
+        double busyUntil = -1;
+        for (const Tx &x : _tx)
+            if ((x.node == e.node || dist(x.node, e.node) <= 1.0) && x.start <= e.t && e.t < x.end + DIFS_US)
+                busyUntil = std::max(busyUntil, x.end);
+        if (busyUntil >= 0)
+        {
+            double backoff = (_rng.next() % CW_SLOTS) * SLOT_US;
+            push({busyUntil + DIFS_US + backoff, Ev::Attempt, e.node, e.f, -1});
+            return;
+        }
+        _tx.push_back(Tx{e.node, e.t, e.t + FRAME_US, e.f});
+        push({e.t + FRAME_US, Ev::End, e.node, e.f, (int)_tx.size() - 1});
+    }
+
+    void deliver(const Ev &e, Result &res)
+    {
+        const Tx &x = _tx[e.tx];
+        res.tx++;
+        bool useful = false;
+        for (int r = 0; r < _n; r++)
+        {
+            if (r == x.node)
+                continue;
+            double d = dist(x.node, r);
+            if (d > 1.0)
+                continue;
+            bool collided = false;
+            for (size_t k = 0; k < _tx.size() && !collided; k++)
+            {
+                const Tx &o = _tx[k];
+                if ((int)k == e.tx || o.end <= x.start || o.start >= x.end)
+                    continue;
+                collided = o.node == r || dist(o.node, r) <= 1.0;
+            }
+            if (collided)
+            {
+                res.collisions++;
+                continue;
+            }
+            double over = std::max(0.0, (d - 0.5) / 0.5);
+            if (_rng.uniform() < BASE_LOSS + (1 - BASE_LOSS) * over * over)
+                continue;
+            if (_nodes[r].onFrame(x.f.origin, x.f.seq, x.f.ttl, x.f, (uint32_t)e.t, _rng.next()))
+            {
+                res.got[r] = e.t;
+                useful = true;
+                uint32_t due = 0;
+                if (_nodes[r].nextDue((uint32_t)e.t, due))
+                    push({(double)due, Ev::Poll, r, Frame{}, -1});
+            }
+        }
+        if (!useful)
+            res.redundant++;
+    }
+
+    void poll(int node, double t)
+    {
+        RelayCore<Frame, 32, 4>::Out o;
+        while (_nodes[node].poll((uint32_t)t, o))
+        {
+            o.frame.ttl = o.ttl;
+            push({t, Ev::Attempt, node, o.frame, -1});
+        }
+        uint32_t due = 0;
+        if (_nodes[node].nextDue((uint32_t)t, due)) // waiting for an echo
+            push({(double)due, Ev::Poll, node, Frame{}, -1});
+    }
+
+    const Layout &_l;
+    Config _c;
+    Rng _rng;
+    int _n;
+    std::vector<RelayCore<Frame, 32, 4>> _nodes;
+    std::vector<int> _hops;
+    std::vector<Tx> _tx;
+    std::priority_queue<Ev> _q;
+};
+
+struct Summary
+{
+    double deliveredPct, farPct, farP50Ms, farP99Ms, tx, redundant, collisions;
+    std::vector<double> hopMs; // mean latency per hop distance
+};
+
+static const int TRIALS = 2000;
+
+static Summary bench(const Layout &l, const Config &c)
+{
+    Sim sim(l, c, 0xC0FFEEu);
+    int n = (int)l.x.size(), far = sim.far(), maxHop = sim.hops(far);
+    std::vector<double> farLat, hopSum(maxHop + 1, 0);
+    std::vector<int> hopN(maxHop + 1, 0);
+    Summary s{};
+    int all = 0;
+    for (int i = 0; i < TRIALS; i++)
+    {
+        Sim::Result r = sim.run((uint16_t)i);
+        bool every = true;
+        for (int u = 0; u < n; u++)
+        {
+            if (r.got[u] < 0)
+            {
+                every = false;
+                continue;
+            }
+            hopSum[sim.hops(u)] += r.got[u];
+            hopN[sim.hops(u)]++;
+        }
+        all += every;
+        if (r.got[far] >= 0)
+            farLat.push_back(r.got[far]);
+        s.tx += r.tx;
+        s.redundant += r.redundant;
+        s.collisions += r.collisions;
+    }
+    std::sort(farLat.begin(), farLat.end());
+    auto pct = [&](double q)
+    { return farLat.empty() ? 0.0 : farLat[std::min(farLat.size() - 1, (size_t)(q * farLat.size()))] / 1000.0; };
+    s.deliveredPct = 100.0 * all / TRIALS;
+    s.farPct = 100.0 * farLat.size() / TRIALS;
+    s.farP50Ms = pct(0.50);
+    s.farP99Ms = pct(0.99);
+    s.tx /= TRIALS;
+    s.redundant /= TRIALS;
+    s.collisions /= TRIALS;
+    for (int h = 0; h <= maxHop; h++)
+        s.hopMs.push_back(hopN[h] ? hopSum[h] / hopN[h] / 1000.0 : -1);
+    return s;
+}
+
+static void header(const Layout &l)
+{
+    printf("\n%s: %zu units, %d trials, origin floods %u copies\n", l.name, l.x.size(), TRIALS,
+           GroupPolicy::BLIND_COPIES);
+    printf("%-16s %7s %7s %8s %8s %6s %6s %6s  per-hop mean ms (hop 1..)\n",
+           "config", "deliv", "far", "p50 ms", "p99 ms", "tx", "redund", "coll");
+}
+
+static void print(const Config &c, const Summary &s)
+{
+    printf("%-16s %6.1f%% %6.1f%% %8.2f %8.2f %6.1f %6.1f %6.2f ", c.name, s.deliveredPct, s.farPct,
+           s.farP50Ms, s.farP99Ms, s.tx, s.redundant, s.collisions);
+    for (size_t h = 1; h < s.hopMs.size(); h++)
+        if (s.hopMs[h] < 0)
+            printf("     -");
+        else
+            printf(" %5.2f", s.hopMs[h]);
+    printf("\n");
+}
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t JITTER_US = GroupPolicy::RELAY_JITTER_MS * 1000u;
+
+void test_relay_corridor()
+{
+    // 8 units in a line, neighbours at 60% of range: only the next unit is reachable
+    Layout l = corridor(8, 0.6);
+    using namespace GroupPolicy;
+    Config off{"no relay", false, 8, JITTER_US, 0, 0};
+    Config shortTtl{"relay ttl=4", true, 4, JITTER_US, RELAY_SUPPRESS, RELAY_RETRIES};
+    Config once{"ttl=8 no echo", true, 8, JITTER_US, RELAY_SUPPRESS, 0};
+    Config on{"ttl=8", true, 8, JITTER_US, RELAY_SUPPRESS, RELAY_RETRIES};
+    header(l);
+    Summary sOff = bench(l, off), sShort = bench(l, shortTtl), sOnce = bench(l, once), sOn = bench(l, on);
+    print(off, sOff);
+    print(shortTtl, sShort);
+    print(once, sOnce);
+    print(on, sOn);
+
+    TEST_ASSERT_TRUE(sOff.farPct == 0.0);   // out of range without relays
+    TEST_ASSERT_TRUE(sShort.farPct == 0.0); // TTL bounds the flood
+    TEST_ASSERT_TRUE(sOn.deliveredPct >= 99.0); // 7 hops, each one repaired by the passive ACK
+    TEST_ASSERT_TRUE(sOn.deliveredPct > sOnce.deliveredPct);
+    // latency grows roughly linearly: every hop adds at most airtime + jitter
+    for (size_t h = 2; h < sOn.hopMs.size(); h++)
+        TEST_ASSERT_TRUE(sOn.hopMs[h] - sOn.hopMs[h - 1] < GroupPolicy::RELAY_JITTER_MS + 1.0);
+}
+
+void test_relay_warehouse()
+{
+    // 5 x 5 units at 45% of range: many relays hear every frame
+    Layout l = grid(5, 0.45);
+    using namespace GroupPolicy;
+    Config noJitter{"no jitter", true, 8, 0, 0, RELAY_RETRIES};
+    Config flood{"jitter", true, 8, JITTER_US, 0, RELAY_RETRIES};
+    Config suppress{"jitter+suppress", true, 8, JITTER_US, RELAY_SUPPRESS, RELAY_RETRIES};
+    header(l);
+    Summary a = bench(l, noJitter), b = bench(l, flood), c = bench(l, suppress);
+    print(noJitter, a);
+    print(flood, b);
+    print(suppress, c);
+
+    // jitter spreads rebroadcasts of neighbours that heard the same frame
+    TEST_ASSERT_TRUE(b.collisions < a.collisions);
+    // suppression cuts redundant rebroadcasts without losing coverage
+    TEST_ASSERT_TRUE(c.tx < 0.8 * b.tx);
+    TEST_ASSERT_TRUE(c.deliveredPct >= 98.0);
+}
+
+void test_relay_core_ttl_and_suppression()
+{
+    RelayCore<Frame, 8, 2> r;
+    r.setEnabled(true);
+    r.setJitter(0);
+    r.setSuppressAfter(2);
+    RelayCore<Frame, 8, 2>::Out o{};
+
+    TEST_ASSERT_TRUE(r.onFrame(1, 10, 1, Frame{1, 10, 1}, 0, 0)); // ttl 1: deliver, do not relay
+    TEST_ASSERT_FALSE(r.poll(0, o));
+
+    TEST_ASSERT_TRUE(r.onFrame(1, 11, 3, Frame{1, 11, 3}, 0, 0));
+    TEST_ASSERT_FALSE(r.onFrame(1, 11, 3, Frame{1, 11, 3}, 0, 0)); // duplicate
+    TEST_ASSERT_TRUE(r.poll(0, o));
+    TEST_ASSERT_EQUAL_UINT8(2, o.ttl);
+
+    TEST_ASSERT_TRUE(r.onFrame(1, 12, 3, Frame{1, 12, 3}, 100, 0));
+    r.onFrame(1, 12, 2, Frame{1, 12, 2}, 100, 0);
+    r.onFrame(1, 12, 2, Frame{1, 12, 2}, 100, 0); // second copy heard -> suppressed
+    TEST_ASSERT_FALSE(r.poll(100, o));
+    TEST_ASSERT_EQUAL_UINT32(1, r.stats().suppressed);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_relay_core_ttl_and_suppression);
+    RUN_TEST(test_relay_corridor);
+    RUN_TEST(test_relay_warehouse);
+    return UNITY_END();
+}
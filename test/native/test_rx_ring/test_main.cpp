@@ -0,0 +1,112 @@
+// Host-side tests for the receive ring (RxRing.h): FIFO order, overflow
+// accounting, and a two-thread producer/consumer stress run.
+//
+//   pio test -e native -f native/test_rx_ring -v
+
+#include <unity.h>
+#include <stdio.h>
+#include <thread>
+#include "RxRing.h"
+
+static const uint8_t MAC[6] = {1, 2, 3, 4, 5, 6};
+
+static size_t frameFor(uint16_t seq, uint8_t *buf)
+{
+    return Proto::encode(buf, CMD_HEARTBEAT, MSG_FLAG_NOACK, seq, SignalBody{(uint16_t)(seq ^ 0x5A5A)});
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_fifo_and_overflow()
+{
+    RxRing<4> rx;
+    uint8_t buf[Proto::MAX_FRAME];
+    TEST_ASSERT_NULL(rx.front());
+
+    for (uint16_t s = 0; s < 6; s++)
+        rx.push(MAC, buf, (int)frameFor(s, buf), -40 - s, 1000u + s);
+    TEST_ASSERT_EQUAL(4, rx.size());
+    TEST_ASSERT_EQUAL_UINT32(4, rx.stats().pushed);
+    TEST_ASSERT_EQUAL_UINT32(2, rx.stats().overflow); // the newest two were dropped
+    TEST_ASSERT_EQUAL_UINT32(4, rx.stats().highWater);
+
+    for (uint16_t s = 0; s < 4; s++)
+    {
+        const RxMsg *m = rx.front();
+        TEST_ASSERT_NOT_NULL(m);
+        Proto::Frame f = m->frame();
+        TEST_ASSERT_EQUAL_UINT16(s, f.seq());
+        TEST_ASSERT_EQUAL_UINT16(s ^ 0x5A5A, f.body<SignalBody>()->leaseMs);
+        TEST_ASSERT_EQUAL(-40 - s, m->rssi);
+        TEST_ASSERT_EQUAL_UINT32(1000u + s, m->atUs);
+        TEST_ASSERT_EQUAL_MEMORY(MAC, m->mac, 6);
+        rx.pop();
+    }
+    TEST_ASSERT_NULL(rx.front());
+    rx.pop(); // popping an empty ring is harmless
+    TEST_ASSERT_EQUAL(0, rx.size());
+
+    uint8_t big[Proto::MAX_FRAME + 1] = {0};
+    TEST_ASSERT_FALSE(rx.push(MAC, big, sizeof(big), 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(1, rx.stats().oversize);
+}
+
+void test_two_thread_burst()
+{
+    // producer = Wi-Fi task, consumer = loop(); every frame must arrive intact and
+    // in order, and delivered + overflow must account for every push
+    static RxRing<16> rx;
+    static const uint32_t FRAMES = 1000000;
+
+    // bursts of 24 back-to-back frames (more than the ring holds), then a gap
+    // until loop() has caught up
+    std::thread producer([]
+                         {
+                             uint8_t buf[Proto::MAX_FRAME];
+                             for (uint32_t i = 0; i < FRAMES; i++)
+                             {
+                                 rx.push(MAC, buf, (int)frameFor((uint16_t)i, buf), 0, i);
+                                 if (i % 24 == 23)
+                                     while (rx.size() > 2)
+                                         std::this_thread::yield();
+                             } });
+
+    uint32_t delivered = 0, corrupt = 0, outOfOrder = 0;
+    int64_t last = -1;
+    while (true)
+    {
+        const RxMsg *m = rx.front();
+        if (!m)
+        {
+            if (delivered + __atomic_load_n(&rx.stats().overflow, __ATOMIC_RELAXED) == FRAMES)
+                break;
+            std::this_thread::yield();
+            continue;
+        }
+        Proto::Frame f;
+        if (Proto::parse(m->data, m->len, f) != Proto::Status::Ok || (uint16_t)m->atUs != f.seq())
+            corrupt++;
+        if ((int64_t)m->atUs <= last)
+            outOfOrder++;
+        last = m->atUs;
+        delivered++;
+        rx.pop();
+    }
+    producer.join();
+
+    printf("\n%lu frames: delivered=%lu overflow=%lu peak=%lu/%u\n", (unsigned long)FRAMES,
+           (unsigned long)delivered, (unsigned long)rx.stats().overflow,
+           (unsigned long)rx.stats().highWater, (unsigned)rx.capacity());
+    TEST_ASSERT_EQUAL_UINT32(0, corrupt);
+    TEST_ASSERT_EQUAL_UINT32(0, outOfOrder);
+    TEST_ASSERT_EQUAL_UINT32(FRAMES, delivered + rx.stats().overflow);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_and_overflow);
+    RUN_TEST(test_two_thread_burst);
+    return UNITY_END();
+}
@@ -0,0 +1,205 @@
+// Host-side tests for the scene compositor (ScenePlayer) on the FakeArduino
+// HAL: one call starts display, LEDs and buzzer from the same tick, timed
+// scenes end by themselves, priorities, held scenes resume after an
+// interruption, teardown only resets the outputs a scene owns, and
+// per-call params (remote CMD_SCENE requests).
+//
+//   pio test -e native -f native/test_scenes -v
+
+#include <unity.h>
+#include <Arduino.h>
+#include "FakeHal.h"
+#include "ScenePlayer.h"
+
+// what refresh() would paint
+struct TextProbe : SevenSegmentText
+{
+    bool shows(const char *s) const
+    {
+        char l, r;
+        visiblePair(l, r);
+        return l == s[0] && r == s[1];
+    }
+};
+
+enum : uint8_t
+{
+    SIGNAL = 1,
+    ALERT,
+    PAIRED,
+    LOW_BATT,
+    COUNT
+};
+static const SceneDesc SCENES[COUNT] = {
+    {},
+    {SCENE_LEDS | SCENE_SOUND | SCENE_TEXT | SCENE_REPEAT, 1, 0, "HI", 300, TriLeds::Anim::ChaseGYR, 150,
+     BuiltInMelody::BEEP_BEEP},
+    {SCENE_SOUND | SCENE_TEXT, 2, 1000, "AL", 0, TriLeds::Anim::Off, 0, BuiltInMelody::SCALE_UP},
+    {SCENE_SOUND | SCENE_TEXT | SCENE_COSMETIC, 1, 1500, "OK", 0, TriLeds::Anim::Off, 0, BuiltInMelody::SCALE_UP},
+    {SCENE_TEXT, 3, 0, "Lo", 400, TriLeds::Anim::Off, 0, BuiltInMelody::BEEP_BEEP},
+};
+
+static TextProbe disp;
+static TriLeds leds;
+static Buzzer buzz;
+static ScenePlayer scenes;
+
+void setUp()
+{
+    fake::reset(1000000);
+    disp = TextProbe();
+    leds = TriLeds();
+    buzz = Buzzer();
+    leds.init(27, 14, 19, true, true);
+    buzz.init(5);
+    scenes = ScenePlayer();
+    scenes.begin(SCENES, COUNT, disp, leds, buzz);
+}
+void tearDown() {}
+
+void test_outputs_start_together()
+{
+    // the call lands late in a loop pass: every output counts from the tick it was given
+    const uint32_t t0 = millis();
+    fake::advanceMs(7);
+    TEST_ASSERT_TRUE(scenes.play(SIGNAL, t0));
+    TEST_ASSERT_EQUAL_UINT8(SIGNAL, scenes.current());
+    TEST_ASSERT_TRUE(buzz.isPlaying());
+    TEST_ASSERT_TRUE(leds.isActive());
+    TEST_ASSERT_TRUE(disp.shows("HI"));
+
+    // blinking: half of the 300 ms period after t0, not after the call
+    fake::setTime((uint64_t)(t0 + 149) * 1000);
+    disp.updateBlinking();
+    TEST_ASSERT_TRUE(disp.shows("HI"));
+    fake::setTime((uint64_t)(t0 + 150) * 1000);
+    disp.updateBlinking();
+    TEST_ASSERT_TRUE(disp.shows("  "));
+
+    TEST_ASSERT_FALSE(scenes.play(0, t0));     // "none"
+    TEST_ASSERT_FALSE(scenes.play(COUNT, t0)); // not in the table
+    TEST_ASSERT_EQUAL_UINT8(SIGNAL, scenes.current());
+}
+
+void test_timed_scene_ends()
+{
+    const uint32_t t0 = millis();
+    scenes.play(PAIRED, t0);
+    TEST_ASSERT_TRUE(disp.shows("OK"));
+    scenes.update(t0 + 1499);
+    TEST_ASSERT_TRUE(scenes.isActive());
+    scenes.update(t0 + 1500);
+    TEST_ASSERT_FALSE(scenes.isActive());
+    TEST_ASSERT_TRUE(disp.shows("  "));
+    TEST_ASSERT_FALSE(buzz.isPlaying());
+
+    // held scenes only end on stop()
+    scenes.play(LOW_BATT, t0);
+    scenes.update(t0 + 60000);
+    TEST_ASSERT_EQUAL_UINT8(LOW_BATT, scenes.current());
+    scenes.stop(LOW_BATT, t0 + 60000);
+    TEST_ASSERT_FALSE(scenes.isActive());
+}
+
+void test_priority()
+{
+    const uint32_t t0 = millis();
+    scenes.play(LOW_BATT, t0);
+    TEST_ASSERT_FALSE(scenes.play(SIGNAL, t0)); // lower: refused
+    TEST_ASSERT_TRUE(disp.shows("Lo"));
+    TEST_ASSERT_FALSE(buzz.isPlaying());
+    scenes.stop(SIGNAL, t0); // not running: no effect
+    TEST_ASSERT_EQUAL_UINT8(LOW_BATT, scenes.current());
+
+    scenes.stop(LOW_BATT, t0);
+    scenes.play(SIGNAL, t0);
+    TEST_ASSERT_TRUE(scenes.play(PAIRED, t0)); // same priority replaces
+    TEST_ASSERT_EQUAL_UINT8(PAIRED, scenes.current());
+    TEST_ASSERT_FALSE(leds.isActive()); // SIGNAL's LEDs reset, PAIRED doesn't use them
+    scenes.update(t0 + 1500);
+    TEST_ASSERT_FALSE(scenes.isActive()); // replaced, not interrupted: SIGNAL does not come back
+}
+
+void test_held_scene_resumes()
+{
+    const uint32_t t0 = millis();
+    scenes.play(SIGNAL, t0);
+    TEST_ASSERT_TRUE(scenes.play(ALERT, t0 + 100)); // higher, timed: SIGNAL waits
+    TEST_ASSERT_TRUE(disp.shows("AL"));
+    TEST_ASSERT_FALSE(leds.isActive());
+    scenes.update(t0 + 1100);
+    TEST_ASSERT_EQUAL_UINT8(SIGNAL, scenes.current());
+    TEST_ASSERT_TRUE(disp.shows("HI"));
+    TEST_ASSERT_TRUE(leds.isActive());
+    TEST_ASSERT_TRUE(buzz.isPlaying());
+
+    // the lease ended during the interruption: nothing to resume
+    scenes.play(ALERT, t0 + 2000);
+    scenes.stop(SIGNAL, t0 + 2500);
+    scenes.update(t0 + 3000);
+    TEST_ASSERT_FALSE(scenes.isActive());
+}
+
+void test_teardown_leaves_other_outputs()
+{
+    const uint32_t t0 = millis();
+    buzz.play(BuiltInMelody::TWINKLE, true); // someone else's sound
+    leds.playLEDAnim(TriLeds::Anim::ChaseGYR);
+    scenes.play(LOW_BATT, t0);
+    scenes.stop(LOW_BATT, t0 + 10);
+    TEST_ASSERT_TRUE(disp.shows("  "));
+    TEST_ASSERT_TRUE(buzz.isPlaying());
+    TEST_ASSERT_TRUE(leds.isActive());
+}
+
+void test_cosmetic_sound()
+{
+    const uint32_t t0 = millis();
+    scenes.setCosmeticSound(false); // battery tier: alerts only
+    scenes.play(PAIRED, t0);
+    TEST_ASSERT_TRUE(disp.shows("OK"));
+    TEST_ASSERT_FALSE(buzz.isPlaying());
+    scenes.play(SIGNAL, t0); // not cosmetic: always sounds
+    TEST_ASSERT_TRUE(buzz.isPlaying());
+}
+
+// remote requests: the table scene with a new duration / text, for this play() only
+void test_params()
+{
+    const uint32_t t0 = millis();
+    SceneParams p;
+    p.durationMs = 500;
+    p.text = "AB"; // CMD_SCENE: two bytes, not NUL-terminated
+    scenes.play(PAIRED, t0, p);
+    TEST_ASSERT_TRUE(disp.shows("AB"));
+    scenes.update(t0 + 500);
+    TEST_ASSERT_FALSE(scenes.isActive());
+
+    scenes.play(PAIRED, t0 + 1000); // the table is unchanged
+    TEST_ASSERT_TRUE(disp.shows("OK"));
+    scenes.update(t0 + 2000);
+    TEST_ASSERT_TRUE(scenes.isActive());
+
+    // held (duration 0) under an interruption: resumes with its params
+    p.durationMs = 0;
+    p.text = "C";
+    scenes.play(SIGNAL, t0 + 3000, p);
+    TEST_ASSERT_TRUE(disp.shows("C "));
+    scenes.play(ALERT, t0 + 3000);
+    scenes.update(t0 + 4000);
+    TEST_ASSERT_EQUAL_UINT8(SIGNAL, scenes.current());
+    TEST_ASSERT_TRUE(disp.shows("C "));
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_outputs_start_together);
+    RUN_TEST(test_timed_scene_ends);
+    RUN_TEST(test_priority);
+    RUN_TEST(test_held_scene_resumes);
+    RUN_TEST(test_teardown_leaves_other_outputs);
+    RUN_TEST(test_cosmetic_sound);
+    RUN_TEST(test_params);
+    return UNITY_END();
+}
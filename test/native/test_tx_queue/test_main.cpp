@@ -0,0 +1,192 @@
+// Host-side tests for the send queue (TxQueue.h) with a fake driver and clock:
+// one frame in flight per peer, per-peer FIFO, coalescing, timeouts, stats.
+//
+//   pio test -e native -f native/test_tx_queue -v
+
+#include <unity.h>
+#include "TxQueue.h"
+
+static const uint8_t A[6] = {1, 1, 1, 1, 1, 1};
+static const uint8_t B[6] = {2, 2, 2, 2, 2, 2};
+
+// ---- fake driver / clock ----
+struct Sent
+{
+    uint8_t mac[6];
+    uint16_t seq;
+};
+static Sent g_sent[64];
+static int g_nSent = 0;
+static bool g_fail = false;
+static uint32_t g_now = 0;
+
+static bool fakeTx(const uint8_t *mac, const uint8_t *data, uint8_t len)
+{
+    if (g_fail)
+        return false;
+    Proto::Frame f;
+    TEST_ASSERT_TRUE(Proto::parse(data, len, f) == Proto::Status::Ok);
+    memcpy(g_sent[g_nSent].mac, mac, 6);
+    g_sent[g_nSent].seq = f.seq();
+    g_nSent++;
+    return true;
+}
+static uint32_t fakeClock() { return g_now; }
+
+static void queue(TxQueue &q, const uint8_t *mac, uint16_t seq, uint16_t key = TxQueue::NO_COALESCE)
+{
+    uint8_t buf[Proto::MAX_FRAME];
+    size_t n = Proto::encode(buf, CMD_HEARTBEAT, 0, seq, SignalBody{1000});
+    q.send(mac, buf, (uint8_t)n, key);
+}
+
+// onSent() from the "Wi-Fi task", then loop() retires it
+static void complete(TxQueue &q, const uint8_t *mac, bool ok = true)
+{
+    q.onSent(mac, ok);
+    q.update();
+}
+
+void setUp()
+{
+    g_nSent = 0;
+    g_fail = false;
+    g_now = 0;
+}
+void tearDown() {}
+
+void test_one_in_flight_per_peer()
+{
+    TxQueue q;
+    q.begin(fakeTx, fakeClock);
+    queue(q, A, 1);
+    queue(q, A, 2);
+    queue(q, B, 10);
+    queue(q, A, 3);
+    // A's first frame and B's frame go out at once, A's others wait
+    TEST_ASSERT_EQUAL(2, g_nSent);
+    TEST_ASSERT_EQUAL_UINT16(1, g_sent[0].seq);
+    TEST_ASSERT_EQUAL_UINT16(10, g_sent[1].seq);
+    TEST_ASSERT_EQUAL_UINT8(4, q.stats().depth);
+
+    // update() without a completion sends nothing new
+    q.update();
+    TEST_ASSERT_EQUAL(2, g_nSent);
+
+    // a completion for B does not release A
+    complete(q, B);
+    TEST_ASSERT_EQUAL(2, g_nSent);
+    TEST_ASSERT_TRUE(q.isIdle(B));
+    TEST_ASSERT_FALSE(q.isIdle(A));
+
+    complete(q, A);
+    TEST_ASSERT_EQUAL(3, g_nSent);
+    TEST_ASSERT_EQUAL_UINT16(2, g_sent[2].seq);
+    complete(q, A, false);
+    TEST_ASSERT_EQUAL(4, g_nSent);
+    TEST_ASSERT_EQUAL_UINT16(3, g_sent[3].seq);
+    complete(q, A);
+    TEST_ASSERT_TRUE(q.isIdle());
+    TEST_ASSERT_EQUAL_UINT32(4, q.stats().completed);
+    TEST_ASSERT_EQUAL_UINT32(3, q.stats().delivered);
+}
+
+void test_coalescing()
+{
+    TxQueue q;
+    q.begin(fakeTx, fakeClock);
+    queue(q, A, 1, CMD_HEARTBEAT); // goes out at once: in flight, never replaced
+    queue(q, A, 2, CMD_HEARTBEAT);
+    queue(q, A, 3, CMD_STOP);
+    queue(q, A, 4, CMD_HEARTBEAT); // replaces 2, keeps its place before 3
+    queue(q, B, 5, CMD_HEARTBEAT); // other peer: not coalesced
+    TEST_ASSERT_EQUAL_UINT32(1, q.stats().coalesced);
+    TEST_ASSERT_EQUAL_UINT32(4, q.stats().queued);
+
+    complete(q, B);
+    complete(q, A);
+    complete(q, A);
+    complete(q, A);
+    TEST_ASSERT_TRUE(q.isIdle());
+    TEST_ASSERT_EQUAL(4, g_nSent);
+    TEST_ASSERT_EQUAL_UINT16(1, g_sent[0].seq);
+    TEST_ASSERT_EQUAL_UINT16(5, g_sent[1].seq);
+    TEST_ASSERT_EQUAL_UINT16(4, g_sent[2].seq);
+    TEST_ASSERT_EQUAL_UINT16(3, g_sent[3].seq);
+}
+
+void test_timeout_and_driver_error()
+{
+    TxQueue q;
+    q.begin(fakeTx, fakeClock, 1000);
+    queue(q, A, 1);
+    queue(q, A, 2);
+    g_now = 999;
+    q.update();
+    TEST_ASSERT_EQUAL(1, g_nSent);
+    g_now = 1000; // callback never came: give up, move on
+    q.update();
+    TEST_ASSERT_EQUAL_UINT32(1, q.stats().timeouts);
+    TEST_ASSERT_EQUAL(2, g_nSent);
+
+    // the late callback of the timed-out frame is dropped: frame 2 is still in flight ...
+    complete(q, A, false);
+    TEST_ASSERT_EQUAL_UINT32(1, q.stats().late);
+    TEST_ASSERT_EQUAL_UINT32(0, q.stats().completed);
+    TEST_ASSERT_FALSE(q.isIdle(A));
+    // ... and gets its own
+    complete(q, A);
+    TEST_ASSERT_TRUE(q.isIdle());
+    TEST_ASSERT_EQUAL_UINT32(1, q.stats().delivered);
+
+    // a callback that never comes at all: the slot is given up after 20 timeouts
+    queue(q, A, 4);
+    g_now += 1000;
+    q.update(); // timed out, waiting for its completion
+    queue(q, A, 5);
+    TEST_ASSERT_EQUAL(4, g_nSent);
+    g_now += 20 * 1000;
+    q.update(); // 5 timed out as well; 4 given up for good
+    complete(q, A);
+    TEST_ASSERT_EQUAL_UINT32(2, q.stats().late); // 5's arrived late, 4's never
+    TEST_ASSERT_EQUAL_UINT32(3, q.stats().timeouts);
+    TEST_ASSERT_TRUE(q.isIdle());
+
+    g_fail = true;
+    queue(q, B, 3);
+    TEST_ASSERT_EQUAL_UINT32(1, q.stats().errors);
+    TEST_ASSERT_TRUE(q.isIdle());
+}
+
+void test_full_queue_and_stats()
+{
+    TxQueue q;
+    q.begin(fakeTx, fakeClock);
+    for (uint16_t s = 0; s < TxQueue::SLOTS + 3; s++)
+        queue(q, A, s);
+    TEST_ASSERT_EQUAL_UINT32(3, q.stats().rejected);
+    TEST_ASSERT_EQUAL_UINT8(TxQueue::SLOTS, q.stats().peakDepth);
+
+    // each frame completes 500 us after the previous one
+    for (uint16_t s = 0; s < TxQueue::SLOTS; s++)
+    {
+        g_now += 500;
+        complete(q, A);
+    }
+    TEST_ASSERT_TRUE(q.isIdle());
+    TEST_ASSERT_EQUAL(TxQueue::SLOTS, g_nSent);
+    TEST_ASSERT_EQUAL_UINT8(0, q.stats().depth);
+    // all were queued at t=0: the last one waited behind the whole queue
+    TEST_ASSERT_EQUAL_UINT32(500u * TxQueue::SLOTS, q.stats().maxLatencyUs);
+    TEST_ASSERT_EQUAL_UINT32(500u * TxQueue::SLOTS, q.stats().lastLatencyUs);
+}
+
+int main(int, char **)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_one_in_flight_per_peer);
+    RUN_TEST(test_coalescing);
+    RUN_TEST(test_timeout_and_driver_error);
+    RUN_TEST(test_full_queue_and_stats);
+    return UNITY_END();
+}
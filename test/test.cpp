@@ -3,6 +3,10 @@
 #include <esp_now.h>
 #include <esp_wifi.h>
 #include <Preferences.h>
+#include "PairRecord.h" // written by the main firmware's pairing mode
+#include "Protocol.h"   // same wire format as the main firmware
+#include "TxQueue.h"    // one frame in flight, paced by the send callback
+#include "GestureCore.h" // same debounce / gestures as the main firmware's Button
 
 // ---------- Pins ----------
 constexpr int LED_PIN = 16; // External LED -> 220Ω -> GND
@@ -20,22 +24,27 @@ uint8_t macA[6] = {0x8C, 0x4F, 0x00, 0x0F, 0xD8, 0x54}; // Device A
 uint8_t macB[6] = {0xF8, 0xB3, 0xB7, 0x45, 0x35, 0x00}; // Device B
 uint8_t peerMac[6], myMac[6];
 
-// ---------- Message ----------
-struct __attribute__((packed)) Msg
-{
-    uint8_t cmd;
-    uint8_t seconds;
-}; // cmd=1 -> LED on
-
 // ---------- State (runtime) ----------
-volatile bool irqBtn = false;
-void IRAM_ATTR isrBtn() { irqBtn = true; }
+// every raw edge goes to the gesture engine; loop() only services its deadlines
+GestureCore btn;
+portMUX_TYPE btnMux = portMUX_INITIALIZER_UNLOCKED;
+void IRAM_ATTR isrBtn()
+{
+    portENTER_CRITICAL_ISR(&btnMux);
+    btn.onEdge(digitalRead(BTN_PIN) == LOW, micros());
+    portEXIT_CRITICAL_ISR(&btnMux);
+}
 
 volatile bool recvPulse = false;
 volatile uint32_t recvLedOffAt = 0;
 
-bool btnLatched = false;
-uint32_t debounceAt = 0;
+
+// ---------- Outgoing pulse burst (paced by onSent, no delay()) ----------
+TxQueue tx;
+uint8_t pulseFrame[Proto::MAX_FRAME];
+uint8_t pulseLen = 0;
+uint32_t burstEndAt = 0;  // resend the pulse until then
+uint32_t nextBurstAt = 0; // ... at most every 25 ms
 
 // ---------- Pairing persistence ----------
 Preferences prefs;
@@ -73,14 +82,14 @@ static void savePairFlags()
 // ---------- ESP-NOW callbacks (NON-BLOCKING) ----------
 static void onRecv(const uint8_t *, const uint8_t *data, int len)
 {
-    if (len < (int)sizeof(Msg))
+    Proto::Frame f;
+    if (Proto::parse(data, len, f) != Proto::Status::Ok)
         return;
-    Msg m;
-    memcpy(&m, data, sizeof(Msg));
-    if (m.cmd == 1)
+    // CMD_START / CMD_HEARTBEAT -> LED on for the lease
+    if (const SignalBody *s = f.body<SignalBody>())
     {
         recvPulse = true;
-        recvLedOffAt = millis() + (uint32_t)m.seconds * 1000UL;
+        recvLedOffAt = millis() + s->leaseMs;
     }
     // mark RX seen, persist
     if (!seenRx)
@@ -90,8 +99,9 @@ static void onRecv(const uint8_t *, const uint8_t *data, int len)
     }
 }
 
-static void onSent(const uint8_t *, esp_now_send_status_t s)
+static void onSent(const uint8_t *mac, esp_now_send_status_t s)
 {
+    tx.onSent(mac, s == ESP_NOW_SEND_SUCCESS);
     if (s == ESP_NOW_SEND_SUCCESS && !seenTxOK)
     {
         seenTxOK = true;
@@ -118,16 +128,34 @@ static void addPeer(const uint8_t *mac)
     esp_now_add_peer(&p);
 }
 
+static uint32_t nowUs() { return micros(); }
+
+static bool espNowTx(const uint8_t *mac, const uint8_t *data, uint8_t len)
+{
+    return esp_now_send(mac, data, len) == ESP_OK;
+}
+
+// Starts a 300 ms burst of the same START frame; updateBurst() paces it from loop()
 static void sendPulse(uint8_t seconds = 3)
 {
-    Msg m{1, seconds};
-    // send short burst for reliability (non-blocking callbacks)
-    uint32_t t0 = millis();
-    while (millis() - t0 < 300) // 300 ms
-    { 
-        esp_now_send(peerMac, (uint8_t *)&m, sizeof(m));
-        delay(25);
+    pulseLen = (uint8_t)Proto::encode(pulseFrame, CMD_START, MSG_FLAG_NOACK, 0, SignalBody{(uint16_t)(seconds * 1000u)});
+    burstEndAt = millis() + 300;
+    nextBurstAt = millis();
+}
+
+// Next copy once the previous one completed (onSent) and 25 ms have passed
+static void updateBurst()
+{
+    uint32_t now = millis();
+    if (!pulseLen || (int32_t)(now - nextBurstAt) < 0 || !tx.isIdle(peerMac))
+        return;
+    if ((int32_t)(now - burstEndAt) >= 0)
+    {
+        pulseLen = 0;
+        return;
     }
+    tx.send(peerMac, pulseFrame, pulseLen, CMD_START);
+    nextBurstAt = now + 25;
 }
 
 void setup()
@@ -137,7 +165,8 @@ void setup()
     digitalWrite(LED_PIN, LOW);
     pinMode(BTN_PIN, INPUT_PULLUP);
     pinMode(ROLE_PIN, INPUT_PULLUP); // TIP: on Device B, tie ROLE_PIN to 3V3 with a short jumper to avoid floating
-    attachInterrupt(digitalPinToInterrupt(BTN_PIN), isrBtn, FALLING);
+    btn.begin(GestureCore::Config(), digitalRead(BTN_PIN) == LOW);
+    attachInterrupt(digitalPinToInterrupt(BTN_PIN), isrBtn, CHANGE);
 
     Serial.begin(115200);
     delay(100);
@@ -147,6 +176,8 @@ void setup()
     seenRx = prefs.getBool("seenRx", false);
     seenTxOK = prefs.getBool("seenTxOK", false);
     pairedEver = prefs.getBool("paired", false);
+    PairRecord rec{};
+    const bool cachedPeer = (prefs.getBytes("peer", &rec, sizeof(rec)) == sizeof(rec));
 
     // Boot flash ONCE if we have already paired in a previous run
     bootFlashIfPairedOnce();
@@ -161,9 +192,13 @@ void setup()
 
     bool isA = (digitalRead(ROLE_PIN) == LOW);
     Serial.print("Role: ");
-    Serial.println(isA ? "Device A (ROLE_PIN=GND)" : "Device B (ROLE_PIN=HIGH/3V3)");
+    if (cachedPeer)
+        Serial.println("from pairing cache (ROLE_PIN ignored)");
+    else
+        Serial.println(isA ? "Device A (ROLE_PIN=GND)" : "Device B (ROLE_PIN=HIGH/3V3)");
 
-    memcpy(peerMac, isA ? macB : macA, 6);
+    // a peer paired at runtime wins over the compiled-in MACs
+    memcpy(peerMac, cachedPeer ? rec.mac : (isA ? macB : macA), 6);
     Serial.print("Peer MAC: ");
     Serial.println(macToStr(peerMac));
     if (memcmp(peerMac, myMac, 6) == 0)
@@ -179,6 +214,7 @@ void setup()
     esp_now_register_recv_cb(onRecv);
     esp_now_register_send_cb(onSent);
     addPeer(peerMac);
+    tx.begin(espNowTx, nowUs);
 }
 
 void loop()
@@ -194,30 +230,28 @@ void loop()
         digitalWrite(LED_PIN, LOW);
     }
 
-    // debounced button handling
-    if (irqBtn)
+    // button: press taken on the first edge, bounce ignored
+    GestureEvent e;
+    bool pressed = false;
+    uint32_t due;
+    portENTER_CRITICAL(&btnMux);
+    if (btn.nextDeadline(due) && (int32_t)(micros() - due) >= 0)
+        btn.onTimer(micros(), digitalRead(BTN_PIN) == LOW);
+    while (btn.pop(e))
+        pressed |= e.type == Gesture::Press;
+    portEXIT_CRITICAL(&btnMux);
+    if (pressed)
     {
-        irqBtn = false;
-        debounceAt = millis();
-    }
-    if (!btnLatched && (millis() - debounceAt) >= 15)
-    {
-        if (digitalRead(BTN_PIN) == LOW)
-        {
-            btnLatched = true;
-
-            // local short feedback blink
-            digitalWrite(LED_PIN, HIGH);
-            delay(60);
-            digitalWrite(LED_PIN, LOW);
+        // local short feedback blink
+        digitalWrite(LED_PIN, HIGH);
+        delay(60);
+        digitalWrite(LED_PIN, LOW);
 
-            sendPulse(3); // ask peer to light for 3 seconds
-        }
-    }
-    if (btnLatched && digitalRead(BTN_PIN) == HIGH)
-    {
-        btnLatched = false;
+        sendPulse(3); // ask peer to light for 3 seconds
     }
 
+    updateBurst();
+    tx.update();
+
     delay(1);
 }
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""Turn the serial 't' trace dumps of one or more boards into Chrome Trace JSON.
+
+Each board prints (Trace::dump(), src/Trace.cpp):
+    trace: dev 24:0A:C4:12:34:56 now 123456789 events 310 overwritten 0
+    trace: 123400000 0 send 1 17
+    ...
+    trace: end
+
+Usage:
+    python3 tools/trace_to_perfetto.py a.log b.log -o trace.json
+then open trace.json in https://ui.perfetto.dev (or chrome://tracing).
+
+- Any serial capture works: lines without "trace:" are skipped, several dumps
+  per file and one board over several files are merged.
+- 32-bit event timestamps are unwrapped with the 64-bit "now" of their dump.
+- Clocks: the first board is the reference. Every other board is shifted
+  by the offset from frames the two exchanged (send on one side, recv of the
+  same type + seq on the other), NTP style:
+  offset = (min(recv_B - send_A) - min(recv_A - send_B)) / 2.
+  Enough frames in both halves of the trace also give a drift, interpolated linearly.
+  With traffic in one direction only, a nominal airtime stands in for the
+  missing direction (printed as a warning).
+- One process per board, one thread per core; send -> recv pairs are flow
+  arrows between the boards, buzzer notes a counter track, scenes slices.
+"""
+import argparse
+import json
+import os
+import re
+import sys
+from collections import defaultdict
+
+NOMINAL_AIR_US = 1000  # send -> receive callback of a short frame, one direction only
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+HEADER = re.compile(r"trace: dev ([0-9A-Fa-f:]{17}) now (\d+)")
+EVENT = re.compile(r"trace: (\d+) (\d+) (\w+) (\d+) (\d+)")
+
+
+def enum_names(header, pattern):
+    """value -> name for an enum in include/<header> (frame types, LED animations)."""
+    path = os.path.join(HERE, "..", "include", header)
+    try:
+        with open(path) as f:
+            return {int(v): n for n, v in re.findall(pattern, f.read())}
+    except OSError:
+        return {}
+
+
+CMD = enum_names("Protocol.h", r"\bCMD_(\w+) = (\d+)")
+
+
+def led_anims():
+    path = os.path.join(HERE, "..", "include", "TriLeds.h")
+    try:
+        with open(path) as f:
+            body = re.search(r"enum class Anim : uint8_t\s*\{(.*?)\}", f.read(), re.S).group(1)
+    except (OSError, AttributeError):
+        return {}
+    names = [re.sub(r"//.*", "", l).strip().rstrip(",") for l in body.splitlines()]
+    return dict(enumerate(n for n in names if n))
+
+
+ANIM = led_anims()
+
+
+def parse(paths):
+    """mac -> list of (us64, core, name, a, b), time ordered"""
+    boards = defaultdict(list)
+    for path in paths:
+        mac, now = None, 0
+        with open(path, errors="replace") as f:
+            for line in f:
+                m = HEADER.search(line)
+                if m:
+                    mac, now = m.group(1).upper(), int(m.group(2))
+                    continue
+                if "trace: end" in line:
+                    mac = None
+                    continue
+                m = EVENT.search(line)
+                if m and mac:
+                    us, core, name, a, b = m.groups()
+                    full = now - ((now - int(us)) & 0xFFFFFFFF)
+                    boards[mac].append((full, int(core), name, int(a), int(b)))
+    for evs in boards.values():
+        evs.sort()
+    return boards
+
+
+def frames(evs, kind):
+    """(type, seq) -> time, for keys seen exactly once (retransmissions are ambiguous)"""
+    seen = defaultdict(list)
+    for t, _, name, a, b in evs:
+        if name == kind:
+            seen[(a, b)].append(t)
+    return {k: v[0] for k, v in seen.items() if len(v) == 1}
+
+
+def one_way(sender, receiver):
+    """[(t_send, recv - send)] for frames both boards traced"""
+    tx, rx = frames(sender, "send"), frames(receiver, "recv")
+    return [(tx[k], rx[k] - tx[k]) for k in tx if k in rx]
+
+
+def offset_of(ab, ba):
+    """board B clock - board A clock, from one-way samples in both directions"""
+    if ab and ba:
+        return (min(d for _, d in ab) - min(d for _, d in ba)) / 2.0
+    if ab:
+        return min(d for _, d in ab) - NOMINAL_AIR_US
+    return -(min(d for _, d in ba) - NOMINAL_AIR_US)
+
+
+def align(ref, other, label):
+    """function: other board's time -> reference time"""
+    ab = one_way(ref, other)  # ref sends
+    ba = [(t + d, d) for t, d in one_way(other, ref)]  # other sends; t: receive time, ref clock
+    if not ab and not ba:
+        print(f"warning: {label}: no frames in common, clock left unaligned", file=sys.stderr)
+        return lambda t: t
+    if not ab or not ba:
+        print(f"warning: {label}: frames in one direction only, assuming {NOMINAL_AIR_US} us airtime",
+              file=sys.stderr)
+    off = offset_of(ab, ba)
+
+    # drift: one offset per half of the trace, when each half has traffic both ways
+    times = sorted(t for t, _ in ab + ba)
+    mid = times[len(times) // 2]
+    halves = [([s for s in ab if (s[0] < mid) == first], [s for s in ba if (s[0] < mid) == first])
+              for first in (True, False)]
+    if all(len(h[0]) >= 3 and len(h[1]) >= 3 for h in halves):
+        (t1, o1), (t2, o2) = [(sum(t for t, _ in h[0] + h[1]) / len(h[0] + h[1]), offset_of(*h)) for h in halves]
+        if t2 > t1:
+            ppm = (o2 - o1) / (t2 - t1) * 1e6
+            print(f"{label}: offset {o1:.0f} us, drift {ppm:.1f} ppm", file=sys.stderr)
+            return lambda t: t - (o1 + (t - off - t1) * (o2 - o1) / (t2 - t1))
+    print(f"{label}: offset {off:.0f} us", file=sys.stderr)
+    return lambda t: t - off
+
+
+def describe(name, a, b):
+    if name in ("enqueue", "send", "recv"):
+        return f"{name} {CMD.get(a, a)} #{b}"
+    if name == "sent":
+        return "sent ok" if a else "sent FAIL"
+    if name == "button":
+        return "button down" if a else "button up"
+    if name == "led":
+        return f"led {ANIM.get(a, a)}"
+    if name == "display":
+        return "display '" + "".join(chr(c) if 32 <= c < 127 else "?" for c in (a, b)) + "'"
+    return f"{name} {a} {b}"
+
+
+def convert(boards):
+    macs = list(boards)
+    clock = {macs[0]: (lambda t: t)}
+    for mac in macs[1:]:
+        clock[mac] = align(boards[macs[0]], boards[mac], mac)
+    t0 = min(clock[m](evs[0][0]) for m, evs in boards.items() if evs)
+
+    out = []
+    sends = {}
+    flow = 0
+    for pid, mac in enumerate(macs, 1):
+        out.append({"ph": "M", "pid": pid, "name": "process_name", "args": {"name": f"board {mac}"}})
+        for core in (0, 1):
+            out.append({"ph": "M", "pid": pid, "tid": core, "name": "thread_name", "args": {"name": f"core {core}"}})
+        out.append({"ph": "M", "pid": pid, "tid": 9, "name": "thread_name", "args": {"name": "scenes"}})
+        for t, core, name, a, b in boards[mac]:
+            ts = clock[mac](t) - t0
+            if name == "scene":
+                out.append({"ph": "B" if b else "E", "pid": pid, "tid": 9, "ts": ts, "name": f"scene {a}"})
+                continue
+            if name == "note":
+                out.append({"ph": "C", "pid": pid, "ts": ts, "name": "buzzer", "args": {"Hz": b if a else 0}})
+            # 1 us slices, so flow arrows have something to bind to
+            out.append({"ph": "X", "pid": pid, "tid": core, "ts": ts, "dur": 1, "name": describe(name, a, b),
+                        "cat": name, "args": {"a": a, "b": b}})
+            if name == "send":
+                sends[(mac, a, b)] = (pid, core, ts)
+    # send -> recv on another board, same frame type and seq
+    for pid, mac in enumerate(macs, 1):
+        for t, core, name, a, b in boards[mac]:
+            if name != "recv":
+                continue
+            for other in macs:
+                src = sends.get((other, a, b))
+                if other == mac or not src:
+                    continue
+                flow += 1
+                spid, score, sts = src
+                out.append({"ph": "s", "id": flow, "pid": spid, "tid": score, "ts": sts, "name": "frame", "cat": "frame"})
+                out.append({"ph": "f", "bp": "e", "id": flow, "pid": pid, "tid": core, "ts": clock[mac](t) - t0,
+                            "name": "frame", "cat": "frame"})
+    return {"traceEvents": out, "displayTimeUnit": "ms"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("logs", nargs="+", help="serial captures containing 't' dumps")
+    ap.add_argument("-o", "--out", default="trace.json")
+    args = ap.parse_args()
+    boards = parse(args.logs)
+    if not boards:
+        sys.exit("no 'trace: dev' dumps found")
+    with open(args.out, "w") as f:
+        json.dump(convert(boards), f)
+    n = sum(len(e) for e in boards.values())
+    print(f"{n} events from {len(boards)} board(s) -> {args.out}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()